@@ -0,0 +1,29 @@
+// Check continuous flushing can be switched at runtime and reports in serverStatus.
+
+var admin = db.getSisterDB( "admin" );
+
+t = db.continuousflush;
+t.drop();
+
+was = admin.runCommand( { getParameter:1, continuousFlush:1 } ).continuousFlush;
+assert.eq( "boolean", typeof was );
+
+try {
+    assert.commandWorked( admin.runCommand( { setParameter:1, continuousFlush:true } ) );
+    assert.eq( true, admin.runCommand( { getParameter:1, continuousFlush:1 } ).continuousFlush );
+
+    for( i = 0; i < 1000; ++i ) {
+        t.save( { i:i, s:new Array( 200 ).toString() } );
+    }
+    db.getLastError();
+
+    f = db.serverStatus().backgroundFlushing;
+    assert( f, "no backgroundFlushing" );
+    [ "writeback_mb", "writeback_ms", "writeback_mb_s", "backlog_mb" ].forEach( function( field ) {
+                                                                              assert( field in f, field );
+                                                                              assert.lte( 0, f[ field ], field );
+                                                                              } );
+}
+finally {
+    admin.runCommand( { setParameter:1, continuousFlush:was } );
+}
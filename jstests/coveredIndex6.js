@@ -0,0 +1,56 @@
+// Covered queries and counts should not read documents: check nscannedObjects, and that results
+// served from index keys agree with the documents.
+
+t = db.jstests_coveredIndex6;
+t.drop();
+
+t.ensureIndex( { a:1, b:1 } );
+for( i = 0; i < 20; ++i ) {
+    t.save( { a:i % 4, b:i, c:'x' } );
+}
+
+// Covered projection.
+explain = t.find( { a:{ $gte:1 } }, { _id:0, a:1, b:1 } ).explain();
+assert( explain.indexOnly );
+assert.eq( 15, explain.n );
+assert.eq( 0, explain.nscannedObjects );
+
+// Uncovered projection reads every match.
+explain = t.find( { a:{ $gte:1 } }, { _id:0, a:1, c:1 } ).explain();
+assert( !explain.indexOnly );
+assert.eq( 15, explain.nscannedObjects );
+
+// Sorted on a projected field other than the index order: reordered from index keys.
+t.ensureIndex( { z:1 } ); // clear query patterns
+t.dropIndex( { z:1 } );
+results = t.find( { a:2 }, { _id:0, a:1, b:1 } ).sort( { b:-1 } ).hint( { a:1, b:1 } ).toArray();
+assert.eq( [ { a:2, b:18 }, { a:2, b:14 }, { a:2, b:10 }, { a:2, b:6 }, { a:2, b:2 } ], results );
+explain = t.find( { a:{ $gte:2 } }, { _id:0, a:1, b:1 } ).sort( { b:1 } ).hint( { a:1, b:1 } ).explain();
+assert( explain.scanAndOrder );
+assert.eq( 0, explain.nscannedObjects );
+
+// Counts over a multikey index, answered from the keys.
+m = db.jstests_coveredIndex6_multikey;
+m.drop();
+m.ensureIndex( { a:1, b:1 } );
+m.save( { a:[ 1, 5, 9 ], b:1 } );
+m.save( { a:[ 2, 3 ], b:2 } );
+m.save( { a:4, b:[ 1, 2 ] } );
+m.save( { a:[ [ 6, 7 ] ], b:1 } );
+m.save( { a:[], b:1 } );
+m.save( { b:1 } );
+
+function checkCount( query ) {
+    var expected = 0;
+    m.find( query ).hint( { $natural:1 } ).forEach( function() { ++expected; } );
+    assert.eq( expected, m.find( query ).hint( { a:1, b:1 } ).count(), tojson( query ) );
+}
+
+checkCount( { a:{ $gt:4 } } );
+checkCount( { a:{ $gte:2, $lte:3 } } );
+checkCount( { a:{ $in:[ 3, 9 ] } } );
+checkCount( { a:{ $gt:1 }, b:1 } );
+checkCount( { a:{ $lt:5 }, b:{ $gt:1 } } );
+checkCount( { a:[ 6, 7 ] } );
+checkCount( { a:null } );
+checkCount( { a:{ $ne:5 } } );
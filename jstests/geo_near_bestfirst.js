@@ -0,0 +1,51 @@
+// $near visits neighbor boxes nearest first and skips boxes that can't hold a closer point: results must
+// match a full scan, and the search should load far fewer points than the collection holds.
+
+t = db.geo_near_bestfirst;
+t.drop();
+
+for( x = 0; x < 60; ++x ) {
+    for( y = 0; y < 60; ++y ) {
+        t.insert( { loc:[ x, y ] } );
+    }
+}
+t.ensureIndex( { loc:"2d" } );
+
+function check( near, num, maxDistance ) {
+    var expected = [];
+    t.find().forEach( function( o ) {
+        var dx = o.loc[ 0 ] - near[ 0 ], dy = o.loc[ 1 ] - near[ 1 ];
+        var d = Math.sqrt( dx * dx + dy * dy );
+        if ( maxDistance == null || d <= maxDistance ) {
+            expected.push( d );
+        }
+    } );
+    expected.sort( function( a, b ) { return a - b; } );
+    expected = expected.slice( 0, num );
+
+    var cmd = { geoNear:t.getName(), near:near, num:num };
+    if ( maxDistance != null ) {
+        cmd.maxDistance = maxDistance;
+    }
+    var res = db.runCommand( cmd );
+    assert.commandWorked( res );
+    assert.eq( expected.length, res.results.length, tojson( cmd ) );
+    for( i = 0; i < expected.length; ++i ) {
+        assert.close( expected[ i ], res.results[ i ].dis, tojson( cmd ) + " result " + i );
+    }
+    return res.stats;
+}
+
+stats = check( [ 30.3, 30.6 ], 10 );
+assert.lt( stats.nscanned, 3600 / 2, tojson( stats ) );
+assert.lte( stats.pointsLoaded, stats.nscanned, tojson( stats ) );
+assert.eq( "number", typeof stats.boxesSkipped );
+
+check( [ 0.1, 0.2 ], 25 );
+check( [ 59.5, 12.5 ], 50 );
+check( [ 20.5, 40.5 ], 100, 4.5 );
+check( [ 31.9, 31.9 ], 1 );
+
+explain = t.find( { loc:{ $near:[ 30.3, 30.6 ] } } ).limit( 10 ).explain();
+assert.eq( "number", typeof explain.boxesSkipped, tojson( explain ) );
+assert.lt( explain.nscanned, 3600 / 2, tojson( explain ) );
@@ -0,0 +1,89 @@
+// 2dsphere index: $within $centerSphere and $polygon answered from cell coverings, checked against brute force.
+
+t = db.geo_sphere_index;
+t.drop();
+
+function vec( p ) {
+    var lng = p[0] * Math.PI / 180, lat = p[1] * Math.PI / 180;
+    return [ Math.cos( lat ) * Math.cos( lng ), Math.cos( lat ) * Math.sin( lng ), Math.sin( lat ) ];
+}
+function dot( a, b ) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+function cross( a, b ) { return [ a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] ]; }
+
+// great circle edges: the edges wind around a point inside
+function inPolygon( p, poly ) {
+    var x = vec( p ), sum = 0;
+    for ( var k = 0; k < poly.length; k++ ) {
+        var a = cross( x, vec( poly[k] ) ), b = cross( x, vec( poly[ ( k + 1 ) % poly.length ] ) );
+        sum += Math.atan2( dot( x, cross( a, b ) ), dot( a, b ) );
+    }
+    return Math.abs( sum ) > Math.PI;
+}
+
+// the points of each document, by _id
+docs = [];
+for ( x = -179; x <= 179; x += 4 ) {
+    for ( y = -89; y <= 89; y += 4 ) {
+        docs.push( [ [ x, y ] ] );
+        t.save( { _id:docs.length - 1, loc:[ x, y ] } );
+    }
+}
+// a document with several points is returned once
+docs.push( [ [ 1, 1 ], [ 1.5, 1.5 ], [ 100, 50 ] ] );
+t.save( { _id:docs.length - 1, loc:docs[ docs.length - 1 ] } );
+num = docs.length;
+
+function matching( inRegion ) {
+    var ids = [];
+    docs.forEach( function( d, i ) { if ( d.some( inRegion ) ) ids.push( i ); } );
+    return ids;
+}
+
+t.ensureIndex( { loc:"2dsphere" } );
+assert( !db.getLastError() );
+
+function check( q, expected ) {
+    var ids = t.find( q ).map( function( z ) { return z._id; } );
+    assert.eq( expected.length, ids.length, tojson( q ) );
+    expected.forEach( function( id ) { assert( Array.contains( ids, id ), tojson( q ) + " missing " + id ); } );
+
+    var e = t.find( q ).explain();
+    assert.eq( "SphereCursor", e.cursor, tojson( q ) );
+    assert.eq( expected.length, e.n );
+    assert.gt( 33, e.keyRanges );
+    // only a fraction of the collection is scanned
+    assert.gt( num / 2, e.nscanned, tojson( q ) );
+}
+
+caps = [ [ [ 5, 0 ], 0.05 ], [ [ 135, 70 ], 0.05 ], [ [ 5, 85 ], 0.25 ], [ [ -170, -60 ], 0.25 ], [ [ 179, 0 ], 0.1 ] ];
+caps.forEach( function( c ) {
+    check( { loc:{ $within:{ $centerSphere:c } } },
+           matching( function( p ) { return Geo.sphereDistance( p, c[0] ) <= c[1]; } ) );
+} );
+
+polygons = [ [ [ 0, 0 ], [ 30, 0 ], [ 30, 30 ], [ 0, 30 ] ],
+             [ [ -10, -80 ], [ 20, -60 ], [ -40, -50 ] ],
+             [ [ 170, 10 ], [ -170, 10 ], [ -170, -10 ], [ 170, -10 ] ],   // across the date line
+             [ [ 0, 80 ], [ 120, 80 ], [ -120, 80 ] ] ];                   // around the pole
+polygons.forEach( function( poly ) {
+    check( { loc:{ $within:{ $polygon:poly } } },
+           matching( function( p ) { return inPolygon( p, poly ); } ) );
+} );
+
+assert.eq( 1, t.find( { loc:{ $within:{ $centerSphere:[ [ 1.2, 1.2 ], 0.01 ] } } } ).count() );
+
+// other fields of the query are matched too
+assert.eq( 1, t.find( { _id:0, loc:{ $within:{ $centerSphere:[ [ -179, -89 ], 0.01 ] } } } ).itcount() );
+
+// bad points aren't indexed
+t.save( { loc:[ 200, 0 ] } );
+assert( db.getLastError() );
+
+// with a 2d index on the field as well, $within is answered by the 2d index (planar),
+// whichever of the two indexes was created first
+t.ensureIndex( { loc:"2d" } );
+assert( !db.getLastError() );
+square = polygons[0];
+assert.eq( "GeoBrowse-polygon", t.find( { loc:{ $within:{ $polygon:square } } } ).explain().cursor );
+assert.eq( matching( function( p ) { return p[0] >= 0 && p[0] <= 30 && p[1] >= 0 && p[1] <= 30; } ).length,
+           t.find( { loc:{ $within:{ $polygon:square } } } ).itcount() );
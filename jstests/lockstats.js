@@ -0,0 +1,51 @@
+// Per operation lock stats in the profiler, keyed by database, and their totals in serverStatus.
+
+// special db so that it can be run in parallel tests
+var stddb = db;
+var db = db.getSisterDB("lockstats");
+
+t = db.lockstats;
+t.drop();
+
+try {
+    db.setProfilingLevel(0);
+    db.system.profile.drop();
+    db.setProfilingLevel(2);
+
+    for( i = 0; i < 100; ++i ) {
+        t.insert( { a:i } );
+    }
+    t.findOne( { a:1 } );
+
+    db.setProfilingLevel(0);
+
+    // Times under a microsecond are left out, so only check what the entries hold.
+    // The global lock is under ".", the lock of each database under its name.
+    db.system.profile.find( { op:"insert", ns:t.getFullName() } ).forEach( function( p ) {
+        if ( p.lockStats && p.lockStats.lockstats ) {
+            assert.eq( undefined, p.lockStats.lockstats.timeLockedMicros.r, tojson( p ) );
+            assert.eq( undefined, p.lockStats.lockstats.timeLockedMicros.R, tojson( p ) );
+        }
+        if ( p.lockStats && p.lockStats["."] ) {
+            assert.eq( undefined, p.lockStats["."].timeLockedMicros.R, tojson( p ) );
+        }
+    } );
+    query = db.system.profile.findOne( { op:"query", ns:t.getFullName() } );
+    assert( query, "query not profiled" );
+    if ( query.lockStats && query.lockStats.lockstats ) {
+        assert.eq( undefined, query.lockStats.lockstats.timeLockedMicros.w, tojson( query ) );
+    }
+
+    locks = db.serverStatus().locks;
+    assert( locks.lockstats, tojson( locks ) );
+    assert( locks.lockstats.timeLockedMicros.w > 0, tojson( locks ) );
+    assert.eq( undefined, locks.lockstats.timeLockedMicros.W, tojson( locks ) );
+    assert( locks["."], tojson( locks ) );
+    assert( locks["."].timeLockedMicros.w > 0, tojson( locks ) );
+
+    db.system.profile.drop();
+}
+finally {
+    db.setProfilingLevel(0);
+    db = stddb;
+}
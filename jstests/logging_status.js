@@ -0,0 +1,19 @@
+// serverStatus reports the async log writer.
+
+s = db.serverStatus().logging;
+assert( s, "no logging section" );
+assert.eq( "boolean", typeof s.async );
+assert.lte( 0, s.queuedBytes );
+assert.lte( 0, s.dropped );
+
+// lines still reach the tees (getLog) right away
+db.adminCommand( { setParameter:1, logLevel:1 } );
+try {
+    marker = "logging_status_" + Math.random();
+    db.logging_status.findOne( { marker:marker } );
+    found = db.adminCommand( { getLog:"global" } ).log.some( function( line ) { return line.indexOf( marker ) >= 0; } );
+    assert( found, "query not in getLog" );
+}
+finally {
+    db.adminCommand( { setParameter:1, logLevel:0 } );
+}
@@ -0,0 +1,70 @@
+// Check profile sampling, namespace filters and query pattern stats.
+// The sample rate is process wide, so this test is skipped by the parallel tester.
+
+var stddb = db;
+var db = db.getSisterDB("profile5");
+var oldSampleRate = db.runCommand( { profile:-1 } ).sampleRate;
+
+t = db.profile5;
+u = db.profile5_other;
+t.drop();
+u.drop();
+
+function profiled( coll ) {
+    return db.system.profile.find( { ns:coll.getFullName() } ).count();
+}
+
+try {
+    db.setProfilingLevel(0);
+    db.system.profile.drop();
+    db.runCommand( { profileStats:1, reset:true } );
+
+    // Nothing sampled.
+    db.runCommand( { profile:2, sampleRate:0 } );
+    for( i = 0; i < 10; ++i ) {
+        t.findOne( { a:i } );
+    }
+    assert.eq( 0, profiled( t ) );
+    assert.eq( 0, db.runCommand( { profile:-1 } ).sampleRate );
+
+    // Query pattern stats count every profiled op, sampled or not.
+    stats = db.runCommand( { profileStats:1 } );
+    assert.commandWorked( stats );
+    found = false;
+    stats.patterns.forEach( function( p ) {
+                           if ( p.ns == t.getFullName() ) {
+                               assert.eq( 10, p.count );
+                               assert.eq( { a:0 }, p.example );
+                               found = true;
+                           }
+                           } );
+    assert( found );
+
+    // Everything sampled, only in the filtered collection.
+    db.runCommand( { profile:2, sampleRate:1, namespaces:[ "profile5" ] } );
+    assert.eq( [ "profile5" ], db.runCommand( { profile:-1 } ).namespaces );
+    t.findOne();
+    u.findOne();
+    assert.eq( 1, profiled( t ) );
+    assert.eq( 0, profiled( u ) );
+
+    db.runCommand( { profile:2, namespaces:[] } );
+    u.findOne();
+    assert.eq( 1, profiled( u ) );
+
+    // a bad argument changes nothing
+    db.runCommand( { profile:1, slowms:100, namespaces:[] } );
+    assert.commandFailed( db.runCommand( { profile:2, slowms:5, sampleRate:2 } ) );
+    assert.commandFailed( db.runCommand( { profile:2, slowms:5, namespaces:[ 1 ] } ) );
+    res = db.runCommand( { profile:-1 } );
+    assert.eq( 1, res.was );
+    assert.eq( 100, res.slowms );
+    assert.eq( 1, res.sampleRate );
+
+    db.setProfilingLevel(0);
+    db.system.profile.drop();
+}
+finally {
+    db.runCommand( { profile:0, slowms:100, sampleRate:oldSampleRate, namespaces:[] } );
+    db = stddb;
+}
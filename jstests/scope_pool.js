@@ -0,0 +1,50 @@
+// JS scopes are pooled by database for all connections, and keep their compiled functions.
+
+t = db.scope_pool;
+t.drop();
+for ( i = 0; i < 10; i++ )
+    t.save( { x:i } );
+
+function stats() { return db.serverStatus().scopePool; }
+
+var where = "this.x % 2 == 0";
+assert.eq( 5, t.find( { $where:where } ).itcount() );
+
+var before = stats();
+assert( before, "no scopePool section" );
+for ( i = 0; i < 5; i++ )
+    assert.eq( 5, t.find( { $where:where } ).itcount() );
+var after = stats();
+assert.lte( before.hits + 5, after.hits, "scopes not reused" );
+assert.lte( before.functionCacheHits + 5, after.functionCacheHits, "function not cached" );
+
+// group and $where on another collection of the database use the same pool
+before = stats();
+db.scope_pool_other.drop();
+db.scope_pool_other.save( { y:1 } );
+assert.eq( 1, db.scope_pool_other.find( { $where:"this.y == 1" } ).itcount() );
+assert.eq( 1, t.group( { key:{}, initial:{ n:0 }, reduce:function( o, p ) { p.n++; } } ).length );
+after = stats();
+assert.lte( before.hits + 2, after.hits, "other collection didn't share the pool" );
+
+// mapReduce's emit is unbound when its scope goes back, so the scope is still reused
+function mr() {
+    return t.mapReduce( function() { emit( this.x % 2, 1 ); }, function( k, vs ) { return Array.sum( vs ); }, { out:{ inline:1 } } );
+}
+mr();
+before = stats();
+var res = mr();
+after = stats();
+assert.eq( 2, res.results.length );
+assert.lte( before.hits + 1, after.hits, "mapReduce scope not reused" );
+assert.eq( before.retired, after.retired, "mapReduce scope retired" );
+
+// another connection gets a pooled scope, but not the globals this one left behind
+assert.eq( 10, t.find( { $where:"leaked = 1; true" } ).itcount() );
+before = stats();
+var c = new Mongo( db.getMongo().host );
+var other = c.getDB( db.getName() ).scope_pool;
+assert.eq( 5, other.find( { $where:where } ).itcount() );
+after = stats();
+assert.lte( before.hits + 1, after.hits, "new connection didn't get a pooled scope" );
+assert.eq( 0, other.find( { $where:"typeof leaked != 'undefined'" } ).itcount(), "global leaked to another connection" );
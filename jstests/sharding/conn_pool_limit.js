@@ -0,0 +1,52 @@
+// Test per-host connection pool limits and stats on mongos
+
+s = new ShardingTest( "conn_pool_limit" , 2 , 0 , 1 );
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.foo" , key : { num : 1 } } );
+
+db = s.getDB( "test" );
+
+for ( var i = 0; i < 100; i++ )
+    db.foo.insert( { num : i } );
+db.getLastError();
+
+var admin = s.getDB( "admin" );
+
+old = admin.runCommand( { getParameter : 1 , connPoolMaxInUsePerHost : 1 } );
+assert.eq( 0 , old.connPoolMaxInUsePerHost , "default is unlimited" );
+
+assert.commandWorked( admin.runCommand( { setParameter : 1 , connPoolMaxInUsePerHost : 2 } ) );
+
+// queries still work with a small limit since connections go back to the pool
+for ( var i = 0; i < 20; i++ )
+    assert.eq( 100 , db.foo.find().itcount() , "itcount " + i );
+
+stats = admin.runCommand( "connPoolStats" ).shardConnectionPool;
+assert( stats , "no shardConnectionPool in connPoolStats" );
+assert.eq( 0 , stats.totalWaiters , "totalWaiters" );
+for ( var h in stats.hosts ) {
+    var z = stats.hosts[h];
+    if ( typeof( z.created ) == "undefined" )
+        continue;
+    assert.eq( 0 , z.waiters , "waiters for " + h );
+    assert( z.inUse <= 2 , "inUse for " + h + " is " + z.inUse );
+}
+
+// connections idle in other client threads' caches don't count as in use
+assert.commandWorked( admin.runCommand( { setParameter : 1 , connPoolMaxInUsePerHost : 1 } ) );
+other = new Mongo( s.s.host ).getDB( "test" );
+for ( var i = 0; i < 5; i++ ) {
+    assert.eq( 100 , db.foo.find().itcount() , "first connection " + i );
+    assert.eq( 100 , other.foo.find().itcount() , "second connection " + i );
+}
+stats = admin.runCommand( "connPoolStats" ).shardConnectionPool;
+for ( var h in stats.hosts )
+    assert( ! stats.hosts[h].timedOutWaits , "timed out waiting for " + h );
+
+tmp = admin.runCommand( { setParameter : 1 , connPoolMaxInUsePerHost : 0 } );
+assert.eq( 1 , tmp.was , "was" );
+
+assert( ! admin.runCommand( { setParameter : 1 , connPoolIdleTimeoutSecs : 0 } ).ok , "idle timeout must be positive" );
+
+s.stop();
@@ -47,6 +47,17 @@ gc(); gc();
 cur = db.foo.find().batchSize( 2 )
 assert( cur.next() , "T1" )
 assert( cur.next() , "T2" );
+
+// per cursor stats
+info = db.runCommand( { "cursorInfo" : 1 , "verbose" : true } )
+printjson( info )
+assert.eq( 1 , info.cursors.length , "S1" )
+assert.eq( "test.foo" , info.cursors[0].ns , "S2" )
+assert.eq( 2 , info.cursors[0].shards.length , "S3" )
+assert.eq( 1 , info.cursors[0].batches , "S4" )
+assert( info.cursors[0].bytes > 0 , "S5" )
+one = db.runCommand( { "cursorInfo" : 1 , "id" : info.cursors[0].id } )
+assert.eq( info.cursors[0].id , one.cursor.id , "S6" )
 before = db.runCommand( { "cursorInfo" : 1 , "setTimeout" : 10000 } ) // 10 seconds
 printjson( before )
 sleep( 6000 )
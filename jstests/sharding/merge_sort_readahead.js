@@ -0,0 +1,62 @@
+// merge_sort_readahead.js
+// mongos merges sorted shard cursors through a heap and reads their next batches ahead
+
+s = new ShardingTest( "merge_sort_readahead" , 3 , 0 , 1 );
+s.config.settings.update( { _id: "balancer" }, { $set : { stopped: true } } , true );
+
+s.adminCommand( { enablesharding : "test" } );
+s.adminCommand( { shardcollection : "test.data" , key : { _id : 1 } } );
+
+db = s.getDB( "test" );
+
+N = 3000;
+// x is a permutation of _id, so sorting on it interleaves documents of all shards
+for ( i=0; i<N; i++ )
+    db.data.insert( { _id : i , x : ( i * 7919 ) % N } );
+db.getLastError();
+
+s.adminCommand( { split : "test.data" , middle : { _id : N / 3 } } );
+s.adminCommand( { split : "test.data" , middle : { _id : 2 * N / 3 } } );
+s.adminCommand( { movechunk : "test.data" , find : { _id : 0 } , to : "shard0000" } );
+s.adminCommand( { movechunk : "test.data" , find : { _id : N / 3 } , to : "shard0001" } );
+s.adminCommand( { movechunk : "test.data" , find : { _id : 2 * N / 3 } , to : "shard0002" } );
+assert.eq( 3 , s.config.chunks.distinct( "shard" ).length , "chunks not on 3 shards" );
+// shards walk the index, so they stream their documents rather than sort them up front
+db.data.ensureIndex( { x : 1 } );
+assert.eq( null , db.getLastError() );
+
+function checkOrder( cursor , dir , msg ) {
+    var n = 0;
+    var last = null;
+    while ( cursor.hasNext() ) {
+        var x = cursor.next().x;
+        if ( last != null )
+            assert( dir > 0 ? last < x : last > x , msg + ": " + x + " after " + last );
+        last = x;
+        n++;
+    }
+    assert.eq( N , n , msg + ": count" );
+}
+
+// heap ordered merge, small batches make every shard go through many getMores and read aheads
+checkOrder( db.data.find().sort( { x : 1 } ).batchSize( 50 ) , 1 , "ascending" );
+checkOrder( db.data.find().sort( { x : -1 } ).batchSize( 50 ) , -1 , "descending" );
+checkOrder( db.data.find().sort( { x : 1 } ) , 1 , "default batch size" );
+
+// cursors taken in turns share the pooled connections their read aheads came back on, each
+// must only ever see replies to its own getMores
+var a = db.data.find().sort( { x : 1 } ).batchSize( 20 );
+var b = db.data.find().sort( { x : -1 } ).batchSize( 30 );
+for ( i=0; i<N; i++ ) {
+    assert.eq( i , a.next().x , "interleaved ascending" );
+    assert.eq( N - 1 - i , b.next().x , "interleaved descending" );
+}
+assert( ! a.hasNext() && ! b.hasNext() , "interleaved cursors not exhausted" );
+
+// a shard failing a getMore in the middle of the merge fails the query, and mongos keeps working
+var bad = db.data.find( { $where : "if ( this.x == " + ( N - 10 ) + " ) throw 'boom'; return true;" } )
+                 .sort( { x : 1 } ).batchSize( 50 );
+assert.throws( function() { bad.itcount(); } , [] , "shard error mid merge not reported" );
+checkOrder( db.data.find().sort( { x : 1 } ).batchSize( 50 ) , 1 , "after shard error" );
+
+s.stop();
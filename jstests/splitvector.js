@@ -199,4 +199,33 @@ assert.eq( 1 , res.splitKeys.length , "9b" );
 assert.eq( 2 , res.splitKeys[0].x , "9c" );
 
 
+// -------------------------
+// Case 10: split points estimated from the shape of the index land close to the exact ones
+//
+
+f.drop();
+f.ensureIndex( { x: 1 } );
+
+// Small documents so that a chunk spans many index buckets
+numDocs = 100000;
+for( i=0; i<numDocs; i++ ){
+    f.save( { x: i } );
+}
+db.getLastError();
+
+exact = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 } );
+res = db.runCommand( { splitVector: "test.jstests_splitvector" , keyPattern: {x:1} , maxChunkSize: 1 , estimate: true } );
+
+assert.eq( true , res.ok , "10a" );
+assert.eq( true , res.estimated , "10b" );
+assert.close( exact.splitKeys.length , res.splitKeys.length , "10c" , -1 );
+
+exactChunk = f.find( { x: { $lt: exact.splitKeys[0].x } } ).count();
+for ( i=0; i<res.splitKeys.length-1; i++ ) {
+    n = f.find( { x: { $gte: res.splitKeys[i].x , $lt: res.splitKeys[i+1].x } } ).count();
+    assert.gt( n , exactChunk / 2 , "10d" + i );
+    assert.lt( n , exactChunk * 3 / 2 , "10e" + i );
+}
+
+
 print("PASSED");
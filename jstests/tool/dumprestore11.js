@@ -0,0 +1,40 @@
+// parallel and compressed dump, with a large collection split into _id ranges, then parallel restore
+
+t = new ToolTest( "dumprestore11" );
+
+c = t.startDB( "foo" );
+big = c.getDB().big;
+small = c.getDB().small;
+
+var pad = new Array( 1024 ).join( "x" );
+for ( i = 0; i < 5000; i++ )
+    big.insert( { _id : i , pad : pad } );
+for ( i = 0; i < 100; i++ )
+    small.insert( { _id : i , x : i } );
+small.ensureIndex( { x : 1 } );
+assert.eq( 5000 , big.count() , "setup big" );
+
+t.runTool( "dump" , "--out" , t.ext , "-j" , "4" , "--splitCollectionsOverMB" , "1" , "--compress" );
+
+// compressed files restore like plain ones
+t.runTool( "dump" , "--out" , t.ext + "-plain" );
+assert.gt( listFiles( t.ext + "-plain/" + c.getDB() ).filter( function( f ) { return /big.bson$/.test( f.name ); } )[0].size ,
+           listFiles( t.ext + "/" + c.getDB() ).filter( function( f ) { return /big.bson$/.test( f.name ); } )[0].size * 2 ,
+           "not compressed" );
+
+c.getDB().dropDatabase();
+assert.eq( 0 , big.count() , "after drop" );
+
+t.runTool( "restore" , "--dir" , t.ext , "-j" , "4" , "--batchSize" , "100" );
+assert.eq( 5000 , big.count() , "big after restore" );
+assert.eq( 100 , small.count() , "small after restore" );
+for ( i = 0; i < 5000; i += 499 )
+    assert.eq( pad , big.findOne( { _id : i } ).pad , "doc " + i );
+assert.eq( 2 , small.getIndexes().length , "indexes after restore" );
+
+c.getDB().dropDatabase();
+t.runTool( "restore" , "--dir" , t.ext , "-j" , "2" , "--parallelIndexBuilds" );
+assert.eq( 5000 , big.count() , "big after second restore" );
+assert.eq( 2 , small.getIndexes().length , "indexes after second restore" );
+
+t.stop();
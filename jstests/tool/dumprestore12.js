@@ -0,0 +1,43 @@
+// dumprestore12.js
+// restore of several collections in parallel, with batched inserts and their indexes built afterwards
+
+t = new ToolTest( "dumprestore12" );
+
+c = t.startDB( "foo" );
+db = c.getDB();
+
+var names = [ "a" , "b" , "c" , "d" , "e" ];
+for ( var k = 0; k < names.length; k++ ) {
+    var coll = db[names[k]];
+    for ( i = 0; i < 1000 + k; i++ )
+        coll.insert( { _id : i , x : i % 10 , name : names[k] } );
+    coll.ensureIndex( { x : 1 } );
+}
+db.getLastError();
+
+t.runTool( "dump" , "--out" , t.ext );
+
+function check( msg ) {
+    for ( var k = 0; k < names.length; k++ ) {
+        var coll = db[names[k]];
+        assert.eq( 1000 + k , coll.count() , msg + ": count " + names[k] );
+        assert.eq( names[k] , coll.findOne( { _id : 999 } ).name , msg + ": doc " + names[k] );
+        assert.eq( 2 , coll.getIndexes().length , msg + ": indexes " + names[k] );
+        assert.eq( 100 , coll.find( { x : 3 } ).hint( { x : 1 } ).itcount() , msg + ": index " + names[k] );
+    }
+}
+
+db.dropDatabase();
+t.runTool( "restore" , "--dir" , t.ext , "-j" , "4" , "--batchSize" , "7" );
+check( "restore -j 4" );
+
+// more threads than collections, and indexes of different collections built in parallel
+db.dropDatabase();
+t.runTool( "restore" , "--dir" , t.ext , "-j" , "8" , "--parallelIndexBuilds" );
+check( "restore -j 8 --parallelIndexBuilds" );
+
+// --drop replaces what's there rather than adding to it
+t.runTool( "restore" , "--dir" , t.ext , "-j" , "4" , "--drop" );
+check( "restore -j 4 --drop" );
+
+t.stop();
@@ -0,0 +1,31 @@
+// files2.js: byte ranges of a file in GridFS, and the md5 computed while storing it
+
+t = new ToolTest( "files2" )
+
+db = t.startDB();
+
+// a text file of a few chunks, so the shell can compare its contents
+for ( i = 0; i < 20000; i++ )
+    db.src.insert( { _id : i , s : "line " + i } );
+t.runTool( "export" , "--out" , t.extFile , "-d" , t.baseName , "-c" , "src" );
+whole = cat( t.extFile );
+assert.gt( whole.length , 3 * 256 * 1024 , "file too small" );
+
+t.runTool( "files" , "-d" , t.baseName , "put" , "big" , "-l" , t.extFile );
+file_obj = db.fs.files.findOne()
+assert.eq( whole.length , file_obj.length , "length" );
+assert.eq( md5sumFile( t.extFile ) , file_obj.md5 , "stored md5" );
+assert.eq( file_obj.md5 , db.runCommand( { filemd5 : file_obj._id } ).md5 , "filemd5" );
+
+function checkRange( first , last ) {
+    var out = t.ext + "range";
+    t.runTool( "files" , "-d" , t.baseName , "get" , "big" , "-l" , out , "--range" , first + "-" + last );
+    assert.eq( whole.substring( first , Math.min( last + 1 , whole.length ) ) , cat( out ) , "range " + first + "-" + last );
+}
+
+checkRange( 0 , 99 );                                  // within the first chunk
+checkRange( 256 * 1024 - 10 , 256 * 1024 + 9 );       // across a chunk boundary
+checkRange( 100000 , 700000 );                         // several chunks
+checkRange( whole.length - 50 , whole.length + 1000 ); // past the end
+
+t.stop()
@@ -0,0 +1,42 @@
+// jsonimport1.js: json arrays spread over lines, and the parsing pipeline keeping the input order
+
+t = new ToolTest( "jsonimport1" );
+
+c = t.startDB( "foo" );
+
+t.runTool( "import" , "--jsonArray" , "--file" , "jstests/tool/data/jsonarray1.json" , "-d" , t.baseName , "-c" , "foo" , "-j" , "3" , "--batchSize" , "1" );
+assert.soon( "6 == c.count()" , "after import 1" );
+assert.eq( "braces { and } in a string" , c.findOne( { _id : 1 } ).s );
+assert.eq( 2 , c.findOne( { _id : 1 } ).n.x[1].y );
+assert.eq( "escaped \" quote and ] bracket" , c.findOne( { _id : 2 } ).s );
+assert.eq( "single quoted } string" , c.findOne( { _id : 3 } ).s );
+assert.eq( "a \\ backslash" , c.findOne( { _id : 4 } ).s );
+assert.eq( "two on a line" , c.findOne( { _id : 6 } ).s );
+
+// elements that aren't objects are parse errors, the objects around them still go in
+c.drop();
+t.runTool( "import" , "--jsonArray" , "--file" , "jstests/tool/data/jsonarray2.json" , "-d" , t.baseName , "-c" , "foo" );
+assert.eq( 2 , c.count() , "after import 2" );
+assert.eq( "after the bad ones" , c.findOne( { _id : 2 } ).s );
+assert.eq( null , c.findOne( { _id : 9 } ) , "nested array element" );
+
+// so is input that isn't an array at all
+c.getDB().lines.insert( { _id : 1 } );
+t.runTool( "export" , "--out" , t.extFile , "-d" , t.baseName , "-c" , "lines" );
+c.drop();
+t.runTool( "import" , "--jsonArray" , "--file" , t.extFile , "-d" , t.baseName , "-c" , "foo" );
+assert.eq( 0 , c.count() , "after import of lines as an array" );
+
+// upserts of the same key are applied in the order of the file, whichever thread parsed them
+src = c.getDB().src;
+for ( i = 0; i < 2000; i++ )
+    src.insert( { _id : i , k : i % 10 , v : i } );
+t.runTool( "export" , "--out" , t.extFile , "-d" , t.baseName , "-c" , "src" , "-f" , "k,v" , "--csv" );
+
+c.drop();
+t.runTool( "import" , "--file" , t.extFile , "-d" , t.baseName , "-c" , "foo" , "--type" , "csv" , "--headerline" ,
+           "--upsertFields" , "k" , "-j" , "4" , "--batchSize" , "7" );
+assert.eq( 10 , c.count() , "after upserts" );
+c.find().forEach( function( z ) { assert.eq( 1990 + z.k , z.v , "last value of " + z.k ); } );
+
+t.stop();
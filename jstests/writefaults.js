@@ -0,0 +1,44 @@
+// Writes that may yield for page faults before writing (in debug builds records are randomly
+// reported as not in memory) must still apply exactly once.
+
+t = db.jstests_writefaults;
+t.drop();
+t.ensureIndex( { a:1 } );
+
+before = db.serverStatus().writeFaults;
+assert( before, "no writeFaults in serverStatus" );
+assert.eq( "number", typeof before.yielded );
+assert.eq( "number", typeof before.underLock );
+
+for( i = 0; i < 1000; ++i ) {
+    t.insert( { _id:i, a:i % 10 } );
+}
+assert.eq( 1000, t.count() );
+
+for( i = 0; i < 1000; i += 2 ) {
+    t.update( { _id:i }, { $inc:{ a:1 } } );
+}
+t.find().forEach( function( o ) { assert.eq( o._id % 10 + ( o._id % 2 == 0 ? 1 : 0 ), o.a, tojson( o ) ); } );
+
+for( i = 0; i < 1000; i += 3 ) {
+    t.remove( { _id:i } );
+}
+assert.eq( 666, t.count() );
+assert.eq( 666, t.find().hint( { a:1 } ).itcount() );
+
+// a batch insert probes all its documents before writing any, and documents without _id are probed
+// where their generated _id will go; either way each document is inserted once
+batch = [];
+for( i = 0; i < 500; ++i ) {
+    batch.push( i % 2 ? { _id:"b" + i, a:i % 10 } : { a:i % 10, noId:true } );
+}
+t.insert( batch );
+assert.eq( null, db.getLastError() );
+assert.eq( 1166, t.count() );
+assert.eq( 250, t.count( { noId:true } ) );
+assert.eq( 1166, t.find().hint( { a:1 } ).itcount() );
+assert.eq( 1166, t.find().hint( { _id:1 } ).itcount() );
+
+after = db.serverStatus().writeFaults;
+assert( after.yielded >= before.yielded );
+assert( after.underLock >= before.underLock );
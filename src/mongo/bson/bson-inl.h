@@ -22,6 +22,7 @@
 
 #include <map>
 #include <limits>
+#include "util/fieldnamecmp.h"
 
 #if defined(_WIN32)
 #undef max
@@ -172,13 +173,17 @@ dodouble:
     */
     inline int BSONElement::woCompare( const BSONElement &e,
                                 bool considerFieldName ) const {
-        int lt = (int) canonicalType();
-        int rt = (int) e.canonicalType();
-        int x = lt - rt;
-        if( x != 0 && (!isNumber() || !e.isNumber()) )
-            return x;
+        int x;
+        // same type is by far the common case (e.g. index keys), and then the canonical types are equal too
+        if ( type() != e.type() ) {
+            int lt = (int) canonicalType();
+            int rt = (int) e.canonicalType();
+            x = lt - rt;
+            if( x != 0 && (!isNumber() || !e.isNumber()) )
+                return x;
+        }
         if ( considerFieldName ) {
-            x = strcmp(fieldName(), e.fieldName());
+            x = fieldNameCompare(fieldName(), e.fieldName());
             if ( x != 0 )
                 return x;
         }
@@ -272,7 +277,7 @@ dodouble:
             BSONElement e = i.next();
             const char *p = e.fieldName();
             for( unsigned i = 0; i < n; i++ ) {
-                if( strcmp(p, fieldNames[i]) == 0 ) {
+                if( fieldNamesEqual(p, fieldNames[i]) ) {
                     fields[i] = e;
                     break;
                 }
@@ -284,7 +289,7 @@ dodouble:
         BSONObjIterator i(*this);
         while ( i.more() ) {
             BSONElement e = i.next();
-            if ( strcmp(e.fieldName(), name.data()) == 0 )
+            if ( fieldNamesEqual(e.fieldName(), name.data()) )
                 return e;
         }
         return BSONElement();
@@ -0,0 +1,96 @@
+/* @file fieldnamecmp.h
+
+   Comparison of NUL terminated field names, 16 bytes at a time where the cpu allows.
+*/
+
+/*
+ *    Copyright 2012 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstring>
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define MONGO_FIELDNAMECMP_SSE2 1
+#endif
+
+namespace mongo {
+
+    /** scalar version of fieldNameCompare(), same result as strcmp() */
+    inline int fieldNameCompareScalar( const char *l , const char *r ) {
+        return strcmp( l , r );
+    }
+
+#if defined(MONGO_FIELDNAMECMP_SSE2)
+
+    /**
+     * strlen() with aligned 16 byte loads. A load never leaves the aligned block holding the NUL, so nothing
+     * past the end of the name's block is read.
+     */
+    inline size_t fieldNameLength( const char *p ) {
+        const __m128i zero = _mm_setzero_si128();
+        const char *block = (const char *) ( ( (size_t) p ) & ~ (size_t) 15 );
+        unsigned nul = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_load_si128( (const __m128i *) block ) , zero ) );
+        nul >>= ( p - block );
+        if ( nul )
+            return __builtin_ctz( nul );
+        while ( 1 ) {
+            block += 16;
+            nul = _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_load_si128( (const __m128i *) block ) , zero ) );
+            if ( nul )
+                return ( block - p ) + __builtin_ctz( nul );
+        }
+    }
+
+    /**
+     * Same result as strcmp(). The lengths come first, so the compare only covers bytes of both names up to
+     * and including the NUL of the shorter: 16 at a time while that many are left, then byte by byte.
+     */
+    inline int fieldNameCompare( const char *l , const char *r ) {
+        size_t ll = fieldNameLength( l );
+        size_t rl = fieldNameLength( r );
+        size_t n = ( ll < rl ? ll : rl ) + 1;
+        size_t i = 0;
+        for ( ; i + 16 <= n; i += 16 ) {
+            __m128i a = _mm_loadu_si128( (const __m128i *) ( l + i ) );
+            __m128i b = _mm_loadu_si128( (const __m128i *) ( r + i ) );
+            unsigned diff = ~_mm_movemask_epi8( _mm_cmpeq_epi8( a , b ) ) & 0xffff;
+            if ( diff ) {
+                size_t j = i + __builtin_ctz( diff );
+                return (int) (unsigned char) l[j] - (int) (unsigned char) r[j];
+            }
+        }
+        for ( ; i < n; i++ ) {
+            if ( l[i] != r[i] )
+                return (int) (unsigned char) l[i] - (int) (unsigned char) r[i];
+        }
+        return 0;
+    }
+
+#else
+
+    inline int fieldNameCompare( const char *l , const char *r ) {
+        return fieldNameCompareScalar( l , r );
+    }
+
+#endif
+
+    inline bool fieldNamesEqual( const char *l , const char *r ) {
+        return fieldNameCompare( l , r ) == 0;
+    }
+
+}
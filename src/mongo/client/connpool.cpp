@@ -23,6 +23,7 @@
 //#include "../db/commands.h"
 #include "syncclusterconnection.h"
 #include "../s/shard.h"
+#include "../util/timer.h"
 
 namespace mongo {
 
@@ -37,6 +38,11 @@ namespace mongo {
     }
 
     void PoolForHost::done( DBConnectionPool * pool, DBClientBase * c ) {
+        checkedOutDestroyed();
+        addIdle( pool , c );
+    }
+
+    void PoolForHost::addIdle( DBConnectionPool * pool, DBClientBase * c ) {
         if ( _pool.size() >= _maxPerHost ) {
             pool->onDestroy( c );
             delete c;
@@ -62,6 +68,7 @@ namespace mongo {
             
             assert( sc.conn->getSoTimeout() == socketTimeout );
 
+            _checkedOut++;
             return sc.conn;
 
         }
@@ -110,8 +117,8 @@ namespace mongo {
     }
 
     bool PoolForHost::StoredConnection::ok( time_t now ) {
-        // if connection has been idle for 30 minutes, kill it
-        return ( now - when ) < 1800;
+        // if connection has been idle too long (30 minutes by default), kill it
+        return ( now - when ) < _idleTimeoutSecs;
     }
 
     void PoolForHost::createdOne( DBClientBase * base) {
@@ -120,7 +127,66 @@ namespace mongo {
         _created++;
     }
 
+    bool PoolForHost::addWarmed( DBClientBase * c ) {
+        if ( _pool.size() >= _maxPerHost )
+            return false;
+        createdOne( c );
+        _pool.push( c );
+        return true;
+    }
+
+    int PoolForHost::numToWarm() const {
+        int open = numAvailable() + numInUse();
+        if ( _created == 0 || open >= (int)_minPerHost || atLimit() )
+            return 0;
+        int n = _minPerHost - open;
+        if ( _maxInUsePerHost )
+            n = min( n , (int)_maxInUsePerHost - _checkedOut );
+        return min( n , (int)_maxPerHost - numAvailable() );
+    }
+
+    void PoolForHost::waitFinished( long long micros , bool timedOut ) {
+        _waiters--;
+        _totalWaits++;
+        if ( timedOut )
+            _timedOutWaits++;
+        _totalWaitMicros += micros;
+
+        long long millis = micros / 1000;
+        int bucket = 0;
+        while ( bucket < NumWaitBuckets - 1 && millis >= ( 1LL << bucket ) )
+            bucket++;
+        _waitBuckets[bucket]++;
+    }
+
+    void PoolForHost::appendStats( BSONObjBuilder& b ) const {
+        b.append( "available" , numAvailable() );
+        b.appendNumber( "created" , numCreated() );
+        b.append( "inUse" , numInUse() );
+        b.append( "waiters" , numWaiters() );
+        b.appendNumber( "totalWaits" , _totalWaits );
+        b.appendNumber( "timedOutWaits" , _timedOutWaits );
+        b.appendNumber( "totalWaitMicros" , _totalWaitMicros );
+
+        if ( _totalWaits ) {
+            BSONObjBuilder hist( b.subobjStart( "waitTimeMillis" ) );
+            for ( int i = 0; i < NumWaitBuckets; i++ ) {
+                if ( ! _waitBuckets[i] )
+                    continue;
+                string bound = i == NumWaitBuckets - 1 ?
+                    str::stream() << ">=" << ( 1LL << ( i - 1 ) ) :
+                    str::stream() << "<" << ( 1LL << i );
+                hist.appendNumber( bound , _waitBuckets[i] );
+            }
+            hist.done();
+        }
+    }
+
     unsigned PoolForHost::_maxPerHost = 50;
+    unsigned PoolForHost::_maxInUsePerHost = 0;
+    unsigned PoolForHost::_minPerHost = 0;
+    unsigned PoolForHost::_waitTimeoutMillis = 20 * 1000;
+    unsigned PoolForHost::_idleTimeoutSecs = 1800;
 
     // ------ DBConnectionPool ------
 
@@ -132,11 +198,56 @@ namespace mongo {
           _hooks( new list<DBConnectionHook*>() ) { 
     }
 
-    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
+    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout , bool idleOnly ) {
         assert( ! inShutdown() );
         scoped_lock L(_mutex);
         PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
-        return p.get( this , socketTimeout );
+
+        if ( idleOnly ) {
+            if ( p.nearLimit() )
+                return 0;
+            return p.get( this , socketTimeout );
+        }
+
+        DBClientBase* c = p.get( this , socketTimeout );
+
+        if ( ! c && p.atLimit() ) {
+            // the host has as many connections in use as it may, wait for one to come back
+            Timer t;
+            const long long timeoutMicros = PoolForHost::getWaitTimeoutMillis() * 1000LL;
+            bool timedOut = false;
+
+            p.waitStarted();
+            while ( ! c && p.atLimit() ) {
+                long long remaining = timeoutMicros - t.micros();
+                if ( remaining <= 0 ) {
+                    timedOut = true;
+                    break;
+                }
+                _connReturned.timed_wait( L.boost() , boost::posix_time::microseconds( remaining ) );
+                c = p.get( this , socketTimeout );
+            }
+            p.waitFinished( t.micros() , timedOut );
+
+            uassert( 16107 , str::stream() << _name << ": timed out after " << t.millis()
+                     << "ms waiting for a connection to " << ident << ", "
+                     << p.numInUse() << " in use" , ! timedOut );
+        }
+
+        // the caller creates a connection when we return NULL, count it as in use now
+        // so concurrent callers can't overshoot the limit
+        if ( ! c )
+            p.reserveOne();
+
+        return c;
+    }
+
+    void DBConnectionPool::_createFailed( const string& ident , double socketTimeout ) {
+        scoped_lock L(_mutex);
+        PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
+        p.checkedOutDestroyed();
+        if ( p.numWaiters() )
+            _connReturned.notify_all();
     }
 
     DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
@@ -152,6 +263,7 @@ namespace mongo {
         }
         catch ( std::exception & ) {
             delete conn;
+            _createFailed( host , socketTimeout );
             throw;
         }
 
@@ -166,6 +278,7 @@ namespace mongo {
             }
             catch ( std::exception& ) {
                 delete c;
+                _createFailed( url.toString() , socketTimeout );
                 throw;
             }
             return c;
@@ -173,19 +286,32 @@ namespace mongo {
 
         string errmsg;
         c = url.connect( errmsg, socketTimeout );
+        if ( ! c )
+            _createFailed( url.toString() , socketTimeout );
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
         return _finishCreate( url.toString() , socketTimeout , c );
     }
 
+    DBClientBase* DBConnectionPool::getIfSpare(const string& host, double socketTimeout) {
+        DBClientBase * c = _get( host , socketTimeout , true );
+        if ( ! c )
+            return 0;
+        return _finishGet( host , socketTimeout , c );
+    }
+
     DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
-        DBClientBase * c = _get( host , socketTimeout );
+        return _finishGet( host , socketTimeout , _get( host , socketTimeout ) );
+    }
+
+    DBClientBase* DBConnectionPool::_finishGet(const string& host, double socketTimeout, DBClientBase* c) {
         if ( c ) {
             try {
                 onHandedOut( c );
             }
             catch ( std::exception& ) {
                 delete c;
+                _createFailed( host , socketTimeout );
                 throw;
             }
             return c;
@@ -193,22 +319,71 @@ namespace mongo {
 
         string errmsg;
         ConnectionString cs = ConnectionString::parse( host , errmsg );
+        if ( ! cs.isValid() )
+            _createFailed( host , socketTimeout );
         uassert( 13071 , (string)"invalid hostname [" + host + "]" + errmsg , cs.isValid() );
 
         c = cs.connect( errmsg, socketTimeout );
-        if ( ! c )
+        if ( ! c ) {
+            _createFailed( host , socketTimeout );
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
+        }
         return _finishCreate( host , socketTimeout , c );
     }
 
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
+        if ( c->isFailed() ) {
+            decrementEgress( host , c );
+            onDestroy( c );
+            delete c;
+            return;
+        }
+        scoped_lock L(_mutex);
+        PoolForHost& p = _pools[PoolKey(host,c->getSoTimeout())];
+        p.done(this,c);
+        if ( p.numWaiters() )
+            _connReturned.notify_all();
+    }
+
+    void DBConnectionPool::decrementEgress(const string& host, DBClientBase *c) {
+        _createFailed( host , c->getSoTimeout() );
+    }
+
+    bool DBConnectionPool::isAtLimit(const string& host, double socketTimeout) {
+        scoped_lock L(_mutex);
+        return _pools[PoolKey(host,socketTimeout)].atLimit();
+    }
+
+    void DBConnectionPool::park(const string& host, DBClientBase *c) {
+        scoped_lock L(_mutex);
+        PoolForHost& p = _pools[PoolKey(host,c->getSoTimeout())];
+        p.checkedOutDestroyed();
+        if ( p.numWaiters() )
+            _connReturned.notify_all();
+    }
+
+    bool DBConnectionPool::unpark(const string& host, DBClientBase *c) {
+        scoped_lock L(_mutex);
+        PoolForHost& p = _pools[PoolKey(host,c->getSoTimeout())];
+        if ( p.atLimit() ) {
+            p.addIdle( this , c );
+            return false;
+        }
+        p.reserveOne();
+        return true;
+    }
+
+    void DBConnectionPool::releaseParked(const string& host, DBClientBase *c) {
         if ( c->isFailed() ) {
             onDestroy( c );
             delete c;
             return;
         }
         scoped_lock L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        PoolForHost& p = _pools[PoolKey(host,c->getSoTimeout())];
+        p.addIdle(this,c);
+        if ( p.numWaiters() )
+            _connReturned.notify_all();
     }
 
 
@@ -259,6 +434,8 @@ namespace mongo {
 
         int avail = 0;
         long long created = 0;
+        int inUse = 0;
+        int waiters = 0;
 
 
         map<ConnectionString::ConnectionType,long long> createdByType;
@@ -275,12 +452,13 @@ namespace mongo {
                 string s = str::stream() << i->first.ident << "::" << i->first.timeout;
 
                 BSONObjBuilder temp( bb.subobjStart( s ) );
-                temp.append( "available" , i->second.numAvailable() );
-                temp.appendNumber( "created" , i->second.numCreated() );
+                i->second.appendStats( temp );
                 temp.done();
 
                 avail += i->second.numAvailable();
                 created += i->second.numCreated();
+                inUse += i->second.numInUse();
+                waiters += i->second.numWaiters();
 
                 long long& x = createdByType[i->second.type()];
                 x += i->second.numCreated();
@@ -322,6 +500,8 @@ namespace mongo {
 
         b.append( "totalAvailable" , avail );
         b.appendNumber( "totalCreated" , created );
+        b.append( "totalInUse" , inUse );
+        b.append( "totalWaiters" , waiters );
     }
 
     bool DBConnectionPool::serverNameCompare::operator()( const string& a , const string& b ) const{
@@ -382,6 +562,62 @@ namespace mongo {
                 // we don't care if there was a socket error
             }
         }
+
+        _warm();
+    }
+
+    void DBConnectionPool::_warm() {
+        vector< pair<PoolKey,int> > toWarm;
+        {
+            scoped_lock lk( _mutex );
+            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
+                int n = i->second.numToWarm();
+                if ( n > 0 )
+                    toWarm.push_back( make_pair( i->first , n ) );
+            }
+        }
+
+        // connect outside the lock so callers of get() are never blocked on it
+        for ( size_t i=0; i<toWarm.size() && ! inShutdown(); i++ ) {
+            const PoolKey& key = toWarm[i].first;
+
+            string errmsg;
+            ConnectionString cs = ConnectionString::parse( key.ident , errmsg );
+            if ( ! cs.isValid() )
+                continue;
+
+            for ( int j=0; j<toWarm[i].second; j++ ) {
+                DBClientBase* c = cs.connect( errmsg , key.timeout );
+                if ( ! c ) {
+                    LOG(1) << _name << ": couldn't warm connection to " << key.ident << causedBy( errmsg ) << endl;
+                    break;
+                }
+
+                try {
+                    onCreate( c );
+                }
+                catch ( std::exception& e ) {
+                    LOG(1) << _name << ": couldn't warm connection to " << key.ident << causedBy( e ) << endl;
+                    delete c;
+                    break;
+                }
+
+                bool added;
+                {
+                    scoped_lock lk( _mutex );
+                    PoolForHost& p = _pools[key];
+                    added = p.addWarmed( c );
+                    if ( added && p.numWaiters() )
+                        _connReturned.notify_all();
+                }
+
+                if ( ! added ) {
+                    onDestroy( c );
+                    delete c;
+                    break;
+                }
+            }
+        }
     }
 
     // ------ ScopedDbConnection ------
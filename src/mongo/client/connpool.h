@@ -35,17 +35,24 @@ namespace mongo {
     class PoolForHost {
     public:
         PoolForHost()
-            : _created(0) {}
+            : _created(0), _checkedOut(0), _waiters(0), _totalWaits(0), _timedOutWaits(0), _totalWaitMicros(0) {
+            memset( _waitBuckets , 0 , sizeof( _waitBuckets ) );
+        }
 
         PoolForHost( const PoolForHost& other ) {
             assert(other._pool.size() == 0);
             _created = other._created;
             assert( _created == 0 );
+            _checkedOut = _waiters = 0;
+            _totalWaits = _timedOutWaits = _totalWaitMicros = 0;
+            memset( _waitBuckets , 0 , sizeof( _waitBuckets ) );
         }
 
         ~PoolForHost();
 
         int numAvailable() const { return (int)_pool.size(); }
+        int numInUse() const { return _checkedOut; }
+        int numWaiters() const { return _waiters; }
 
         void createdOne( DBClientBase * base );
         long long numCreated() const { return _created; }
@@ -59,12 +66,59 @@ namespace mongo {
 
         void done( DBConnectionPool * pool , DBClientBase * c );
 
+        /** like done(), for a connection that wasn't counted as in use */
+        void addIdle( DBConnectionPool * pool , DBClientBase * c );
+
+        /**
+         * @return true if no more connections may be handed out until one is returned
+         */
+        bool atLimit() const { return _maxInUsePerHost && _checkedOut >= (int)_maxInUsePerHost; }
+
+        /** @return true if handing out one more connection would leave none for other callers */
+        bool nearLimit() const { return _maxInUsePerHost && _checkedOut + 1 >= (int)_maxInUsePerHost; }
+
+        /** counts a connection the caller is about to create as in use */
+        void reserveOne() { _checkedOut++; }
+
+        /** a connection that was handed out was destroyed rather than returned */
+        void checkedOutDestroyed() { if ( _checkedOut > 0 ) _checkedOut--; }
+
+        /**
+         * adds a connection created ahead of demand to the idle pool
+         * @return false if the pool is full and the caller should destroy the connection
+         */
+        bool addWarmed( DBClientBase * c );
+
+        /** @return how many connections should be created ahead of demand */
+        int numToWarm() const;
+
+        void waitStarted() { _waiters++; }
+        void waitFinished( long long micros , bool timedOut );
+
+        void appendStats( BSONObjBuilder& b ) const;
+
         void flush();
         
         void getStaleConnections( vector<DBClientBase*>& stale );
 
         static void setMaxPerHost( unsigned max ) { _maxPerHost = max; }
         static unsigned getMaxPerHost() { return _maxPerHost; }
+
+        /** max connections handed out at once per host, 0 is unlimited */
+        static void setMaxInUsePerHost( unsigned max ) { _maxInUsePerHost = max; }
+        static unsigned getMaxInUsePerHost() { return _maxInUsePerHost; }
+
+        /** connections kept open per host by the cleaner task even when idle */
+        static void setMinPerHost( unsigned min ) { _minPerHost = min; }
+        static unsigned getMinPerHost() { return _minPerHost; }
+
+        /** how long get() waits for a connection when the host is at its limit */
+        static void setWaitTimeoutMillis( unsigned millis ) { _waitTimeoutMillis = millis; }
+        static unsigned getWaitTimeoutMillis() { return _waitTimeoutMillis; }
+
+        /** idle connections older than this are closed by the cleaner task */
+        static void setIdleTimeoutSecs( unsigned secs ) { _idleTimeoutSecs = secs; }
+        static unsigned getIdleTimeoutSecs() { return _idleTimeoutSecs; }
     private:
 
         struct StoredConnection {
@@ -81,7 +135,21 @@ namespace mongo {
         long long _created;
         ConnectionString::ConnectionType _type;
 
+        int _checkedOut;
+        int _waiters;
+
+        // wait time histogram, bucket i counts waits under 2^i ms, the last one the rest
+        enum { NumWaitBuckets = 12 };
+        long long _totalWaits;
+        long long _timedOutWaits;
+        long long _totalWaitMicros;
+        long long _waitBuckets[NumWaitBuckets];
+
         static unsigned _maxPerHost;
+        static unsigned _maxInUsePerHost;
+        static unsigned _minPerHost;
+        static unsigned _waitTimeoutMillis;
+        static unsigned _idleTimeoutSecs;
     };
 
     class DBConnectionHook {
@@ -126,8 +194,40 @@ namespace mongo {
         DBClientBase *get(const string& host, double socketTimeout = 0);
         DBClientBase *get(const ConnectionString& host, double socketTimeout = 0);
 
+        /**
+         * For optional extra connections, e.g. cursor read-ahead: like get(), but only hands out an
+         * idle pooled connection. Never waits or connects, and returns NULL rather than take one of
+         * the last connections the host may have in use.
+         */
+        DBClientBase *getIfSpare(const string& host, double socketTimeout = 0);
+
         void release(const string& host, DBClientBase *c);
 
+        /**
+         * Call instead of release when destroying a connection handed out by this pool,
+         * so its host can hand out another.  Does not delete c.
+         */
+        void decrementEgress(const string& host, DBClientBase *c);
+
+        /** @return true if host has as many connections in use as it may */
+        bool isAtLimit(const string& host, double socketTimeout = 0);
+
+        /**
+         * The holder of c keeps it idle for its own later use (e.g. the per thread shard connection cache):
+         * c no longer counts as in use, so it doesn't hold back the host's other callers.
+         */
+        void park(const string& host, DBClientBase *c);
+
+        /**
+         * Takes a parked connection back into use.
+         * @return false if the host is at its limit, in which case c was given to the pool and the caller
+         * has to get() a connection like anybody else
+         */
+        bool unpark(const string& host, DBClientBase *c);
+
+        /** release() for a parked connection */
+        void releaseParked(const string& host, DBClientBase *c);
+
         void addHook( DBConnectionHook * hook ); // we take ownership
         void appendInfo( BSONObjBuilder& b );
 
@@ -142,9 +242,21 @@ namespace mongo {
     private:
         DBConnectionPool( DBConnectionPool& p );
         
-        DBClientBase* _get( const string& ident , double socketTimeout );
+        /**
+         * @param idleOnly return an idle connection or NULL, without waiting or reserving a slot to
+         * connect, and NULL as well if the host is near its limit
+         */
+        DBClientBase* _get( const string& ident , double socketTimeout , bool idleOnly = false );
 
+        /** hands out c from _get, or connects to host for the slot _get reserved when c is NULL */
+        DBClientBase* _finishGet( const string& host , double socketTimeout , DBClientBase* c );
         DBClientBase* _finishCreate( const string& ident , double socketTimeout, DBClientBase* conn );
+
+        /** a connection reserved by _get could not be created */
+        void _createFailed( const string& ident , double socketTimeout );
+
+        /** opens idle connections for hosts below the minimum pool size */
+        void _warm();
         
         struct PoolKey {
             PoolKey( string i , double t ) : ident( i ) , timeout( t ) {}
@@ -159,6 +271,7 @@ namespace mongo {
         typedef map<PoolKey,PoolForHost,poolKeyCompare> PoolMap; // servername -> pool
 
         mongo::mutex _mutex;
+        boost::condition _connReturned; // signalled under _mutex when a host at its limit frees a connection
         string _name;
         
         PoolMap _pools;
@@ -171,6 +284,9 @@ namespace mongo {
 
     extern DBConnectionPool pool;
 
+    /** connections from mongos to the shards, also used by mongod for migrations */
+    extern DBConnectionPool shardConnectionPool;
+
     class AScopedConnection : boost::noncopyable {
     public:
         AScopedConnection() { _numConnections++; }
@@ -251,6 +367,8 @@ namespace mongo {
             a bad state.  Destructor will do this too, but it is verbose.
         */
         void kill() {
+            if ( _conn )
+                pool.decrementEgress( _host , _conn );
             delete _conn;
             _conn = 0;
         }
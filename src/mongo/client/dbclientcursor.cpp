@@ -29,6 +29,8 @@ namespace mongo {
 
     void DBClientCursor::_finishConsInit() {
         _originalHost = _client->toString();
+        _readAheadConn = 0;
+        _readAheadId = 0;
     }
 
     int DBClientCursor::nextBatchSize() {
@@ -103,9 +105,83 @@ namespace mongo {
         return ! retry;
     }
 
+    void DBClientCursor::readAhead() {
+        if ( _readAheadConn || _client || ! cursorId || _scopedHost.empty() )
+            return;
+        // with a limit the size of the next request depends on this batch being done
+        if ( haveLimit || ( opts & ( QueryOption_CursorTailable | QueryOption_Exhaust ) ) )
+            return;
+        if ( objsLeftInBatch() * 4 > batch.nReturned )
+            return;
+
+        // an optional extra connection, don't take it if the host's other users may need it
+        DBClientBase* c = pool.getIfSpare( _scopedHost );
+        if ( ! c )
+            return;
+
+        auto_ptr<ScopedDbConnection> conn( new ScopedDbConnection( _scopedHost , c ) );
+        if ( ! conn->get()->lazySupported() ) {
+            conn->done();
+            return;
+        }
+
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+
+        Message toSend;
+        toSend.setData(dbGetMore, b.buf(), b.len());
+        try {
+            conn->get()->say( toSend );
+        }
+        catch ( std::exception& e ) {
+            // only an optimization, requestMore() will do a plain getMore
+            log() << "getMore read ahead to " << _scopedHost << " failed: " << e.what() << endl;
+            conn->kill();
+            return;
+        }
+
+        _readAheadId = toSend.header()->id;
+        _readAheadConn = conn.release();
+    }
+
     void DBClientCursor::requestMore() {
         assert( cursorId && batch.pos == batch.nReturned );
 
+        if ( _readAheadConn ) {
+            // the getMore was sent by readAhead(), just collect the reply
+            auto_ptr<ScopedDbConnection> conn( _readAheadConn );
+            _readAheadConn = 0;
+
+            auto_ptr<Message> response(new Message());
+            if ( ! conn->get()->recv( *response ) ) {
+                conn->kill();
+                uasserted( 16108 , str::stream() << "getMore read ahead from " << _scopedHost << " failed" );
+            }
+            if ( response->header()->responseTo != _readAheadId ) {
+                conn->kill();
+                uasserted( 16146 , str::stream() << "getMore read ahead from " << _scopedHost
+                           << " got a reply to " << response->header()->responseTo
+                           << " instead of " << _readAheadId );
+            }
+
+            _client = conn->get();
+            this->batch.m = response;
+            try {
+                dataReceived();
+            }
+            catch ( ... ) {
+                _client = 0;
+                conn->done();
+                throw;
+            }
+            _client = 0;
+            conn->done();
+            return;
+        }
+
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             assert(nToReturn > 0);
@@ -300,6 +376,13 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
+        if ( _readAheadConn ) {
+            // a reply is still in flight on this connection, it can't go back to the pool
+            _readAheadConn->kill();
+            delete _readAheadConn;
+            _readAheadConn = 0;
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
@@ -26,6 +26,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here 
         @see DBClientMockCursor
@@ -163,6 +164,14 @@ namespace mongo {
 
         void attach( AScopedConnection * conn );
 
+        /**
+         * Once at most a quarter of the current batch is left, sends the getMore for the next
+         * batch without waiting for the reply, so it is in flight while the rest of this batch
+         * is consumed.  The reply is read when the batch runs out.  Only applies to cursors
+         * whose connection was attach()ed away; does nothing otherwise.
+         */
+        void readAhead();
+
         string originalHost() const { return _originalHost; }
 
         Message* getMessage(){ return batch.m.get(); }
@@ -210,6 +219,8 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        ScopedDbConnection* _readAheadConn; // owned, holds an outstanding getMore from readAhead()
+        MSGID _readAheadId; // id of that getMore, its reply must answer it
 
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, string& lazyHost );
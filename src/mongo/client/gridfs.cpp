@@ -21,6 +21,7 @@
 #include <fstream>
 
 #include "gridfs.h"
+#include "../util/md5.hpp"
 #include <boost/smart_ptr.hpp>
 
 #if defined(_WIN32)
@@ -75,17 +76,25 @@ namespace mongo {
         id.init();
         BSONObj idObj = BSON("_id" << id);
 
+        md5_state_t st;
+        md5_init(&st);
+
         int chunkNumber = 0;
         while (data < end) {
             int chunkLen = MIN(_chunkSize, (unsigned)(end-data));
             GridFSChunk c(idObj, chunkNumber, data, chunkLen);
             _client.insert( _chunksNS.c_str() , c._data );
+            md5_append(&st, (const md5_byte_t *) data, chunkLen);
 
             chunkNumber++;
             data += chunkLen;
         }
 
-        return insertFile(remoteName, id, length, contentType);
+        checkChunks( id , chunkNumber );
+
+        md5digest d;
+        md5_finish(&st, d);
+        return insertFile(remoteName, id, length, contentType, digestToString( d ));
     }
 
 
@@ -103,6 +112,9 @@ namespace mongo {
         id.init();
         BSONObj idObj = BSON("_id" << id);
 
+        md5_state_t st;
+        md5_init(&st);
+
         int chunkNumber = 0;
         gridfs_offset length = 0;
         while (!feof(fd)) {
@@ -119,7 +131,16 @@ namespace mongo {
             }
 
             GridFSChunk c(idObj, chunkNumber, buf, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            try {
+                _client.insert( _chunksNS.c_str() , c._data );
+            }
+            catch ( DBException& ) {
+                delete[] buf;
+                if (fd != stdin)
+                    fclose( fd );
+                throw;
+            }
+            md5_append(&st, (const md5_byte_t *) buf, chunkLen);
 
             length += chunkLen;
             chunkNumber++;
@@ -129,21 +150,33 @@ namespace mongo {
         if (fd != stdin)
             fclose( fd );
 
-        return insertFile((remoteName.empty() ? fileName : remoteName), id, length, contentType);
+        checkChunks( id , chunkNumber );
+
+        md5digest d;
+        md5_finish(&st, d);
+        return insertFile((remoteName.empty() ? fileName : remoteName), id, length, contentType, digestToString( d ));
     }
 
-    BSONObj GridFS::insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType) {
+    void GridFS::checkChunks( const OID& id , int numChunks ) {
+        string err = _client.getLastError();
+        if ( ! err.empty() )
+            throw UserException( 9008 , "storing chunks failed: " + err );
+
+        // getLastError only reports on the last insert, an earlier one may have failed
+        unsigned long long n = _client.count( _chunksNS , BSON( "files_id" << id ) );
+        if ( n != (unsigned long long) numChunks )
+            throw UserException( 16149 , str::stream() << "storing chunks failed: " << n << " of "
+                                 << numChunks << " chunks stored" );
+    }
 
-        BSONObj res;
-        if ( ! _client.runCommand( _dbName.c_str() , BSON( "filemd5" << id << "root" << _prefix ) , res ) )
-            throw UserException( 9008 , "filemd5 failed" );
+    BSONObj GridFS::insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType, const string& md5) {
 
         BSONObjBuilder file;
         file << "_id" << id
              << "filename" << name
              << "chunkSize" << _chunkSize
              << "uploadDate" << DATENOW
-             << "md5" << res["md5"]
+             << "md5" << md5
              ;
 
         if (length < 1024*1024*1024) { // 2^30
@@ -214,20 +247,56 @@ namespace mongo {
         return GridFSChunk(o);
     }
 
+    auto_ptr<DBClientCursor> GridFile::_chunks( int first , int last , int batchSize ) const {
+        BSONObjBuilder b;
+        b.appendAs( _obj["_id"] , "files_id" );
+        b.append( "n" , BSON( "$gte" << first << "$lte" << last ) );
+
+        auto_ptr<DBClientCursor> c = _grid->_client.query( _grid->_chunksNS.c_str() ,
+                                                           Query( b.obj() ).sort( BSON( "files_id" << 1 << "n" << 1 ) ) ,
+                                                           0 , 0 , 0 , 0 , batchSize );
+        uassert( 16134 , "couldn't query chunks" , c.get() );
+        return c;
+    }
+
     gridfs_offset GridFile::write( ostream & out ) const {
         _exists();
 
-        const int num = getNumChunks();
+        write( out , 0 , getContentLength() );
+        return getContentLength();
+    }
+
+    gridfs_offset GridFile::write( ostream & out , gridfs_offset offset , gridfs_offset length ) const {
+        _exists();
 
-        for ( int i=0; i<num; i++ ) {
-            GridFSChunk c = getChunk( i );
+        const gridfs_offset size = getContentLength();
+        if ( offset >= size || length == 0 )
+            return 0;
+        length = std::min( length , size - offset );
+
+        const int chunkSize = getChunkSize();
+        const int first = (int)( offset / chunkSize );
+        const int last = (int)( ( offset + length - 1 ) / chunkSize );
+
+        // the whole span in as few round trips as the server's batch limit allows
+        auto_ptr<DBClientCursor> chunks = _chunks( first , last , last - first + 1 );
+
+        gridfs_offset written = 0;
+        for ( int n = first; n <= last; n++ ) {
+            uassert( 16140 ,  "chunk is empty!" , chunks->more() );
+            GridFSChunk c( chunks->next() );
+            uassert( 16136 , str::stream() << "chunk " << n << " is missing" , c._data["n"].numberInt() == n );
 
             int len;
             const char * data = c.data( len );
-            out.write( data , len );
+            gridfs_offset start = ( n == first ) ? offset - (gridfs_offset)n * chunkSize : 0;
+            uassert( 16137 , str::stream() << "chunk " << n << " is too short" , start <= (gridfs_offset)len );
+            gridfs_offset amt = std::min( (gridfs_offset)len - start , length - written );
+            out.write( data + start , amt );
+            written += amt;
         }
 
-        return getContentLength();
+        return written;
     }
 
     gridfs_offset GridFile::write( const string& where ) const {
@@ -245,4 +314,53 @@ namespace mongo {
         uassert( 10015 ,  "doesn't exists" , exists() );
     }
 
+    GridFileReader::GridFileReader( const GridFile& file , gridfs_offset offset , int readAhead )
+        : _file( file ) , _pos( offset ) , _readAhead( readAhead ) , _chunk( BSONObj() ) , _chunkNumber( -1 ) {
+        _file._exists();
+    }
+
+    void GridFileReader::seek( gridfs_offset offset ) {
+        _pos = offset;
+    }
+
+    void GridFileReader::_fetch() {
+        const int chunkSize = _file.getChunkSize();
+        const int n = (int)( _pos / chunkSize );
+        if ( n == _chunkNumber )
+            return;
+
+        // a forward seek within what the cursor is reading ahead just skips chunks
+        if ( n < _chunkNumber || ! _cursor.get() || n - _chunkNumber > std::max( 1 , _readAhead / chunkSize ) ) {
+            _cursor = _file._chunks( n , _file.getNumChunks() - 1 , std::max( 2 , _readAhead / chunkSize ) );
+            _chunkNumber = n - 1;
+        }
+
+        while ( _chunkNumber < n ) {
+            uassert( 16141 ,  "chunk is empty!" , _cursor->more() );
+            _chunk = GridFSChunk( _cursor->next().getOwned() );
+            _chunkNumber++;
+            uassert( 16142 , str::stream() << "chunk " << _chunkNumber << " is missing" , _chunk._data["n"].numberInt() == _chunkNumber );
+        }
+    }
+
+    size_t GridFileReader::read( char * buf , size_t len ) {
+        const gridfs_offset size = _file.getContentLength();
+        const int chunkSize = _file.getChunkSize();
+
+        size_t done = 0;
+        while ( done < len && _pos < size ) {
+            _fetch();
+
+            int chunkLen;
+            const char * data = _chunk.data( chunkLen );
+            gridfs_offset start = _pos - (gridfs_offset)_chunkNumber * chunkSize;
+            uassert( 16143 , str::stream() << "chunk " << _chunkNumber << " is too short" , start < (gridfs_offset)chunkLen );
+            size_t amt = std::min( (size_t)( chunkLen - start ) , len - done );
+            memcpy( buf + done , data + start , amt );
+            done += amt;
+            _pos += amt;
+        }
+        return done;
+    }
+
 }
@@ -45,6 +45,8 @@ namespace mongo {
     private:
         BSONObj _data;
         friend class GridFS;
+        friend class GridFile;
+        friend class GridFileReader;
     };
 
 
@@ -125,8 +127,12 @@ namespace mongo {
         string _chunksNS;
         unsigned int _chunkSize;
 
-        // insert fileobject. All chunks must be in DB.
-        BSONObj insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType);
+        // check that all the chunks of a file got there, as nothing reads them back to compute the md5.
+        // done once per file, not once per chunk
+        void checkChunks( const OID& id , int numChunks );
+
+        // insert fileobject. All chunks must be in DB. md5 is of the data, computed while storing it
+        BSONObj insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType, const string& md5);
 
         friend class GridFile;
     };
@@ -185,6 +191,13 @@ namespace mongo {
          */
         gridfs_offset write( ostream & out ) const;
 
+        /**
+           write length bytes of the file, starting at offset, to the output stream.
+           fetches just the chunks they span, with one cursor
+           @return the number of bytes written, less than length if the file ends first
+         */
+        gridfs_offset write( ostream & out , gridfs_offset offset , gridfs_offset length ) const;
+
         /**
            write the file to this filename
          */
@@ -195,10 +208,44 @@ namespace mongo {
 
         void _exists() const;
 
+        /** chunks first through last in order, batchSize of them per round trip */
+        auto_ptr<DBClientCursor> _chunks( int first , int last , int batchSize ) const;
+
         const GridFS * _grid;
         BSONObj        _obj;
 
         friend class GridFS;
+        friend class GridFileReader;
+    };
+
+    /**
+       reads a file stored in GridFS from any offset, for streaming it or serving byte ranges.
+       chunks are fetched ahead of the reader, about readAhead bytes of them per round trip
+     */
+    class GridFileReader : boost::noncopyable {
+    public:
+        GridFileReader( const GridFile& file , gridfs_offset offset = 0 , int readAhead = 4 * 1024 * 1024 );
+
+        /** @return bytes copied into buf, less than len only at the end of the file */
+        size_t read( char * buf , size_t len );
+
+        /** a seek within the chunk already fetched doesn't query again */
+        void seek( gridfs_offset offset );
+
+        gridfs_offset tell() const { return _pos; }
+
+        bool eof() const { return _pos >= _file.getContentLength(); }
+
+    private:
+        /** makes _chunk the one holding _pos */
+        void _fetch();
+
+        GridFile _file;
+        gridfs_offset _pos;
+        int _readAhead;
+        auto_ptr<DBClientCursor> _cursor;
+        GridFSChunk _chunk;
+        int _chunkNumber; // of _chunk, -1 before the first
     };
 }
 
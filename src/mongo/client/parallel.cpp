@@ -353,6 +353,11 @@ namespace mongo {
         return _next;
     }
 
+    void FilteringClientCursor::readAhead() {
+        if ( _cursor.get() && ! _done )
+            _cursor->readAhead();
+    }
+
     void FilteringClientCursor::_advance() {
         assert( _next.isEmpty() );
         if ( ! _cursor.get() || _done )
@@ -461,6 +466,7 @@ namespace mongo {
     void ParallelSortClusteredCursor::_finishCons() {
         _numServers = _servers.size();
         _cursors = 0;
+        _heapBuilt = false;
 
         if( ! _qSpec.isEmpty() ){
 
@@ -679,6 +685,19 @@ namespace mongo {
 
     }
 
+    BSONObj ParallelSortClusteredCursor::_replaceFilter( const BSONObj& query, const BSONObj& filter ){
+        bool hasDollar;
+        if( ! Query( query ).isComplex( &hasDollar ) ) return filter;
+
+        const char* filterField = hasDollar ? "$query" : "query";
+        BSONObjBuilder b;
+        BSONForEach( e, query ){
+            if( strcmp( e.fieldName(), filterField ) == 0 ) b.append( filterField, filter );
+            else b.append( e );
+        }
+        return b.obj();
+    }
+
     void ParallelSortClusteredCursor::startInit() {
 
         bool returnPartial = ( _qSpec.options() & QueryOption_PartialResults );
@@ -696,6 +715,7 @@ namespace mongo {
 
         set<Shard> todoStorage;
         set<Shard>& todo = todoStorage;
+        map<Shard,BSONObj> shardQueries;
         string vinfo;
 
         if( isVersioned() ){
@@ -712,6 +732,15 @@ namespace mongo {
             if( manager ) manager->getShardsForQuery( todo, specialFilter ? _cInfo.cmdFilter : _qSpec.filter() );
             else if( primary ) todo.insert( *primary );
 
+            // Only send each shard the shard key $in values it owns
+            if( manager && ! specialFilter && ! isCommand() && todo.size() > 1 ){
+                map<Shard,BSONObj> shardFilters;
+                manager->getShardQueries( _qSpec.filter(), shardFilters );
+                for( map<Shard,BSONObj>::iterator i = shardFilters.begin(), end = shardFilters.end(); i != end; ++i ){
+                    shardQueries[ i->first ] = _replaceFilter( _qSpec.query(), i->second );
+                }
+            }
+
             // Close all cursors on extra shards first, as these will be invalid
             for( map< Shard, PCMData >::iterator i = _cursorMap.begin(), end = _cursorMap.end(); i != end; ++i ){
 
@@ -812,7 +841,10 @@ namespace mongo {
                     // or if the number of shards to query is > 1
                     if( ( isVersioned() && ! primary ) || _qShards.size() > 1 ){
 
-                        state->cursor.reset( new DBClientCursor( state->conn->get(), _qSpec.ns(), _qSpec.query(),
+                        map<Shard,BSONObj>::const_iterator shardQuery = shardQueries.find( shard );
+
+                        state->cursor.reset( new DBClientCursor( state->conn->get(), _qSpec.ns(),
+                                                                 shardQuery == shardQueries.end() ? _qSpec.query() : shardQuery->second,
                                                                  isCommand() ? 1 : 0, // nToReturn (0 if query indicates multi)
                                                                  0, // nToSkip
                                                                  // Does this need to be a ptr?
@@ -1430,6 +1462,46 @@ namespace mongo {
         _cursors = 0;
     }
 
+    /**
+     * Orders indexes into an array of cursors so that std heap functions keep the cursor
+     * whose next document sorts first at the front.  All cursors compared must have more().
+     */
+    class ShardCursorCmp {
+    public:
+        ShardCursorCmp( FilteringClientCursor* cursors, const BSONObj& sortKey )
+            : _cursors( cursors ), _sortKey( sortKey ) {}
+
+        bool operator()( int l, int r ) const {
+            int comp = _cursors[l].peek().woSortOrder( _cursors[r].peek(), _sortKey, true );
+            if( comp == 0 ) return l > r;
+            return comp > 0;
+        }
+
+    private:
+        FilteringClientCursor* _cursors;
+        BSONObj _sortKey;
+    };
+
+    void ParallelSortClusteredCursor::_buildHeap() {
+        if( _heapBuilt ) return;
+        _heapBuilt = true;
+
+        for( int i = 0; i < _numServers; i++ ){
+            if( _cursors[i].more() ){
+                _heap.push_back( i );
+            }
+            else if( _cursors[i].rawMData() ){
+                _cursors[i].rawMData()->pcState->done = true;
+            }
+        }
+
+        make_heap( _heap.begin(), _heap.end(), ShardCursorCmp( _cursors, _sortKey ) );
+
+        // only once the heap is whole, readAhead() can throw
+        for( unsigned i = 0; i < _heap.size(); i++ )
+            _cursors[_heap[i]].readAhead();
+    }
+
     bool ParallelSortClusteredCursor::more() {
 
         if ( _needToSkip > 0 ) {
@@ -1444,6 +1516,11 @@ namespace mongo {
             _needToSkip = n;
         }
 
+        if ( ! _sortKey.isEmpty() ) {
+            _buildHeap();
+            return ! _heap.empty();
+        }
+
         for ( int i=0; i<_numServers; i++ ) {
             if ( _cursors[i].more() )
                 return true;
@@ -1452,6 +1529,37 @@ namespace mongo {
     }
 
     BSONObj ParallelSortClusteredCursor::next() {
+
+        if ( ! _sortKey.isEmpty() ) {
+            // merge by taking the front of the heap, O(log shards) per document
+            _buildHeap();
+            uassert( 16109 , "no more elements" , ! _heap.empty() );
+
+            ShardCursorCmp cmp( _cursors, _sortKey );
+            pop_heap( _heap.begin(), _heap.end(), cmp );
+            int bestFrom = _heap.back();
+            // next() and more() may fetch a batch and throw, the rest has to stay a valid heap
+            _heap.pop_back();
+
+            BSONObj best = _cursors[bestFrom].next();
+
+            if( _cursors[bestFrom].rawMData() )
+                _cursors[bestFrom].rawMData()->pcState->count++;
+
+            if( _cursors[bestFrom].more() ){
+                // all cursors in the heap have their next document buffered, comparing doesn't fetch
+                _heap.push_back( bestFrom );
+                push_heap( _heap.begin(), _heap.end(), cmp );
+                _cursors[bestFrom].readAhead();
+            }
+            else {
+                if( _cursors[bestFrom].rawMData() )
+                    _cursors[bestFrom].rawMData()->pcState->done = true;
+            }
+
+            return best;
+        }
+
         BSONObj best = BSONObj();
         int bestFrom = -1;
 
@@ -1462,25 +1570,14 @@ namespace mongo {
                 continue;
             }
 
-            BSONObj me = _cursors[i].peek();
-
-            if ( best.isEmpty() ) {
-                best = me;
-                bestFrom = i;
-                if( _sortKey.isEmpty() ) break;
-                continue;
-            }
-
-            int comp = best.woSortOrder( me , _sortKey , true );
-            if ( comp < 0 )
-                continue;
-
-            best = me;
+            best = _cursors[i].peek();
             bestFrom = i;
+            break;
         }
 
         uassert( 10019 ,  "no more elements" , ! best.isEmpty() );
         _cursors[bestFrom].next();
+        _cursors[bestFrom].readAhead();
 
         if( _cursors[bestFrom].rawMData() )
             _cursors[bestFrom].rawMData()->pcState->count++;
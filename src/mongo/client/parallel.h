@@ -138,6 +138,9 @@ namespace mongo {
 
         BSONObj peek();
 
+        /** starts fetching the next batch early if the current one is running low */
+        void readAhead();
+
         DBClientCursor* raw() { return _cursor.get(); }
         ParallelConnectionMetadata* rawMData(){ return _pcmData; }
 
@@ -379,6 +382,9 @@ namespace mongo {
         void _markStaleNS( const NamespaceString& staleNS, const StaleConfigException& e, bool& forceReload, bool& fullReload );
         void _handleStaleNS( const NamespaceString& staleNS, bool forceReload, bool fullReload );
 
+        /** @return query with its filter (possibly wrapped in query / $query) replaced by filter */
+        static BSONObj _replaceFilter( const BSONObj& query, const BSONObj& filter );
+
         set<Shard> _qShards;
         QuerySpec _qSpec;
         CommandInfo _cInfo;
@@ -396,6 +402,14 @@ namespace mongo {
 
         FilteringClientCursor * _cursors;
         int _needToSkip;
+
+        /** puts every cursor with more results in _heap, once */
+        void _buildHeap();
+
+        // for sorted queries, the indexes of the _cursors with more results, as a heap
+        // with the one holding the next document in sort order at the front
+        vector<int> _heap;
+        bool _heapBuilt;
     };
 
     /**
@@ -28,6 +28,7 @@
 #include "stats/counters.h"
 #include "dur_commitjob.h"
 #include "btreebuilder.h"
+#include "pagefault.h"
 #include "../util/unittest.h"
 #include "../server.h"
 
@@ -1897,6 +1898,87 @@ namespace mongo {
         return kn.recordLoc;
     }
 
+    template< class V >
+    void BtreeBucket<V>::checkWriteFaults( const IndexDetails &idx, const DiskLoc &thisLoc, const Key &key, const Ordering &order ) {
+        DiskLoc loc = thisLoc;
+        while ( !loc.isNull() ) {
+            checkWriteFault( loc.rec() );
+            int pos;
+            if ( loc.btree<V>()->find( idx, key, minDiskLoc, order, pos, /*assertIfDup*/ false ) )
+                return;
+            loc = loc.btree<V>()->childForPos( pos );
+        }
+    }
+
+    template< class V >
+    int BtreeBucket<V>::boundPos( const Key &bound, bool after, const Ordering &order ) const {
+        int l = 0;
+        int h = this->n;
+        while ( l < h ) {
+            int m = ( l + h ) / 2;
+            int x = keyNode( m ).key.woCompare( bound, order );
+            if ( x < 0 || ( x == 0 && after ) )
+                l = m + 1;
+            else
+                h = m;
+        }
+        return l;
+    }
+
+    template< class V >
+    long long BtreeBucket<V>::countRange( const DiskLoc &thisLoc, const Key &low, bool lowInclusive,
+                                          const Key &high, bool highInclusive, const Ordering &order,
+                                          long long maxCount, int maxBuckets ) const {
+        long long count = _countRange( thisLoc, &low, lowInclusive, &high, highInclusive, order, maxCount, maxBuckets );
+        if ( maxCount > 0 && count > maxCount )
+            count = maxCount;
+        return count;
+    }
+
+    template< class V >
+    long long BtreeBucket<V>::_countRange( const DiskLoc &thisLoc, const Key *low, bool lowInclusive,
+                                           const Key *high, bool highInclusive, const Ordering &order,
+                                           long long maxCount, int &bucketsLeft ) {
+        if ( bucketsLeft-- <= 0 )
+            return -1;
+
+        const BtreeBucket<V> *b = thisLoc.btree<V>();
+        // keys [lo, hi) of this bucket are in range
+        int lo = low ? b->boundPos( *low, !lowInclusive, order ) : 0;
+        int hi = high ? b->boundPos( *high, highInclusive, order ) : b->n;
+        if ( hi < lo )
+            hi = lo;
+
+        long long count = 0;
+        for ( int i = lo; i < hi; ++i ) {
+            if ( b->isUsed( i ) )
+                ++count;
+        }
+
+        // the child left of key lo may hold keys below low, and above high too if no key is in range
+        for ( int i = lo; i <= hi; ++i ) {
+            if ( maxCount > 0 && count >= maxCount )
+                return count;
+            DiskLoc child = b->childForPos( i );
+            if ( child.isNull() )
+                continue;
+            long long n;
+            if ( i == lo )
+                n = _countRange( child, low, lowInclusive, lo == hi ? high : 0, highInclusive, order,
+                                 maxCount > 0 ? maxCount - count : 0, bucketsLeft );
+            else if ( i == hi )
+                n = _countRange( child, 0, false, high, highInclusive, order,
+                                 maxCount > 0 ? maxCount - count : 0, bucketsLeft );
+            else
+                n = _countRange( child, 0, false, 0, false, order,
+                                 maxCount > 0 ? maxCount - count : 0, bucketsLeft );
+            if ( n < 0 )
+                return -1;
+            count += n;
+        }
+        return count;
+    }
+
 } // namespace mongo
 
 #include "db.h"
@@ -724,6 +724,24 @@ namespace mongo {
          */
         DiskLoc findSingle( const IndexDetails &indexdetails , const DiskLoc& thisLoc, const BSONObj& key ) const;
 
+        /**
+         * Counts the used keys of the subtree at thisLoc between low and high, ignoring record
+         * locations.  Only buckets straddling a bound compare keys; the keys and subtrees in
+         * between are counted without looking at them.
+         * @param maxCount if > 0, the walk stops once this many keys are counted
+         * @param maxBuckets the walk gives up after visiting this many buckets
+         * @return the count, at most maxCount when set, or -1 if maxBuckets was not enough
+         */
+        long long countRange( const DiskLoc &thisLoc, const Key &low, bool lowInclusive,
+                              const Key &high, bool highInclusive, const Ordering &order,
+                              long long maxCount, int maxBuckets ) const;
+
+        /**
+         * Calls checkWriteFault() on each bucket from thisLoc down to where key would be inserted, so an
+         * insert can yield before it faults on them.
+         */
+        static void checkWriteFaults( const IndexDetails &idx, const DiskLoc &thisLoc, const Key &key, const Ordering &order );
+
         /**
          * Advance to next or previous key in the index.
          * @param direction to advance.
@@ -949,6 +967,12 @@ namespace mongo {
         bool find(const IndexDetails& idx, const Key& key, const DiskLoc &recordLoc, const Ordering &order, int& pos, bool assertIfDup) const;        
         static bool customFind( int l, int h, const BSONObj &keyBegin, int keyBeginLen, bool afterKey, const vector< const BSONElement * > &keyEnd, const vector< bool > &keyEndInclusive, const Ordering &order, int direction, DiskLoc &thisLoc, int &keyOfs, pair< DiskLoc, int > &bestParent ) ;
         static void findLargestKey(const DiskLoc& thisLoc, DiskLoc& largestLoc, int& largestKey);
+        /** @return index of the first key of this bucket above bound, or not below it if !after */
+        int boundPos( const Key &bound, bool after, const Ordering &order ) const;
+        /** countRange() with a null bound for a side the subtree is known to be within */
+        static long long _countRange( const DiskLoc &thisLoc, const Key *low, bool lowInclusive,
+                                      const Key *high, bool highInclusive, const Ordering &order,
+                                      long long maxCount, int &bucketsLeft );
         static int customBSONCmp( const BSONObj &l, const BSONObj &rBegin, int rBeginLen, bool rSup, const vector< const BSONElement * > &rEnd, const vector< bool > &rEndInclusive, const Ordering &o, int direction );
         
         /** If child is non null, set its parent to thisLoc */
@@ -42,6 +42,7 @@ namespace mongo {
     Client* Client::syncThread;
     mongo::mutex& Client::clientsMutex = *(new mutex("clientsMutex"));
     set<Client*>& Client::clients = *(new set<Client*>); // always be in clientsMutex when manipulating this
+    static LockStats& retiredLockStats = *(new LockStats()); // of clients gone from clients, in clientsMutex
 
     TSP_DEFINE(Client, currentClient)
 
@@ -141,8 +142,10 @@ namespace mongo {
         if ( ! inShutdown() ) {
             // we can't clean up safely once we're in shutdown
             scoped_lock bl(clientsMutex);
-            if ( ! _shutdown )
+            if ( ! _shutdown ) {
                 clients.erase(this);
+                retiredLockStats.add( _lockStats );
+            }
             delete _curOp;
         }
     }
@@ -161,6 +164,7 @@ namespace mongo {
         {
             scoped_lock bl(clientsMutex);
             clients.erase(this);
+            retiredLockStats.add( _lockStats );
             if ( isSyncThread() ) {
                 syncThread = 0;
             }
@@ -169,6 +173,17 @@ namespace mongo {
         return false;
     }
 
+    void Client::appendLockStats( BSONObjBuilder& b ) {
+        LockStats total;
+        {
+            scoped_lock bl(clientsMutex);
+            total.add( retiredLockStats );
+            for ( set<Client*>::iterator i = clients.begin(); i != clients.end(); ++i )
+                total.add( (*i)->_lockStats );
+        }
+        total.append( b );
+    }
+
     BSONObj CachedBSONObj::_tooBig = fromjson("{\"$msg\":\"query not recording (too large)\"}");
     Client::Context::Context( string ns , Database * db, bool doauth ) :
         _client( currentClient.get() ), 
@@ -371,11 +386,20 @@ namespace mongo {
         return c;
     }
 
-    void curopGotLock(Client *c) {
+    void curopGotLock(Client *c, const char *db) {
         assert(c);
         CurOp * co = c->curop();
         if ( co )
-            co->gotLock();
+            co->gotLock( db );
+    }
+
+    void curopLockReleased( const char* db , char type , unsigned long long heldMicros ) {
+        Client * c = currentClient.get();
+        if ( c == 0 )
+            return;
+        CurOp * co = c->curop();
+        if ( co )
+            co->lockReleased( db , type , heldMicros );
     }
 
     void KillCurrentOp::interruptJs( AtomicUInt *op ) {
@@ -608,6 +632,7 @@ namespace mongo {
         fastmodinsert = false;
         upsert = false;
         keyUpdates = 0;  // unsigned, so -1 not possible
+        lockStats.reset();
         
         exceptionInfo.reset();
         
@@ -654,6 +679,7 @@ namespace mongo {
         OPDEBUG_TOSTRING_HELP_BOOL( fastmodinsert );
         OPDEBUG_TOSTRING_HELP_BOOL( upsert );
         OPDEBUG_TOSTRING_HELP( keyUpdates );
+        s << lockStats.toString();
         
         if ( extra.len() )
             s << " " << extra.str();
@@ -702,6 +728,11 @@ namespace mongo {
         OPDEBUG_APPEND_BOOL( fastmodinsert );
         OPDEBUG_APPEND_BOOL( upsert );
         OPDEBUG_APPEND_NUMBER( keyUpdates );
+        if ( ! lockStats.empty() ) {
+            BSONObjBuilder ls( b.subobjStart( "lockStats" ) );
+            lockStats.append( ls );
+            ls.done();
+        }
 
         if ( ! exceptionInfo.empty() ) 
             exceptionInfo.append( b , "exception" , "exceptionCode" );
@@ -34,6 +34,7 @@
 #include "../util/net/message_port.h"
 #include "../util/concurrency/rwlock.h"
 #include "d_concurrency.h"
+#include "lockstat.h"
 
 namespace mongo {
 
@@ -124,6 +125,12 @@ namespace mongo {
         
         bool allowedToThrowPageFaultException() const;
 
+        /** lock stats of the operations this client has run, see appendLockStats() */
+        LockStats& lockStats() { return _lockStats; }
+
+        /** appends the lock stats of the operations of all clients, past and present */
+        static void appendLockStats( BSONObjBuilder& b );
+
     private:
         Client(const char *desc, AbstractMessagingPort *p = 0);
         friend class CurOp;
@@ -138,6 +145,7 @@ namespace mongo {
         OpTime _lastOp;
         BSONObj _handshake;
         BSONObj _remoteId;
+        LockStats _lockStats;
         AbstractMessagingPort * const _mp;
         unsigned _sometimes;
 
@@ -372,6 +372,7 @@ namespace mongo {
             StringBuilder sb;
             sb << cmdLine.binaryName << "." << cmdLine.port;
             Logstream::useSyslog( sb.str().c_str() );
+            Logstream::startAsyncWriter();
         }
 #endif
         if (params.count("logpath") && !params.count("shutdown")) {
@@ -384,6 +385,8 @@ namespace mongo {
                 logpath = params["logpath"].as<string>();
             uassert( 10033 ,  "logpath has to be non-zero" , logpath.size() );
             initLogging( logpath , params.count( "logappend" ) );
+            // request threads shouldn't wait on the log disk
+            Logstream::startAsyncWriter();
         }
 
         if ( params.count("pidfilepath")) {
@@ -110,6 +110,7 @@ namespace mongo {
         int pretouch;          // --pretouch for replication application (experimental)
         bool moveParanoia;     // for move chunk paranoia
         double syncdelay;      // seconds between fsyncs
+        bool continuousFlush;  // --continuousFlush write back journaled changes between syncs
 
         bool noUnixSocket;     // --nounixsocket
         bool doFork;           // --fork
@@ -157,7 +158,7 @@ namespace mongo {
         port(DefaultDBPort), rest(false), jsonp(false), quiet(false), noTableScan(false), prealloc(true), preallocj(true), smallfiles(sizeof(int*) == 4),
         configsvr(false),
         quota(false), quotaFiles(8), cpu(false), durOptions(0), objcheck(false), oplogSize(0), defaultProfile(0), slowMS(100), pretouch(0), moveParanoia( true ),
-        syncdelay(60), noUnixSocket(false), doFork(0), socket("/tmp") 
+        syncdelay(60), continuousFlush(false), noUnixSocket(false), doFork(0), socket("/tmp") 
     {
         started = time(0);
 
@@ -198,6 +198,11 @@ namespace mongo {
         virtual LockType locktype() const { return NONE; }
         virtual bool run(const string&, mongo::BSONObj&, int, std::string&, mongo::BSONObjBuilder& result, bool) {
             pool.appendInfo( result );
+            {
+                BSONObjBuilder b( result.subobjStart( "shardConnectionPool" ) );
+                shardConnectionPool.appendInfo( b );
+                b.done();
+            }
             result.append( "numDBClientConnection" , DBClientConnection::getNumConnections() );
             result.append( "numAScopedConnection" , AScopedConnection::getNumConnections() );
             return true;
@@ -46,6 +46,8 @@ namespace mongo {
         _dbprofile = 0;
         _end = 0;
         _waitingForLock = false;
+        _lockWaitStart = 0;
+        _lockWaitMicros = 0;
         _message = "";
         _progressMeter.finished();
         _killed = false;
@@ -112,8 +114,9 @@ namespace mongo {
     
     void CurOp::leave( Client::Context * context ) {
         unsigned long long now = curTimeMicros64();
-        Top::global.record( _ns , _op , _lockType , now - _checkpoint , _command );
+        Top::global.record( _ns , _op , _lockType , now - _checkpoint , _lockWaitMicros , _command );
         _checkpoint = now;
+        _lockWaitMicros = 0;
     }
 
     BSONObj CurOp::infoNoauth() {
@@ -171,6 +174,12 @@ namespace mongo {
         
         b.append( "numYields" , _numYields );
 
+        {
+            BSONObjBuilder ls( b.subobjStart( "lockStats" ) );
+            _debug.lockStats.append( ls );
+            ls.done();
+        }
+
         return b.obj();
     }
 
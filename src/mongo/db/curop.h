@@ -21,6 +21,7 @@
 
 #include "namespace-inl.h"
 #include "client.h"
+#include "lockstat.h"
 #include "../bson/util/atomic_int.h"
 #include "../util/concurrency/spin_lock.h"
 #include "../util/time_support.h"
@@ -67,6 +68,7 @@ namespace mongo {
         bool fastmodinsert;  // upsert of an $operation. builds a default object
         bool upsert;         // true if the update actually did an insert
         int keyUpdates;
+        LockStats lockStats; // time acquiring and holding the global lock and each database's lock
 
         // error handling
         ExceptionInfo exceptionInfo;
@@ -167,8 +169,18 @@ namespace mongo {
         void waitingForLock( char type ) {
             _waitingForLock = true;
             _lockType = type;
+            _lockWaitStart = curTimeMicros64();
+        }
+        /** @param db the database whose lock was waited for, 0 for the global lock */
+        void gotLock( const char* db ) {
+            _waitingForLock = false;
+            unsigned long long wait = curTimeMicros64() - _lockWaitStart;
+            _lockWaitMicros += wait;
+            _debug.lockStats.recordAcquireTimeMicros( db ? db : LockStats::Global , _lockType , wait );
+        }
+        void lockReleased( const char* db , char type , unsigned long long heldMicros ) {
+            _debug.lockStats.recordLockTimeMicros( db ? db : LockStats::Global , type , heldMicros );
         }
-        void gotLock()             { _waitingForLock = false; }
         OpDebug& debug()           { return _debug; }
         int profileLevel() const   { return _dbprofile; }
         const char * getNS() const { return _ns; }
@@ -242,6 +254,8 @@ namespace mongo {
         bool _command;
         char _lockType;                   // r w R W
         bool _waitingForLock;
+        unsigned long long _lockWaitStart;
+        unsigned long long _lockWaitMicros; // waiting for locks since _checkpoint
         int _dbprofile;                  // 0=off, 1=slow, 2=all
         AtomicUInt _opNum;               // todo: simple being "unsigned" may make more sense here
         char _ns[Namespace::MaxNsLen+2];
@@ -23,11 +23,14 @@
 namespace mongo { 
 
     Client* curopWaitingForLock( char type );
-    void curopGotLock(Client*);
+    void curopGotLock(Client*, const char* db);
+    void curopLockReleased(const char* db, char type, unsigned long long heldMicros);
     struct Acquiring { 
         Client* c;
-        ~Acquiring() { curopGotLock(c); }
-        Acquiring(char type) { 
+        const char* db;
+        ~Acquiring() { curopGotLock(c, db); }
+        /** @param db set when waiting for the lock of that database rather than the global lock */
+        Acquiring(char type, const char* db = 0) : db(db) { 
             c = curopWaitingForLock(type);
         }
     };
@@ -128,12 +131,31 @@ namespace mongo {
     inline unsigned& recursive() { // the nested locking counter for the big outer QLock
         return lockState().recursive;
     }
+    inline void lockedNow() { 
+        lockState().lockedAt = curTimeMicros64();
+    }
+    /** reports how long the global lock was held in mode type to the current op's lock stats */
+    inline void unlockingNow(char type) { 
+        curopLockReleased(0, type, curTimeMicros64() - lockState().lockedAt);
+    }
+    inline void dbLockedNow(SimpleRWLock* l) { 
+        LockState& ls = lockState();
+        ( l == &localDBLock ? ls.localLockedAt : ls.otherLockedAt ) = curTimeMicros64();
+    }
+    /** reports how long the lock of one database, local or otherLock, was held in mode type */
+    inline void dbUnlockingNow(SimpleRWLock* l, char type) { 
+        LockState& ls = lockState();
+        bool local = l == &localDBLock;
+        curopLockReleased(local ? "local" : ls.otherName.c_str(), type, curTimeMicros64() - ( local ? ls.localLockedAt : ls.otherLockedAt ));
+    }
 
     static bool lock_R_try(int ms) { 
         assert( threadState() == 0 );
         bool got = q.lock_R_try(ms);
-        if( got ) 
+        if( got ) {
             threadState() = 'R';
+            lockedNow();
+        }
         return got;
     }
     static bool lock_W_try(int ms) { 
@@ -141,6 +163,7 @@ namespace mongo {
         bool got = q.lock_W_try(ms);
         if( got ) {
             threadState() = 'W';
+            lockedNow();
             locked_W();
         }
         return got;
@@ -152,6 +175,7 @@ namespace mongo {
             Acquiring a('W');
             q.lock_W_stop_greed();
         }
+        lockedNow();
         locked_W();
     }
     static void lock_W() { 
@@ -169,11 +193,13 @@ namespace mongo {
             Acquiring a('W');
             q.lock_W();
         }
+        lockedNow();
         locked_W();
     }
     static void unlock_W(char oldState = 0) { 
         wassert( threadState() == 'W' );
         unlocking_W();
+        unlockingNow('W');
         dassert( oldState == 0 ||  oldState == 't' );
         threadState() = oldState;
         q.unlock_W();
@@ -182,11 +208,15 @@ namespace mongo {
         LockState& ls = lockState();
         massert(16103, str::stream() << "can't lock_R, threadState=" << (int) ls.threadState, ls.threadState == 0);
         ls.threadState = 'R';
-        Acquiring a('R');
-        q.lock_R();
+        {
+            Acquiring a('R');
+            q.lock_R();
+        }
+        lockedNow();
     }
     static void unlock_R() { 
         wassert( threadState() == 'R' );
+        unlockingNow('R');
         threadState() = 0;
         q.unlock_R();
     }    
@@ -195,12 +225,16 @@ namespace mongo {
         assert( ts == 0 || ts == 't' );
         getDur().commitIfNeeded();
         ts = 'w';
-        Acquiring a('w');
-        q.lock_w();
+        {
+            Acquiring a('w');
+            q.lock_w();
+        }
+        lockedNow();
     }
     static void unlock_w() { 
         unlocking_w();
         wassert( threadState() == 'w' );
+        unlockingNow('w');
         threadState() = 0;
         q.unlock_w();
     }
@@ -208,11 +242,15 @@ namespace mongo {
         char& ts = threadState();
         assert( ts == 0 || ts == 't' );
         ts = 'r';
-        Acquiring a('r');
-        q.lock_r();
+        {
+            Acquiring a('r');
+            q.lock_r();
+        }
+        lockedNow();
     }
     static void unlock_r() { 
         wassert( threadState() == 'r' );
+        unlockingNow('r');
         threadState() = 0;
         q.unlock_r();
     }
@@ -322,11 +360,13 @@ namespace mongo {
             if( local ) {
                 assert(local==1);
                 assert(ls.other==0);
+                dbUnlockingNow(&localDBLock, 'w');
                 localDBLock.unlock();
             }
             else {
                 assert(local==0);
                 assert(ls.other==1);
+                dbUnlockingNow(ls.otherLock, 'w');
                 ls.otherLock->unlock();
             }
             unlock_w();
@@ -335,11 +375,13 @@ namespace mongo {
             if( local ) {
                 assert(local==-1);
                 assert(ls.other==0);
+                dbUnlockingNow(&localDBLock, 'r');
                 localDBLock.unlock_shared();
             }
             else {
                 assert(local==0);
                 assert(ls.other==-1);
+                dbUnlockingNow(ls.otherLock, 'r');
                 ls.otherLock->unlock_shared();
             }
             unlock_r();
@@ -369,17 +411,25 @@ namespace mongo {
                 break;
             case 'w':
                 lock_w();
-                if( local ) 
+                if( local ) {
                     localDBLock.lock();
-                else
+                    dbLockedNow(&localDBLock);
+                }
+                else {
                     ls.otherLock->lock();
+                    dbLockedNow(ls.otherLock);
+                }
                 break;
             case 'r':
                 lock_r();
-                if( local ) 
+                if( local ) {
                     localDBLock.lock_shared();
-                else
+                    dbLockedNow(&localDBLock);
+                }
+                else {
                     ls.otherLock->lock_shared();
+                    dbLockedNow(ls.otherLock);
+                }
                 break;
             default:
                 wassert(false);
@@ -422,14 +472,18 @@ namespace mongo {
         assert( !recursive() );
         assert( threadState() == 'W' );
         q.W_to_R();
+        unlockingNow('W');
         threadState() = 'R';
+        lockedNow();
     }
     // you will deadlock if 2 threads doing this
     bool Lock::GlobalWrite::upgrade() { 
         assert( !recursive() );
         assert( threadState() == 'R' );
         if( q.R_to_W() ) {
+            unlockingNow('R');
             threadState() = 'W';
+            lockedNow();
             return true;
         }
         return false;
@@ -483,7 +537,11 @@ namespace mongo {
         else {
             ourCounter = &ls.local;
             ls.local++;
-            localDBLock.lock();
+            {
+                Acquiring a('w', "local");
+                localDBLock.lock();
+            }
+            dbLockedNow(&localDBLock);
             weLocked = &localDBLock;
         }
     }
@@ -518,7 +576,11 @@ namespace mongo {
                 lock = new SimpleRWLock();
             ls.otherLock = lock;
         }
-        ls.otherLock->lock();
+        {
+            Acquiring a('w', db.c_str());
+            ls.otherLock->lock();
+        }
+        dbLockedNow(ls.otherLock);
         weLocked = ls.otherLock;
     }
     Lock::DBWrite::DBWrite(const StringData& ns) {
@@ -538,6 +600,7 @@ namespace mongo {
         }
         if( weLocked ) {
             wassert( ourCounter && *ourCounter == 0 );
+            dbUnlockingNow( weLocked, 'w' );
             weLocked->unlock();
         }
         if( locked_w ) {
@@ -579,7 +642,11 @@ namespace mongo {
         else {
             ourCounter = &ls.local;
             ls.local--;
-            localDBLock.lock_shared();
+            {
+                Acquiring a('r', "local");
+                localDBLock.lock_shared();
+            }
+            dbLockedNow(&localDBLock);
             weLocked = &localDBLock;
         }
     }
@@ -614,7 +681,11 @@ namespace mongo {
                 lock = new SimpleRWLock();
             ls.otherLock = lock;
         }
-        ls.otherLock->lock_shared();
+        {
+            Acquiring a('r', db.c_str());
+            ls.otherLock->lock_shared();
+        }
+        dbLockedNow(ls.otherLock);
         weLocked = ls.otherLock;
     }
     Lock::DBRead::DBRead(const StringData& ns) {
@@ -634,6 +705,7 @@ namespace mongo {
         }
         if( weLocked ) {
             wassert( ourCounter && *ourCounter == 0 );
+            dbUnlockingNow( weLocked, 'r' );
             weLocked->unlock_shared();
         }
         if( locked_r ) {
@@ -122,19 +122,22 @@ namespace mongo {
 
     // implementation stuff
     struct LockState {
-        LockState() : threadState(0), recursive(0), local(0), other(0), otherLock(0) { }
+        LockState() : threadState(0), recursive(0), lockedAt(0), local(0), other(0), otherLock(0), localLockedAt(0), otherLockedAt(0) { }
         void dump();
         static void Dump();
 
         // global lock related
         char threadState;             // 0, 'r', 'w', 'R', 'W'
         unsigned recursive;           // nested locking is allowed
+        unsigned long long lockedAt;  // curTimeMicros64() when threadState was last acquired, for lock stats
 
         // db level locking related
         int local;                    // recursive lock count on local db and other db
         int other;                    //   >0 means write lock, <0 read lock
         string otherName;             // which database are we locking and working with (besides local)
         SimpleRWLock *otherLock;      // so we don't have to check the map too often (the map has a mutex)
+        unsigned long long localLockedAt; // curTimeMicros64() when the local db lock was last acquired, for lock stats
+        unsigned long long otherLockedAt; //   and when otherLock was
     };
 
 }
@@ -45,6 +45,8 @@
 #include "concurrency.h"
 #include "../s/d_writeback.h"
 #include "d_globals.h"
+#include "mongommf.h"
+#include "../util/timer.h"
 
 #if defined(_WIN32)
 # include "../util/ntservice.h"
@@ -392,6 +394,8 @@ namespace mongo {
                 log() << "--syncdelay 1" << endl;
             else if( cmdLine.syncdelay != 60 )
                 log(1) << "--syncdelay " << cmdLine.syncdelay << endl;
+            if( cmdLine.continuousFlush && !cmdLine.dur )
+                log() << "warning: --continuousFlush needs journaling, data files will be flushed every syncdelay only" << endl;
             int time_flushing = 0;
             while ( ! inShutdown() ) {
                 _diaglog.flush();
@@ -401,13 +405,20 @@ namespace mongo {
                     continue;
                 }
 
-                sleepmillis( (long long) std::max(0.0, (cmdLine.syncdelay * 1000) - time_flushing) );
+                long long wait = (long long) std::max(0.0, (cmdLine.syncdelay * 1000) - time_flushing);
+                if ( cmdLine.continuousFlush && cmdLine.dur )
+                    writeBackFor( wait );
+                else
+                    sleepmillis( wait );
 
                 if ( inShutdown() ) {
                     // occasional issue trying to flush during shutdown when sleep interrupted
                     break;
                 }
 
+                // what is still dirty is written by the full flush
+                MongoMMF::clearAllDirty();
+
                 Date_t start = jsTime();
                 int numFiles = MemoryMappedFile::flushAll( true );
                 time_flushing = (int) (jsTime() - start);
@@ -420,6 +431,39 @@ namespace mongo {
             }
         }
 
+    private:
+        /** 
+         * Writes back the regions of the data files journaling wrote to, a little every tick, so that
+         * the full flush at the end of the interval finds little left to do instead of all of it.
+         */
+        void writeBackFor( long long millis ) {
+            const long long TickMillis = 100;
+            Timer t;
+            while ( ! inShutdown() && cmdLine.continuousFlush ) {
+                long long left = millis - t.millis();
+                if ( left <= 0 )
+                    return;
+                sleepmillis( std::min( left , TickMillis ) );
+
+                unsigned dirty = MongoMMF::dirtyChunks();
+                globalFlushCounters.backlog( (long long) dirty * MongoMMF::DirtyChunkSize );
+                if ( dirty == 0 )
+                    continue;
+
+                // spread the backlog over the ticks left, so it drains just before the full flush
+                long long ticks = std::max( 1LL , ( millis - t.millis() ) / TickMillis );
+                unsigned n = (unsigned) ( dirty / ticks ) + 1;
+
+                Timer w;
+                unsigned written = MongoMMF::flushSomeDirty( n );
+                globalFlushCounters.wroteBack( (long long) written * MongoMMF::DirtyChunkSize , w.millis() );
+            }
+            // turned off at runtime
+            long long left = millis - t.millis();
+            if ( left > 0 && ! inShutdown() )
+                sleepmillis( left );
+        }
+
     } dataFileSync;
 
     const char * jsInterruptCallback() {
@@ -431,6 +475,17 @@ namespace mongo {
         return cc().curop()->opNum();
     }
 
+    /** sets up JS scopes ahead of demand, see ScriptEngine::warmScopePools() */
+    class ScopePoolWarmer : public task::Task {
+    public:
+        virtual string name() const { return "ScopePoolWarmer"; }
+        virtual void doWork() {
+            if ( ! haveClient() )
+                Client::initThread( "ScopePoolWarmer" );
+            ScriptEngine::warmScopePools();
+        }
+    };
+
     void _initAndListen(int listenPort ) {
 
         Client::initThread("initandlisten");
@@ -499,6 +554,7 @@ namespace mongo {
             ScriptEngine::setup();
             globalScriptEngine->setCheckInterruptCallback( jsInterruptCallback );
             globalScriptEngine->setGetInterruptSpecCallback( jsGetInterruptSpecCallback );
+            task::repeat( new ScopePoolWarmer() , 500 );
         }
 
         repairDatabasesAndCheckVersion();
@@ -630,6 +686,7 @@ int main(int argc, char* argv[]) {
     ("slowms",po::value<int>(&cmdLine.slowMS)->default_value(100), "value of slow for profile and console log" )
     ("smallfiles", "use a smaller default file size")
     ("syncdelay",po::value<double>(&cmdLine.syncdelay)->default_value(60), "seconds between disk syncs (0=never, but not recommended)")
+    ("continuousFlush", "with journaling, write changes back to the data files continuously between syncs")
     ("sysinfo", "print some diagnostic system information")
     ("upgrade", "upgrade db if needed")
     ;
@@ -818,6 +875,9 @@ int main(int argc, char* argv[]) {
         if (params.count("rest")) {
             cmdLine.rest = true;
         }
+        if (params.count("continuousFlush")) {
+            cmdLine.continuousFlush = true;
+        }
         if (params.count("jsonp")) {
             cmdLine.jsonp = true;
         }
@@ -392,8 +392,10 @@ namespace mongo {
         }
         virtual void help( stringstream& help ) const {
             help << "enable or disable performance profiling\n";
-            help << "{ profile : <n> }\n";
+            help << "{ profile : <n> [, slowms : <ms>] [, sampleRate : <0 to 1>] [, namespaces : [<collection>, ...]] }\n";
             help << "0=off 1=log slow ops 2=log all\n";
+            help << "sampleRate: fraction of those ops written to system.profile, for all databases\n";
+            help << "namespaces: only profile these collections of this database, [] for all\n";
             help << "-1 to get current values\n";
             help << "http://www.mongodb.org/display/DOCS/Database+Profiler";
         }
@@ -403,21 +405,56 @@ namespace mongo {
             BSONElement e = cmdObj.firstElement();
             result.append("was", cc().database()->profile);
             result.append("slowms", cmdLine.slowMS );
+            result.append( "sampleRate" , ProfileSampling::rate() );
+            {
+                set<string> namespaces = ProfileSampling::namespaces( dbname );
+                BSONArrayBuilder a( result.subarrayStart( "namespaces" ) );
+                for ( set<string>::const_iterator i = namespaces.begin(); i != namespaces.end(); ++i )
+                    a.append( i->substr( dbname.size() + 1 ) );
+                a.done();
+            }
 
-            int p = (int) e.number();
-            bool ok = false;
+            // check everything before changing anything
+            BSONElement rate = cmdObj["sampleRate"];
+            if ( rate.isNumber() && ( rate.number() < 0 || rate.number() > 1 ) ) {
+                errmsg = "sampleRate must be between 0 and 1";
+                return false;
+            }
 
-            if ( p == -1 )
-                ok = true;
-            else if ( p >= 0 && p <= 2 ) {
-                ok = cc().database()->setProfilingLevel( p , errmsg );
+            BSONElement ns = cmdObj["namespaces"];
+            set<string> namespaces;
+            if ( ns.type() == Array ) {
+                BSONObjIterator i( ns.embeddedObject() );
+                while ( i.more() ) {
+                    BSONElement e = i.next();
+                    if ( e.type() != String ) {
+                        errmsg = "namespaces must be collection names";
+                        return false;
+                    }
+                    namespaces.insert( dbname + "." + e.str() );
+                }
             }
 
+            int p = (int) e.number();
+            if ( p != -1 && ( p < 0 || p > 2 ) ) {
+                errmsg = "profiling level must be 0, 1 or 2";
+                return false;
+            }
+
+            if ( p != -1 && ! cc().database()->setProfilingLevel( p , errmsg ) )
+                return false;
+
             BSONElement slow = cmdObj["slowms"];
             if ( slow.isNumber() )
                 cmdLine.slowMS = slow.numberInt();
 
-            return ok;
+            if ( rate.isNumber() )
+                ProfileSampling::setRate( rate.number() );
+
+            if ( ns.type() == Array )
+                ProfileSampling::setNamespaces( dbname , namespaces );
+
+            return true;
         }
     } cmdProfile;
 
@@ -552,6 +589,24 @@ namespace mongo {
                 bb.done();
             }
 
+            {
+                BSONObjBuilder bb( result.subobjStart( "writeFaults" ) );
+                globalWriteFaultCounters.append( bb );
+                bb.done();
+            }
+
+            {
+                BSONObjBuilder bb( result.subobjStart( "logging" ) );
+                Logstream::appendAsyncStats( bb );
+                bb.done();
+            }
+
+            if ( globalScriptEngine ) {
+                BSONObjBuilder bb( result.subobjStart( "scopePool" ) );
+                ScriptEngine::appendPoolStats( bb );
+                bb.done();
+            }
+
             {
                 BSONObjBuilder bb( result.subobjStart( "backgroundFlushing" ) );
                 globalFlushCounters.append( bb );
@@ -588,6 +643,19 @@ namespace mongo {
 
             result.append( "opcounters" , globalOpCounters.getObj() );
 
+            {
+                BSONObjBuilder bb( result.subobjStart( "opLatencies" ) );
+                bb.append( "note" , "all times in microseconds" );
+                Top::global.appendGlobalLatency( bb );
+                bb.done();
+            }
+
+            {
+                BSONObjBuilder bb( result.subobjStart( "locks" ) );
+                Client::appendLockStats( bb );
+                bb.done();
+            }
+
             {
                 BSONObjBuilder asserts( result.subobjStart( "asserts" ) );
                 asserts.append( "regular" , assertionCount.regular );
@@ -42,6 +42,7 @@
 #include "../util/ramlog.h"
 #include "repl/multicmd.h"
 #include "server.h"
+#include "../client/connpool.h"
 
 namespace mongo {
 
@@ -138,6 +139,9 @@ namespace mongo {
             help << "  notablescan\n";
             help << "  logLevel\n";
             help << "  syncdelay\n";
+            help << "  continuousFlush\n";
+            help << "  connPoolMaxInUsePerHost, connPoolMinPerHost\n";
+            help << "  connPoolWaitTimeoutMillis, connPoolIdleTimeoutSecs\n";
             help << "{ getParameter:'*' } to get everything\n";
         }
         bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
@@ -157,9 +161,24 @@ namespace mongo {
             if( all || cmdObj.hasElement("syncdelay") ) {
                 result.append("syncdelay", cmdLine.syncdelay);
             }
+            if( all || cmdObj.hasElement("continuousFlush") ) {
+                result.append("continuousFlush", cmdLine.continuousFlush);
+            }
             if( all || cmdObj.hasElement("replApplyBatchSize") ) {
                 result.append("replApplyBatchSize", replApplyBatchSize);
             }
+            if( all || cmdObj.hasElement("connPoolMaxInUsePerHost") ) {
+                result.append("connPoolMaxInUsePerHost", (int)PoolForHost::getMaxInUsePerHost());
+            }
+            if( all || cmdObj.hasElement("connPoolMinPerHost") ) {
+                result.append("connPoolMinPerHost", (int)PoolForHost::getMinPerHost());
+            }
+            if( all || cmdObj.hasElement("connPoolWaitTimeoutMillis") ) {
+                result.append("connPoolWaitTimeoutMillis", (int)PoolForHost::getWaitTimeoutMillis());
+            }
+            if( all || cmdObj.hasElement("connPoolIdleTimeoutSecs") ) {
+                result.append("connPoolIdleTimeoutSecs", (int)PoolForHost::getIdleTimeoutSecs());
+            }
 
             if ( before == result.len() ) {
                 errmsg = "no option found to get";
@@ -187,6 +206,11 @@ namespace mongo {
             help << "  notablescan\n";
             help << "  quiet\n";
             help << "  syncdelay\n";
+            help << "  continuousFlush\n";
+            help << "  connPoolMaxInUsePerHost (0 for no limit)\n";
+            help << "  connPoolMinPerHost\n";
+            help << "  connPoolWaitTimeoutMillis\n";
+            help << "  connPoolIdleTimeoutSecs\n";
         }
         bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
             int s = 0;
@@ -222,6 +246,13 @@ namespace mongo {
                 cmdLine.syncdelay = cmdObj["syncdelay"].Number();
                 s++;
             }
+            if( cmdObj.hasElement("continuousFlush") ) {
+                assert( !cmdLine.isMongos() );
+                if( s == 0 )
+                    result.append("was", cmdLine.continuousFlush );
+                cmdLine.continuousFlush = cmdObj["continuousFlush"].trueValue();
+                s++;
+            }
             if( cmdObj.hasElement( "logLevel" ) ) {
                 if( s == 0 )
                     result.append("was", logLevel );
@@ -244,6 +275,46 @@ namespace mongo {
                 DBException::traceExceptions = cmdObj["traceExceptions"].Bool();
                 s++;
             }
+            if( cmdObj.hasElement( "connPoolMaxInUsePerHost" ) ) {
+                if( s == 0 ) result.append( "was", (int)PoolForHost::getMaxInUsePerHost() );
+                int x = cmdObj["connPoolMaxInUsePerHost"].numberInt();
+                if ( x < 0 ) {
+                    errmsg = "connPoolMaxInUsePerHost can't be negative";
+                    return false;
+                }
+                PoolForHost::setMaxInUsePerHost( x );
+                s++;
+            }
+            if( cmdObj.hasElement( "connPoolMinPerHost" ) ) {
+                if( s == 0 ) result.append( "was", (int)PoolForHost::getMinPerHost() );
+                int x = cmdObj["connPoolMinPerHost"].numberInt();
+                if ( x < 0 ) {
+                    errmsg = "connPoolMinPerHost can't be negative";
+                    return false;
+                }
+                PoolForHost::setMinPerHost( x );
+                s++;
+            }
+            if( cmdObj.hasElement( "connPoolWaitTimeoutMillis" ) ) {
+                if( s == 0 ) result.append( "was", (int)PoolForHost::getWaitTimeoutMillis() );
+                int x = cmdObj["connPoolWaitTimeoutMillis"].numberInt();
+                if ( x < 0 ) {
+                    errmsg = "connPoolWaitTimeoutMillis can't be negative";
+                    return false;
+                }
+                PoolForHost::setWaitTimeoutMillis( x );
+                s++;
+            }
+            if( cmdObj.hasElement( "connPoolIdleTimeoutSecs" ) ) {
+                if( s == 0 ) result.append( "was", (int)PoolForHost::getIdleTimeoutSecs() );
+                int x = cmdObj["connPoolIdleTimeoutSecs"].numberInt();
+                if ( x <= 0 ) {
+                    errmsg = "connPoolIdleTimeoutSecs must be positive";
+                    return false;
+                }
+                PoolForHost::setIdleTimeoutSecs( x );
+                s++;
+            }
 
             if( s == 0 && !found ) {
                 errmsg = "no option found to set, use help:true to see options ";
@@ -250,6 +250,8 @@ namespace mongo {
                 void* dest = (char*)mmf->view_write() + entry.e->ofs;
                 memcpy(dest, entry.e->srcData(), entry.e->len);
                 stats.curr->_writeToDataFilesBytes += entry.e->len;
+                if( !_recovering && cmdLine.continuousFlush )
+                    mmf->noteDirty(entry.e->ofs, entry.e->len);
             }
             else {
                 massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
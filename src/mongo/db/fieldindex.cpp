@@ -0,0 +1,134 @@
+// @file fieldindex.cpp
+
+/*    Copyright 2012 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "pch.h"
+#include "fieldindex.h"
+
+namespace mongo {
+
+    TSP_DEFINE(FieldIndexes, fieldIndexes)
+
+    bool FieldIndex::reset( const BSONObj& obj ) {
+        _objdata = 0;
+        _entries.clear();
+
+        // most documents are narrow, find that out before hashing any names
+        int n = 0;
+        for ( BSONObjIterator j( obj ); n < MinFields && j.more(); j.next() )
+            n++;
+        if ( n < MinFields )
+            return false;
+
+        const char* data = obj.objdata();
+        BSONObjIterator i( obj );
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            Entry en;
+            en.nameLen = strlen( e.fieldName() );
+            en.hash = hashName( e.fieldName() , en.nameLen );
+            en.offset = e.rawdata() - data;
+            _entries.push_back( en );
+        }
+
+        unsigned size = 64;
+        while ( size < _entries.size() * 2 )
+            size *= 2;
+        _table.assign( size , 0 );
+        _mask = size - 1;
+
+        for ( unsigned k = 0; k < _entries.size(); k++ ) {
+            const Entry& en = _entries[k];
+            unsigned pos = en.hash & _mask;
+            bool dup = false;
+            while ( _table[pos] ) {
+                const Entry& other = _entries[_table[pos] - 1];
+                if ( other.hash == en.hash && other.nameLen == en.nameLen &&
+                        memcmp( data + other.offset + 1 , data + en.offset + 1 , en.nameLen ) == 0 ) {
+                    // BSONObj::getField() returns the first of duplicate names
+                    dup = true;
+                    break;
+                }
+                pos = ( pos + 1 ) & _mask;
+            }
+            if ( !dup )
+                _table[pos] = k + 1;
+        }
+
+        _objdata = data;
+        return true;
+    }
+
+    BSONElement FieldIndex::getField( const char* name , size_t len ) const {
+        dassert( _objdata );
+        unsigned h = hashName( name , len );
+        unsigned pos = h & _mask;
+        while ( _table[pos] ) {
+            const Entry& en = _entries[_table[pos] - 1];
+            // the field name follows the type byte
+            if ( en.hash == h && en.nameLen == len && memcmp( _objdata + en.offset + 1 , name , len ) == 0 )
+                return BSONElement( _objdata + en.offset );
+            pos = ( pos + 1 ) & _mask;
+        }
+        return BSONElement();
+    }
+
+    BSONElement FieldIndex::getFieldDottedOrArray( const char*& name ) const {
+        const char* p = strchr( name , '.' );
+
+        BSONElement sub;
+
+        if ( p ) {
+            sub = getField( name , p - name );
+            name = p + 1;
+        }
+        else {
+            size_t len = strlen( name );
+            sub = getField( name , len );
+            name = name + len;
+        }
+
+        if ( sub.eoo() )
+            return BSONElement();
+        else if ( sub.type() == Array || name[0] == '\0' )
+            return sub;
+        else if ( sub.type() == Object )
+            return sub.embeddedObject().getFieldDottedOrArray( name );
+        else
+            return BSONElement();
+    }
+
+    FieldIndex::Scope::Scope( const BSONObj& obj , int uses ) : _idx( 0 ) {
+        if ( uses < 2 || obj.isEmpty() )
+            return;
+        FieldIndexes* t = fieldIndexes.getMake();
+        FieldIndex* free = 0;
+        for ( int i = 0; i < FieldIndexes::N; i++ ) {
+            if ( t->slot[i].covers( obj ) )
+                return; // an enclosing scope has it
+            if ( free == 0 && t->slot[i]._objdata == 0 )
+                free = &t->slot[i];
+        }
+        if ( free && free->reset( obj ) )
+            _idx = free;
+    }
+
+    FieldIndex::Scope::~Scope() {
+        if ( _idx )
+            _idx->clear();
+    }
+
+} // namespace mongo
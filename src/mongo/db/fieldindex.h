@@ -0,0 +1,109 @@
+// @file fieldindex.h - Top level field name lookup table for wide documents.
+
+/*    Copyright 2012 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include "jsobj.h"
+#include "../util/concurrency/threadlocal.h"
+
+namespace mongo {
+
+    /**
+     * Hash of the top level field names of one document, so code resolving many fields of the same wide
+     * document (key generation for every index of a collection on insert, update and delete) finds each field
+     * in O(1) rather than scanning the document again for every lookup.
+     *
+     * A thread has a couple of these, handed out by FieldIndex::Scope. Their storage is kept from one document
+     * to the next, so building an index is one pass over the document and allocates nothing in steady state.
+     */
+    class FieldIndex : boost::noncopyable {
+    public:
+        /** Documents with fewer fields than this are cheaper to scan than to index. */
+        static const int MinFields = 32;
+
+        FieldIndex() : _objdata( 0 ) , _mask( 0 ) {}
+
+        /** @return the current thread's index of obj, or 0 if obj is not indexed. */
+        static const FieldIndex* forObj( const BSONObj& obj );
+
+        /**
+         * Indexes a document for the current thread while in scope, when it is wide enough and is going to be
+         * looked at more than once. Scopes nest: a document already indexed by an enclosing scope is left
+         * alone, and when every slot is taken the document is simply not indexed.
+         */
+        class Scope : boost::noncopyable {
+        public:
+            /** @param uses how many times the caller will resolve fields of obj, eg the number of indexes */
+            Scope( const BSONObj& obj , int uses );
+            ~Scope();
+        private:
+            FieldIndex* _idx;
+        };
+
+        /** Same result as BSONObj::getField() on the indexed document. */
+        BSONElement getField( const char* name ) const { return getField( name , strlen( name ) ); }
+        BSONElement getField( const StringData& name ) const { return getField( name.data() , name.size() ); }
+        BSONElement getField( const char* name , size_t len ) const;
+
+        /** Same result as BSONObj::getFieldDottedOrArray() on the indexed document. */
+        BSONElement getFieldDottedOrArray( const char*& name ) const;
+
+        /** @return false, leaving nothing indexed, if obj has fewer than MinFields fields. */
+        bool reset( const BSONObj& obj );
+        void clear() { _objdata = 0; }
+        bool covers( const BSONObj& obj ) const { return _objdata == obj.objdata(); }
+
+    private:
+        struct Entry {
+            unsigned hash;
+            unsigned nameLen;
+            unsigned offset; // of the element, from _objdata
+        };
+
+        static unsigned hashName( const char* name , size_t len ) {
+            // FNV-1a
+            unsigned h = 2166136261U;
+            for ( size_t i = 0; i < len; i++ )
+                h = ( h ^ (unsigned char) name[i] ) * 16777619U;
+            return h;
+        }
+
+        const char* _objdata;
+        vector<Entry> _entries;
+        vector<unsigned> _table; // 1 + index into _entries, 0 if empty
+        unsigned _mask;
+    };
+
+    /** The FieldIndex slots of one thread. */
+    struct FieldIndexes {
+        enum { N = 2 }; // an update generates keys for the old and the new version of a document together
+        FieldIndex slot[N];
+    };
+
+    TSP_DECLARE(FieldIndexes, fieldIndexes)
+
+    inline const FieldIndex* FieldIndex::forObj( const BSONObj& obj ) {
+        FieldIndexes* t = fieldIndexes.get();
+        if ( t == 0 )
+            return 0;
+        for ( int i = 0; i < FieldIndexes::N; i++ )
+            if ( t->slot[i].covers( obj ) )
+                return &t->slot[i];
+        return 0;
+    }
+
+} // namespace mongo
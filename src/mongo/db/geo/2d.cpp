@@ -524,6 +524,13 @@ namespace mongo {
             return ( _max._x - _min._x ) * ( _max._y - _min._y );
         }
 
+        /** planar distance from p to the nearest point of the box, 0 if p is inside */
+        double minDistance( const Point& p ) const {
+            double dx = p._x < _min._x ? _min._x - p._x : ( p._x > _max._x ? p._x - _max._x : 0 );
+            double dy = p._y < _min._y ? _min._y - p._y : ( p._y > _max._y ? p._y - _max._y : 0 );
+            return sqrt( dx * dx + dy * dy );
+        }
+
         double maxDim() const {
             return max( _max._x - _min._x, _max._y - _min._y );
         }
@@ -1294,12 +1301,13 @@ namespace mongo {
 
         GeoBrowse( const Geo2dType * g , string type , BSONObj filter = BSONObj(), bool uniqueDocs = true, bool needDistance = false )
             : GeoCursorBase( g ), GeoAccumulator( g , filter, uniqueDocs, needDistance ) ,
-              _type( type ) , _filter( filter ) , _firstCall(true), _noted( false ), _nscanned(), _nDirtied(0), _nChangedOnYield(0), _nRemovedOnYield(0), _centerPrefix(0, 0, 0) {
+              _type( type ) , _filter( filter ) , _firstCall(true), _noted( false ), _nscanned(), _nDirtied(0), _nChangedOnYield(0), _nRemovedOnYield(0), _nBoxesSkipped(0), _centerPrefix(0, 0, 0) {
 
             // Set up the initial expand state
             _state = START;
             _neighbor = -1;
             _foundInExp = 0;
+            for( int n = 0; n < 9; n++ ) _neighborOrder[n] = n;
 
         }
 
@@ -1659,10 +1667,11 @@ namespace mongo {
                         _centerPrefix = _prefix;
                         _centerBox = Box( _g, _centerPrefix );
                         isNeighbor = true;
+                        orderNeighbors();
                     }
 
-                    int i = (_neighbor / 3) - 1;
-                    int j = (_neighbor % 3) - 1;
+                    int i = (_neighborOrder[_neighbor] / 3) - 1;
+                    int j = (_neighborOrder[_neighbor] % 3) - 1;
 
                     if ( ( i == 0 && j == 0 ) ||
                          ( i < 0 && _centerPrefix.atMinX() ) ||
@@ -1765,6 +1774,32 @@ namespace mongo {
         // The amount the current box overlaps our search area
         virtual double intersectsBox( Box& cur ) = 0;
 
+        // Neighbor boxes are visited in increasing order of this, so searches that narrow as they find
+        // points can look at the most promising boxes first
+        virtual double neighborPriority( const Box& cur ) { return 0; }
+
+        // Sorts _neighborOrder by neighborPriority(), boxes off the edge of the space last
+        void orderNeighbors() {
+            vector< pair<double,int> > order;
+            for( int n = 0; n < 9; n++ ) {
+                int i = (n / 3) - 1;
+                int j = (n % 3) - 1;
+                double priority = numeric_limits<double>::max();
+                if ( ! ( ( i == 0 && j == 0 ) ||
+                         ( i < 0 && _centerPrefix.atMinX() ) ||
+                         ( i > 0 && _centerPrefix.atMaxX() ) ||
+                         ( j < 0 && _centerPrefix.atMinY() ) ||
+                         ( j > 0 && _centerPrefix.atMaxY() ) ) ) {
+                    GeoHash neighborPrefix = _centerPrefix;
+                    neighborPrefix.move( i, j );
+                    priority = neighborPriority( Box( _g, neighborPrefix ) );
+                }
+                order.push_back( make_pair( priority, n ) );
+            }
+            stable_sort( order.begin(), order.end() );
+            for( int n = 0; n < 9; n++ ) _neighborOrder[n] = order[n].second;
+        }
+
         bool remembered( BSONObj o ){
             BSONObj seenId = o["_id"].wrap("").getOwned();
             if( _seenIds.find( seenId ) != _seenIds.end() ){
@@ -1856,6 +1891,7 @@ namespace mongo {
             b << "pointsSavedForYield" << _nDirtied;
             b << "pointsChangedOnYield" << _nChangedOnYield;
             b << "pointsRemovedOnYield" << _nRemovedOnYield;
+            b << "boxesSkipped" << _nBoxesSkipped;
         }
 
         virtual BSONObj prettyIndexBounds() const {
@@ -1892,9 +1928,11 @@ namespace mongo {
         long long _nDirtied;
         long long _nChangedOnYield;
         long long _nRemovedOnYield;
+        long long _nBoxesSkipped;
 
-        // The current box we're expanding (-1 is first/center box)
+        // The current box we're expanding (-1 is first/center box), an index into _neighborOrder
         int _neighbor;
+        int _neighborOrder[9];
 
         // The points we've found so far
         // TODO:  Long long?
@@ -2409,9 +2447,27 @@ namespace mongo {
 
         // Whether the current box overlaps our search area
         virtual double intersectsBox( Box& cur ){
+            // Once we have enough points no box farther than the farthest of them can improve on them, and
+            // planar distances let us skip the corners of _want outside the search circle
+            if( _type == GEO_PLAIN && cur.minDistance( _near ) > searchRadius() ){
+                _nBoxesSkipped++;
+                return 0;
+            }
             return cur.intersects( _want );
         }
 
+        // Nearest boxes first, so we fill up on the closest points and skip more of the farther boxes
+        virtual double neighborPriority( const Box& cur ){
+            return cur.minDistance( _near );
+        }
+
+        // The distance within which a key can still be added, as approxKeyCheck() decides
+        double searchRadius() const {
+            if( _points.size() >= _max ) return farthest() + 2 * _distError;
+            if( _maxDistance < 0 ) return numeric_limits<double>::max();
+            return _maxDistance + 2 * _distError;
+        }
+
         GeoHash _start;
         int _numWanted;
         double _scanDistance;
@@ -2972,6 +3028,8 @@ namespace mongo {
             stats.appendNumber( "btreelocs" , gs._nscanned );
             stats.appendNumber( "nscanned" , gs._lookedAt );
             stats.appendNumber( "objectsLoaded" , gs._objectsLoaded );
+            stats.appendNumber( "pointsLoaded" , gs._pointsLoaded );
+            stats.appendNumber( "boxesSkipped" , gs._nBoxesSkipped );
             stats.append( "avgDistance" , totalDistance / x );
             stats.append( "maxDistance" , gs.farthest() );
             stats.done();
@@ -24,6 +24,7 @@
 #include "../commands.h"
 #include "../pdfile.h"
 #include "../btree.h"
+#include "../queryutil.h"
 #include "../curop-inl.h"
 #include "../matcher.h"
 #include "core.h"
@@ -37,6 +38,10 @@
  * this is useful when you want to look for something within a region where the ratio is low
  * works well for search for restaurants withing 25 miles with a certain name
  * should not be used for finding the closest restaurants that are open
+ *
+ * keys are { bucket , other field }.  indexes built before bucketKeyVersion existed have string buckets "x_y",
+ * newer ones have a NumberLong x * 2^32 + y so keys are cheap to build and compare, and a search is one btree
+ * scan over all the buckets in range instead of a cursor per bucket
  */
 namespace mongo {
 
@@ -56,6 +61,9 @@ namespace mongo {
             _locs.push_back( loc );
         }
 
+        /** @return true once limit documents are found, there's no need to scan further */
+        bool full() const { return _locs.size() >= _limit; }
+
         int append( BSONArrayBuilder& b ) {
             for ( unsigned i=0; i<_locs.size() && i<_limit; i++ )
                 b.append( _locs[i].obj() );
@@ -101,6 +109,10 @@ namespace mongo {
             uassert( 13317 , "no other fields specified" , _other.size() );
             uassert( 13326 , "quadrant search can only have 1 other field for now" , _other.size() == 1 );
             _order = orderBuilder.obj();
+
+            // indexes without a version predate binary buckets
+            _bucketKeyVersion = spec->info["bucketKeyVersion"].numberInt();
+            uassert( 16124 , "bucketKeyVersion must be 0 or 1" , _bucketKeyVersion == 0 || _bucketKeyVersion == 1 );
         }
 
         int hash( const BSONElement& e ) const {
@@ -120,9 +132,21 @@ namespace mongo {
             return ss.str();
         }
 
-        void _add( const BSONObj& obj, const string& root , const BSONElement& e , BSONObjSet& keys ) const {
+        static long long makeBucket( int hashedX , int hashedY ) {
+            return (long long)hashedX * ( 1LL << 32 ) + (unsigned)hashedY;
+        }
+
+        /** appends the bucket of hashed point x, y in this index's format */
+        void appendBucket( BSONObjBuilder& b , const char* name , int hashedX , int hashedY ) const {
+            if ( _bucketKeyVersion == 0 )
+                b.append( name , makeString( hashedX , hashedY ) );
+            else
+                b.append( name , makeBucket( hashedX , hashedY ) );
+        }
+
+        void _add( const BSONObj& obj, const BSONObj& root , const BSONElement& e , BSONObjSet& keys ) const {
             BSONObjBuilder buf;
-            buf.append( "" , root );
+            buf.appendElements( root );
             if ( e.eoo() )
                 buf.appendNull( "" );
             else
@@ -140,12 +164,14 @@ namespace mongo {
                 return;
 
             uassert( 13323 , "latlng not an array" , loc.isABSONObj() );
-            string root;
+            BSONObj root;
             {
                 BSONObjIterator i( loc.Obj() );
                 BSONElement x = i.next();
                 BSONElement y = i.next();
-                root = makeString( hash(x) , hash(y) );
+                BSONObjBuilder b;
+                appendBucket( b , "" , hash(x) , hash(y) );
+                root = b.obj();
             }
 
 
@@ -190,11 +216,33 @@ namespace mongo {
 
             long long btreeMatches = 0;
 
-            for ( int a=-scale; a<=scale; a++ ) {
-                for ( int b=-scale; b<=scale; b++ ) {
+            if ( _bucketKeyVersion == 0 )
+                btreeMatches = searchStringBuckets( nsd , idxNo , x , y , scale , search , hopper );
+            else
+                btreeMatches = searchBuckets( nsd , idxNo , x , y , scale , search , hopper );
+
+            BSONArrayBuilder arr( result.subarrayStart( "results" ) );
+            int num = hopper.append( arr );
+            arr.done();
+
+            {
+                BSONObjBuilder b( result.subobjStart( "stats" ) );
+                b.append( "time" , t.millis() );
+                b.appendNumber( "btreeMatches" , btreeMatches );
+                b.append( "n" , num );
+                b.done();
+            }
+        }
+
+        /** a point lookup per bucket, for indexes with string buckets */
+        long long searchStringBuckets( NamespaceDetails* nsd , int idxNo , int x , int y , int scale ,
+                                       const BSONObj& search , GeoHaystackSearchHopper& hopper ) const {
+            long long btreeMatches = 0;
+            for ( int a=-scale; a<=scale && ! hopper.full(); a++ ) {
+                for ( int b=-scale; b<=scale && ! hopper.full(); b++ ) {
 
                     BSONObjBuilder bb;
-                    bb.append( "" , makeString( x + a , y + b ) );
+                    appendBucket( bb , "" , x + a , y + b );
                     for ( unsigned i=0; i<_other.size(); i++ ) {
                         BSONElement e = search.getFieldDotted( _other[i] );
                         if ( e.eoo() )
@@ -209,7 +257,7 @@ namespace mongo {
 
                     set<DiskLoc> thisPass;
                     scoped_ptr<BtreeCursor> cursor( BtreeCursor::make( nsd , idxNo , *getDetails() , key , key , true , 1 ) );
-                    while ( cursor->ok() ) {
+                    while ( cursor->ok() && ! hopper.full() ) {
                         pair<set<DiskLoc>::iterator, bool> p = thisPass.insert( cursor->currLoc() );
                         if ( p.second ) {
                             hopper.got( cursor->currLoc() );
@@ -219,20 +267,50 @@ namespace mongo {
                         cursor->advance();
                     }
                 }
-
             }
+            return btreeMatches;
+        }
 
-            BSONArrayBuilder arr( result.subarrayStart( "results" ) );
-            int num = hopper.append( arr );
-            arr.done();
+        /**
+         * one cursor over { bucket : { $in : [ all buckets in range ] } , other : value }, which skips from each
+         * bucket's keys to the next's
+         */
+        long long searchBuckets( NamespaceDetails* nsd , int idxNo , int x , int y , int scale ,
+                                 const BSONObj& search , GeoHaystackSearchHopper& hopper ) const {
+            BSONElement value = search.getFieldDotted( _other[0] );
+            BSONObj valueObj = value.eoo() ? BSON( "" << BSONNULL ) : value.wrap( "" );
 
+            BSONObjBuilder q;
             {
-                BSONObjBuilder b( result.subobjStart( "stats" ) );
-                b.append( "time" , t.millis() );
-                b.appendNumber( "btreeMatches" , btreeMatches );
-                b.append( "n" , num );
-                b.done();
+                BSONObjBuilder in( q.subobjStart( _geo ) );
+                BSONArrayBuilder buckets( in.subarrayStart( "$in" ) );
+                for ( int a=-scale; a<=scale; a++ )
+                    for ( int b=-scale; b<=scale; b++ )
+                        buckets.append( makeBucket( x + a , y + b ) );
+                buckets.done();
+                in.done();
+            }
+            q.appendAs( valueObj.firstElement() , _other[0] );
+
+            FieldRangeSet frs( nsd->idx( idxNo ).parentNS().c_str() , q.obj() , true );
+            shared_ptr<FieldRangeVector> bounds( new FieldRangeVector( frs , *_spec , 1 ) );
+
+            long long btreeMatches = 0;
+            set<DiskLoc> seen;
+            scoped_ptr<BtreeCursor> cursor( BtreeCursor::make( nsd , idxNo , *getDetails() , bounds , 1 ) );
+            for ( ; cursor->ok() && ! hopper.full(); cursor->advance() ) {
+                // the ranges are a superset for some values, eg arrays, keys must equal the value exactly
+                BSONObjIterator k( cursor->currKey() );
+                k.next();
+                if ( k.next().woCompare( valueObj.firstElement() , false ) != 0 )
+                    continue;
+                if ( ! seen.insert( cursor->currLoc() ).second )
+                    continue;
+                hopper.got( cursor->currLoc() );
+                GEOQUADDEBUG( "\t" << cursor->current() );
+                btreeMatches++;
             }
+            return btreeMatches;
         }
 
         const IndexDetails* getDetails() const {
@@ -245,6 +323,7 @@ namespace mongo {
         BSONObj _order;
 
         double _bucketSize;
+        int _bucketKeyVersion;
     };
 
     class GeoHaystackSearchIndexPlugin : public IndexPlugin {
@@ -256,6 +335,16 @@ namespace mongo {
             return new GeoHaystackSearchIndex( this , spec );
         }
 
+        /** new indexes get binary buckets unless they ask for a version */
+        virtual BSONObj adjustIndexSpec( const BSONObj& spec ) const {
+            if ( spec.hasField( "bucketKeyVersion" ) )
+                return spec;
+            BSONObjBuilder b;
+            b.appendElements( spec );
+            b.append( "bucketKeyVersion" , 1 );
+            return b.obj();
+        }
+
     } nameIndexPlugin;
 
 
@@ -0,0 +1,622 @@
+// @file sphere.cpp - index of points on the sphere, with cell coverings for $within queries
+
+/**
+ *    Copyright (C) 2012 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pch.h"
+#include "../namespace-inl.h"
+#include "../jsobj.h"
+#include "../index.h"
+#include "../../util/unittest.h"
+#include "../pdfile.h"
+#include "../btree.h"
+#include "../matcher.h"
+#include "core.h"
+
+/**
+ * A "2dsphere" index keys each [ long, lat ] point by the small cell of the sphere containing it, from a
+ * hierarchical decomposition of the sphere into cells.  A $within query computes a covering of its region
+ * by a bounded number of cells, at whatever levels fit the region best, and scans only the key ranges of
+ * those cells.  Points of cells entirely inside the region need no further check, only the points of the
+ * cells on its border are tested exactly.  Unlike the flat 2d index there is no bounding box: a long thin
+ * polygon or a circle near a pole is covered by cells that follow its shape.
+ *
+ * Supported:  $within : { $centerSphere : [ [ x, y ], radians ] } and $within : { $polygon : [ [ x, y ], ... ] },
+ * where polygon edges are arcs of great circles and a polygon must be smaller than a hemisphere.
+ */
+namespace mongo {
+
+    const string GEOSPHERENAME = "2dsphere";
+
+    /** A vector of R3, for points of the unit sphere. */
+    struct Vec3 {
+        Vec3() : x(0), y(0), z(0) {}
+        Vec3( double x_ , double y_ , double z_ ) : x(x_), y(y_), z(z_) {}
+
+        /** @return the point of the unit sphere at long p._x, lat p._y in degrees */
+        static Vec3 fromPoint( const Point& p ) {
+            double lng = deg2rad( p._x );
+            double lat = deg2rad( p._y );
+            return Vec3( cos( lat ) * cos( lng ) , cos( lat ) * sin( lng ) , sin( lat ) );
+        }
+
+        double operator[]( int i ) const { return i == 0 ? x : ( i == 1 ? y : z ); }
+        double& operator[]( int i ) { return i == 0 ? x : ( i == 1 ? y : z ); }
+
+        Vec3 operator-() const { return Vec3( -x , -y , -z ); }
+        Vec3 operator+( const Vec3& o ) const { return Vec3( x + o.x , y + o.y , z + o.z ); }
+        double dot( const Vec3& o ) const { return x * o.x + y * o.y + z * o.z; }
+        Vec3 cross( const Vec3& o ) const { return Vec3( y * o.z - z * o.y , z * o.x - x * o.z , x * o.y - y * o.x ); }
+        double norm() const { return sqrt( dot( *this ) ); }
+        Vec3 normalized() const {
+            double n = norm();
+            return n > 0 ? Vec3( x / n , y / n , z / n ) : *this;
+        }
+
+        /** @return the angle between this and o, in radians; stable for small and large angles */
+        double angle( const Vec3& o ) const { return atan2( cross( o ).norm() , dot( o ) ); }
+
+        double x, y, z;
+    };
+
+    /**
+     * A cell of the decomposition: the sphere is projected from its center onto the six faces of a cube,
+     * and each face is split into quadrants recursively down to MaxLevel.  Face coordinates are warped with
+     * atan so the cells of one level have about the same area everywhere.  Cell edges are arcs of great
+     * circles.
+     *
+     * The id of a cell is its face, then two bits per level for the quadrant, i.e. a Z order curve on each
+     * face.  A point's key is the id of the MaxLevel cell containing it, so the keys of the points in any cell
+     * are the contiguous range [ rangeMin(), rangeMax() ].  MaxLevel cells are about 1cm across.
+     */
+    class SphereCell {
+    public:
+        enum { MaxLevel = 30 };
+
+        SphereCell( int face , int level , unsigned i , unsigned j ) : _face( face ) , _level( level ) , _i( i ) , _j( j ) {}
+
+        /** @return the MaxLevel cell containing p */
+        static SphereCell leaf( const Vec3& p ) {
+            int a = 0;
+            if ( fabs( p[1] ) > fabs( p[a] ) ) a = 1;
+            if ( fabs( p[2] ) > fabs( p[a] ) ) a = 2;
+            double u = p[ ( a + 1 ) % 3 ] / fabs( p[a] );
+            double v = p[ ( a + 2 ) % 3 ] / fabs( p[a] );
+            return SphereCell( p[a] > 0 ? a : a + 3 , MaxLevel , toCoord( warp( u ) ) , toCoord( warp( v ) ) );
+        }
+
+        static long long leafId( const Vec3& p ) { return leaf( p ).rangeMin(); }
+
+        int level() const { return _level; }
+
+        long long id() const {
+            long long id = _face;
+            for ( int k = _level - 1; k >= 0; k-- )
+                id = ( id << 2 ) | ( ( ( _i >> k ) & 1 ) << 1 ) | ( ( _j >> k ) & 1 );
+            return id;
+        }
+        long long rangeMin() const { return id() << ( 2 * ( MaxLevel - _level ) ); }
+        long long rangeMax() const { return ( ( id() + 1 ) << ( 2 * ( MaxLevel - _level ) ) ) - 1; }
+        bool contains( long long leafId ) const { return leafId >= rangeMin() && leafId <= rangeMax(); }
+
+        SphereCell child( int q ) const {
+            return SphereCell( _face , _level + 1 , ( _i << 1 ) | ( q >> 1 ) , ( _j << 1 ) | ( q & 1 ) );
+        }
+
+        /** @return corner k, 0 to 3 in order around the cell */
+        Vec3 vertex( int k ) const {
+            return faceToSphere( edge( _i + ( k == 1 || k == 2 ) ) , edge( _j + ( k >= 2 ) ) );
+        }
+
+        Vec3 center() const {
+            return faceToSphere( ( edge( _i ) + edge( _i + 1 ) ) / 2 , ( edge( _j ) + edge( _j + 1 ) ) / 2 );
+        }
+
+        /** @return the largest angle from center() to a point of the cell */
+        double radius() const {
+            Vec3 c = center();
+            double r = 0;
+            for ( int k = 0; k < 4; k++ )
+                r = max( r , c.angle( vertex( k ) ) );
+            return r;
+        }
+
+        string toString() const {
+            return str::stream() << "face:" << _face << " level:" << _level << " i:" << _i << " j:" << _j;
+        }
+
+    private:
+        static double warp( double u ) { return ( 4 / M_PI ) * atan( u ); }
+        static double unwarp( double s ) { return tan( ( M_PI / 4 ) * s ); }
+
+        static unsigned toCoord( double s ) {
+            const double n = (double)( 1U << MaxLevel );
+            double c = floor( ( s + 1 ) / 2 * n );
+            if ( c < 0 ) return 0;
+            if ( c >= n ) return ( 1U << MaxLevel ) - 1;
+            return (unsigned)c;
+        }
+
+        /** @return the warped face coordinate, in [-1, 1], of cell boundary c at this level */
+        double edge( unsigned c ) const { return 2.0 * c / (double)( 1U << _level ) - 1; }
+
+        Vec3 faceToSphere( double s , double t ) const {
+            int a = _face % 3;
+            Vec3 p;
+            p[a] = _face < 3 ? 1 : -1;
+            p[ ( a + 1 ) % 3 ] = unwarp( s );
+            p[ ( a + 2 ) % 3 ] = unwarp( t );
+            return p.normalized();
+        }
+
+        int _face;
+        int _level;
+        unsigned _i;
+        unsigned _j;
+    };
+
+    /** A region of the sphere a $within query asks for. */
+    class SphereRegion {
+    public:
+        enum Relation { DISJOINT , PARTIAL , INSIDE };
+
+        virtual ~SphereRegion() {}
+        virtual bool contains( const Vec3& p ) const = 0;
+        /** must only answer DISJOINT or INSIDE when sure, PARTIAL is always safe */
+        virtual Relation relate( const SphereCell& cell ) const = 0;
+    };
+
+    /** $centerSphere: the points within an angle of a center */
+    class SphereCap : public SphereRegion {
+    public:
+        SphereCap( const Vec3& center , double radius ) : _center( center ) , _radius( radius ) {}
+
+        virtual bool contains( const Vec3& p ) const { return _center.angle( p ) <= _radius; }
+
+        virtual Relation relate( const SphereCell& cell ) const {
+            double d = _center.angle( cell.center() );
+            double r = cell.radius();
+            if ( d > _radius + r ) return DISJOINT;
+            if ( d + r <= _radius ) return INSIDE;
+            return PARTIAL;
+        }
+
+    private:
+        Vec3 _center;
+        double _radius;
+    };
+
+    /** @return true if the arcs ab and cd, each shorter than half a great circle, cross or touch */
+    static bool arcsCross( const Vec3& a , const Vec3& b , const Vec3& c , const Vec3& d ) {
+        Vec3 n1 = a.cross( b );
+        Vec3 n2 = c.cross( d );
+        if ( n1.dot( c ) * n1.dot( d ) > 0 || n2.dot( a ) * n2.dot( b ) > 0 )
+            return false;
+        Vec3 x = n1.cross( n2 );
+        if ( x.norm() < 1e-15 )
+            return true; // on the same great circle, let the caller treat it as a border
+        for ( int k = 0; k < 2; k++ ) {
+            if ( a.cross( x ).dot( n1 ) >= 0 && x.cross( b ).dot( n1 ) >= 0 &&
+                 c.cross( x ).dot( n2 ) >= 0 && x.cross( d ).dot( n2 ) >= 0 )
+                return true;
+            x = -x;
+        }
+        return false;
+    }
+
+    /** $polygon: edges are arcs of great circles, and the polygon is smaller than a hemisphere */
+    class SpherePolygon : public SphereRegion {
+    public:
+        SpherePolygon( const vector<Vec3>& vertices ) : _vertices( vertices ) {
+            Vec3 sum;
+            for ( unsigned k = 0; k < _vertices.size(); k++ )
+                sum = sum + _vertices[k];
+            _capCenter = sum.normalized();
+            _capRadius = 0;
+            for ( unsigned k = 0; k < _vertices.size(); k++ )
+                _capRadius = max( _capRadius , _capCenter.angle( _vertices[k] ) );
+        }
+
+        /** winding number: the edges turn by +-2pi around a point inside, by 0 around one outside */
+        virtual bool contains( const Vec3& p ) const {
+            if ( _capCenter.angle( p ) > _capRadius )
+                return false;
+            double sum = 0;
+            for ( unsigned k = 0; k < _vertices.size(); k++ ) {
+                Vec3 a = p.cross( _vertices[k] );
+                Vec3 b = p.cross( _vertices[ ( k + 1 ) % _vertices.size() ] );
+                sum += atan2( p.dot( a.cross( b ) ) , a.dot( b ) );
+            }
+            return fabs( sum ) > M_PI;
+        }
+
+        virtual Relation relate( const SphereCell& cell ) const {
+            if ( _capCenter.angle( cell.center() ) > _capRadius + cell.radius() )
+                return DISJOINT;
+
+            Vec3 corners[4];
+            for ( int k = 0; k < 4; k++ )
+                corners[k] = cell.vertex( k );
+
+            for ( unsigned k = 0; k < _vertices.size(); k++ ) {
+                const Vec3& a = _vertices[k];
+                const Vec3& b = _vertices[ ( k + 1 ) % _vertices.size() ];
+                for ( int e = 0; e < 4; e++ ) {
+                    if ( arcsCross( a , b , corners[e] , corners[ ( e + 1 ) % 4 ] ) )
+                        return PARTIAL;
+                }
+            }
+
+            // no edges cross, so the cell is either all inside, all outside or around the whole polygon
+            int inside = 0;
+            for ( int k = 0; k < 4; k++ )
+                if ( contains( corners[k] ) )
+                    inside++;
+            if ( inside == 4 )
+                return INSIDE;
+            if ( inside == 0 )
+                return cell.contains( SphereCell::leafId( _vertices[0] ) ) ? PARTIAL : DISJOINT;
+            return PARTIAL;
+        }
+
+    private:
+        vector<Vec3> _vertices;
+        Vec3 _capCenter;
+        double _capRadius;
+    };
+
+    /** keys [ min, max ] of a cell of a covering; inside if every point in it is in the region */
+    struct SphereKeyRange {
+        long long min;
+        long long max;
+        bool inside;
+        bool operator<( const SphereKeyRange& o ) const { return min < o.min; }
+    };
+
+    /**
+     * Covers region with about maxCells cells: breadth first from the faces, cells crossing the border of
+     * the region are split until the budget is used up, then the ranges of adjacent cells are merged.
+     */
+    static void coverRegion( const SphereRegion& region , unsigned maxCells , vector<SphereKeyRange>& ranges ) {
+        deque<SphereCell> work;
+        for ( int face = 0; face < 6; face++ )
+            work.push_back( SphereCell( face , 0 , 0 , 0 ) );
+
+        vector<SphereKeyRange> cells;
+        while ( ! work.empty() ) {
+            SphereCell cell = work.front();
+            work.pop_front();
+
+            SphereRegion::Relation r = region.relate( cell );
+            if ( r == SphereRegion::DISJOINT )
+                continue;
+
+            if ( r == SphereRegion::INSIDE || cell.level() == SphereCell::MaxLevel ||
+                 cells.size() + work.size() + 4 > maxCells ) {
+                SphereKeyRange range;
+                range.min = cell.rangeMin();
+                range.max = cell.rangeMax();
+                range.inside = ( r == SphereRegion::INSIDE );
+                cells.push_back( range );
+                continue;
+            }
+
+            for ( int q = 0; q < 4; q++ )
+                work.push_back( cell.child( q ) );
+        }
+
+        sort( cells.begin() , cells.end() );
+        ranges.clear();
+        for ( unsigned k = 0; k < cells.size(); k++ ) {
+            if ( ranges.size() && ranges.back().inside == cells[k].inside && ranges.back().max + 1 == cells[k].min )
+                ranges.back().max = cells[k].max;
+            else
+                ranges.push_back( cells[k] );
+        }
+    }
+
+    class SphereIndex : public IndexType {
+    public:
+        /** cells in the covering of a query region */
+        static const unsigned MaxCoveringCells = 32;
+
+        SphereIndex( const IndexPlugin* plugin , const IndexSpec* spec )
+            : IndexType( plugin , spec ) {
+            BSONObjIterator i( spec->keyPattern );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                uassert( 16112 , "2dsphere index can't have other fields" ,
+                         _geo.empty() && e.type() == String && GEOSPHERENAME == e.valuestr() );
+                _geo = e.fieldName();
+            }
+            uassert( 16113 , "no 2dsphere field specified" , ! _geo.empty() );
+        }
+
+        /** @return the points of the geo field of obj: a point, or an array or object of points */
+        void getPoints( const BSONObj& obj , vector<Point>& points ) const {
+            BSONElement loc = obj.getFieldDotted( _geo );
+            if ( loc.eoo() )
+                return;
+            uassert( 16114 , "2dsphere location must be an array or object" , loc.isABSONObj() );
+            BSONObj o = loc.embeddedObject();
+            if ( o.firstElement().isNumber() ) {
+                points.push_back( point( o ) );
+                return;
+            }
+            BSONObjIterator i( o );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                uassert( 16115 , "2dsphere location must be a point or an array of points" , e.isABSONObj() );
+                points.push_back( point( e.embeddedObject() ) );
+            }
+        }
+
+        static Point point( const BSONObj& o ) {
+            BSONObjIterator i( o );
+            BSONElement x = i.next();
+            BSONElement y = i.next();
+            uassert( 16116 , str::stream() << "2dsphere point must be [ long, lat ]: " << o , x.isNumber() && y.isNumber() );
+            Point p( x.number() , y.number() );
+            checkEarthBounds( p );
+            return p;
+        }
+
+        virtual void getKeys( const BSONObj& obj , BSONObjSet& keys ) const {
+            vector<Point> points;
+            getPoints( obj , points );
+            for ( unsigned k = 0; k < points.size(); k++ )
+                keys.insert( BSON( "" << SphereCell::leafId( Vec3::fromPoint( points[k] ) ) ) );
+        }
+
+        /** @return true if obj has a point with key leafId in region */
+        bool inRegion( const BSONObj& obj , long long leafId , const SphereRegion& region ) const {
+            vector<Point> points;
+            getPoints( obj , points );
+            for ( unsigned k = 0; k < points.size(); k++ ) {
+                Vec3 p = Vec3::fromPoint( points[k] );
+                if ( SphereCell::leafId( p ) == leafId && region.contains( p ) )
+                    return true;
+            }
+            return false;
+        }
+
+        /** @return the region of a $within, or 0 if it's not a shape this index covers */
+        static SphereRegion* parseWithin( const BSONElement& e ) {
+            if ( e.type() != Object )
+                return 0;
+            BSONObj sub = e.embeddedObject();
+            if ( sub.firstElement().getGtLtOp() != BSONObj::opWITHIN || ! sub.firstElement().isABSONObj() )
+                return 0;
+            BSONElement shape = sub.firstElement().embeddedObject().firstElement();
+            string type = shape.fieldName();
+
+            if ( type == "$centerSphere" ) {
+                uassert( 16117 , "$centerSphere needs [ center, radius ]" , shape.isABSONObj() );
+                BSONObjIterator i( shape.embeddedObject() );
+                BSONElement center = i.next();
+                BSONElement radius = i.next();
+                uassert( 16118 , "$centerSphere needs [ center, radius ]" , center.isABSONObj() && radius.isNumber() );
+                uassert( 16119 , "$centerSphere radius must be >= 0" , radius.number() >= 0 );
+                return new SphereCap( Vec3::fromPoint( point( center.embeddedObject() ) ) , radius.number() );
+            }
+            if ( type == "$polygon" ) {
+                uassert( 16120 , "$polygon has to take an object or array" , shape.isABSONObj() );
+                vector<Vec3> vertices;
+                BSONObjIterator i( shape.embeddedObject() );
+                while ( i.more() ) {
+                    BSONElement v = i.next();
+                    uassert( 16121 , "$polygon vertices must be points" , v.isABSONObj() );
+                    vertices.push_back( Vec3::fromPoint( point( v.embeddedObject() ) ) );
+                }
+                uassert( 16122 , "$polygon needs at least 3 vertices" , vertices.size() >= 3 );
+                return new SpherePolygon( vertices );
+            }
+            return 0;
+        }
+
+        virtual shared_ptr<Cursor> newCursor( const BSONObj& query , const BSONObj& order , int numWanted ) const;
+
+        virtual IndexSuitability suitability( const BSONObj& query , const BSONObj& order ) const {
+            BSONElement e = query.getFieldDotted( _geo.c_str() );
+            if ( e.type() != Object )
+                return USELESS;
+            BSONObj sub = e.embeddedObject();
+            if ( sub.firstElement().getGtLtOp() != BSONObj::opWITHIN || ! sub.firstElement().isABSONObj() )
+                return USELESS;
+            string type = sub.firstElement().embeddedObject().firstElementFieldName();
+            return ( type == "$centerSphere" || type == "$polygon" ) ? OPTIMAL : USELESS;
+        }
+
+        const IndexDetails* getDetails() const { return _spec->getDetails(); }
+
+        string _geo;
+    };
+
+    /** Scans the key ranges of the covering of a region, checking points of border cells exactly. */
+    class SphereCursor : public Cursor {
+    public:
+        SphereCursor( const SphereIndex* index , SphereRegion* region , const BSONObj& query )
+            : _index( index ) , _region( region ) , _range( -1 ) , _nscanned( 0 ) , _exactChecks( 0 ) {
+            coverRegion( *_region , SphereIndex::MaxCoveringCells , _ranges );
+            _matcher.reset( new CoveredIndexMatcher( query , _index->keyPattern() ) );
+            findNext();
+        }
+
+        virtual bool ok() { return ! _currLoc.isNull(); }
+        virtual Record* _current() { assert( ok() ); return _currLoc.rec(); }
+        virtual BSONObj current() { assert( ok() ); return _currLoc.obj(); }
+        virtual DiskLoc currLoc() { return _currLoc; }
+        virtual BSONObj currKey() const { return _currKey; }
+        virtual DiskLoc refLoc() { return DiskLoc(); }
+        virtual bool advance() {
+            findNext();
+            return ok();
+        }
+
+        virtual BSONObj indexKeyPattern() { return _index->keyPattern(); }
+
+        // the results are only valid while the read lock is held, as for the 2d cursors
+        virtual bool supportGetMore() { return false; }
+        virtual bool supportYields() { return false; }
+        virtual bool getsetdup( DiskLoc loc ) { return false; }
+        virtual bool modifiedKeys() const { return true; }
+        virtual bool isMultiKey() const { return false; }
+        virtual bool autoDedup() const { return false; }
+
+        virtual long long nscanned() { return _nscanned; }
+
+        virtual CoveredIndexMatcher* matcher() const { return _matcher.get(); }
+        virtual shared_ptr<CoveredIndexMatcher> matcherPtr() const { return _matcher; }
+        virtual void setMatcher( shared_ptr<CoveredIndexMatcher> matcher ) { _matcher = matcher; }
+
+        virtual string toString() { return "SphereCursor"; }
+
+        virtual BSONObj prettyIndexBounds() const {
+            BSONArrayBuilder b;
+            for ( unsigned k = 0; k < _ranges.size(); k++ )
+                b.append( BSON_ARRAY( _ranges[k].min << _ranges[k].max ) );
+            return BSON( _index->_geo << b.arr() );
+        }
+
+        virtual void explainDetails( BSONObjBuilder& b ) {
+            b << "keyRanges" << (int)_ranges.size();
+            b << "exactChecks" << _exactChecks;
+        }
+
+    private:
+        /** moves to the next document with a point in the region, skipping ones already returned */
+        void findNext() {
+            _currLoc = DiskLoc();
+            while ( 1 ) {
+                if ( ! _btree.get() || ! _btree->ok() ) {
+                    if ( ++_range >= (int)_ranges.size() )
+                        return;
+                    const IndexDetails* id = _index->getDetails();
+                    _btree.reset( BtreeCursor::make( nsdetails( id->parentNS().c_str() ) , *id ,
+                                                     BSON( "" << _ranges[_range].min ) , BSON( "" << _ranges[_range].max ) ,
+                                                     true , 1 ) );
+                    continue;
+                }
+
+                DiskLoc loc = _btree->currLoc();
+                BSONObj key = _btree->currKey();
+                _btree->advance();
+                _nscanned++;
+
+                if ( _seen.count( loc ) )
+                    continue;
+                if ( ! _ranges[_range].inside ) {
+                    _exactChecks++;
+                    if ( ! _index->inRegion( loc.obj() , key.firstElement().numberLong() , *_region ) )
+                        continue;
+                }
+
+                _seen.insert( loc );
+                _currLoc = loc;
+                _currKey = key;
+                return;
+            }
+        }
+
+        const SphereIndex* _index;
+        scoped_ptr<SphereRegion> _region;
+        vector<SphereKeyRange> _ranges;
+        int _range;
+        scoped_ptr<BtreeCursor> _btree;
+        set<DiskLoc> _seen;
+        DiskLoc _currLoc;
+        BSONObj _currKey;
+        shared_ptr<CoveredIndexMatcher> _matcher;
+        long long _nscanned;
+        long long _exactChecks;
+    };
+
+    shared_ptr<Cursor> SphereIndex::newCursor( const BSONObj& query , const BSONObj& order , int numWanted ) const {
+        SphereRegion* region = parseWithin( query.getFieldDotted( _geo.c_str() ) );
+        uassert( 16123 , str::stream() << "2dsphere index only answers $within $centerSphere and $polygon: " << query , region );
+        return shared_ptr<Cursor>( new SphereCursor( this , region , query ) );
+    }
+
+    class SphereIndexPlugin : public IndexPlugin {
+    public:
+        SphereIndexPlugin() : IndexPlugin( GEOSPHERENAME ) {}
+
+        virtual IndexType* generate( const IndexSpec* spec ) const {
+            return new SphereIndex( this , spec );
+        }
+
+        // the query parser marks all geo queries "2d", suitability() picks the ones we cover;
+        // a suitable 2d index is still preferred (QueryPlanSet::init)
+        virtual bool handlesSpecial( const string& special ) const {
+            return special == "2d" || special == getName();
+        }
+
+    } sphereIndexPlugin;
+
+    struct SphereUnitTest : public UnitTest {
+        void run() {
+            Vec3 p = Vec3::fromPoint( Point( -73.99 , 40.75 ) );
+            SphereCell leaf = SphereCell::leaf( p );
+            assert( leaf.level() == SphereCell::MaxLevel );
+            assert( leaf.center().angle( p ) <= leaf.radius() + 1e-12 );
+            assert( leaf.radius() < 1e-8 ); // about a centimeter on earth
+            assert( leaf.rangeMin() == leaf.rangeMax() );
+
+            // keys of a cell's descendants are within its range, and children split it in order
+            SphereCell face( 2 , 0 , 0 , 0 );
+            assert( face.rangeMin() == 2LL << 60 );
+            assert( face.child( 0 ).rangeMin() == face.rangeMin() );
+            assert( face.child( 3 ).rangeMax() == face.rangeMax() );
+            assert( face.child( 0 ).rangeMax() + 1 == face.child( 1 ).rangeMin() );
+
+            // every face, including the poles
+            Point poles[] = { Point( 0 , 90 ) , Point( 0 , -90 ) , Point( 0 , 0 ) , Point( 90 , 0 ) , Point( -180 , 0 ) , Point( -90 , 0 ) };
+            set<long long> faces;
+            for ( int k = 0; k < 6; k++ )
+                faces.insert( SphereCell::leafId( Vec3::fromPoint( poles[k] ) ) >> 60 );
+            assert( faces.size() == 6 );
+
+            // a covering contains the points of its region
+            SphereCap cap( p , deg2rad( 1 ) );
+            vector<SphereKeyRange> ranges;
+            coverRegion( cap , 32 , ranges );
+            assert( ranges.size() > 0 && ranges.size() <= 32 );
+            for ( int k = 0; k < 100; k++ ) {
+                Vec3 q = Vec3::fromPoint( Point( -73.99 + ( k % 10 - 5 ) * 0.15 , 40.75 + ( k / 10 - 5 ) * 0.15 ) );
+                if ( ! cap.contains( q ) )
+                    continue;
+                long long id = SphereCell::leafId( q );
+                bool covered = false;
+                for ( unsigned r = 0; r < ranges.size(); r++ )
+                    covered = covered || ( id >= ranges[r].min && id <= ranges[r].max );
+                assert( covered );
+            }
+
+            vector<Vec3> square;
+            square.push_back( Vec3::fromPoint( Point( 0 , 0 ) ) );
+            square.push_back( Vec3::fromPoint( Point( 10 , 0 ) ) );
+            square.push_back( Vec3::fromPoint( Point( 10 , 10 ) ) );
+            square.push_back( Vec3::fromPoint( Point( 0 , 10 ) ) );
+            SpherePolygon polygon( square );
+            assert( polygon.contains( Vec3::fromPoint( Point( 5 , 5 ) ) ) );
+            assert( ! polygon.contains( Vec3::fromPoint( Point( 15 , 5 ) ) ) );
+            assert( ! polygon.contains( Vec3::fromPoint( Point( -175 , -5 ) ) ) );
+            assert( polygon.relate( SphereCell::leaf( Vec3::fromPoint( Point( 5 , 5 ) ) ) ) == SphereRegion::INSIDE );
+            assert( polygon.relate( SphereCell::leaf( Vec3::fromPoint( Point( 50 , 50 ) ) ) ) == SphereRegion::DISJOINT );
+        }
+    } sphereUnitTest;
+
+}
@@ -23,6 +23,7 @@
 #include "background.h"
 #include "repl/rs.h"
 #include "ops/delete.h"
+#include "fieldindex.h"
 
 
 namespace mongo {
@@ -79,6 +80,15 @@ namespace mongo {
         virtual DiskLoc findSingle(const IndexDetails &indexdetails , const DiskLoc& thisLoc, const BSONObj& key) const { 
             return thisLoc.btree<V>()->findSingle(indexdetails,thisLoc,key);
         } 
+        virtual long long countRange(const DiskLoc& thisLoc, const BSONObj& low, bool lowInclusive,
+                                     const BSONObj& high, bool highInclusive, const Ordering& order,
+                                     long long maxCount, int maxBuckets) const {
+            return thisLoc.btree<V>()->countRange(thisLoc, KeyOwned(low), lowInclusive, KeyOwned(high), highInclusive, order,
+                                                  maxCount, maxBuckets);
+        }
+        virtual void checkWriteFaults(const IndexDetails& idx, const BSONObj& key, const Ordering& order) const {
+            BtreeBucket<V>::checkWriteFaults(idx, idx.head, KeyOwned(key), order);
+        }
         virtual bool unindex(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc recordLoc) const {
             return thisLoc.btree<V>()->unindex(thisLoc, id, key, recordLoc);
         }
@@ -256,6 +266,8 @@ namespace mongo {
     void getIndexChanges(vector<IndexChanges>& v, NamespaceDetails& d, BSONObj newObj, BSONObj oldObj, bool &changedId) {
         int z = d.nIndexesBeingBuilt();
         v.resize(z);
+        FieldIndex::Scope oldScope( oldObj , z );
+        FieldIndex::Scope newScope( newObj , z );
         for( int i = 0; i < z; i++ ) {
             IndexDetails& idx = d.idx(i);
             BSONObj idxKey = idx.info.obj().getObjectField("key"); // eg { ts : 1 }
@@ -40,6 +40,12 @@ namespace mongo {
         virtual int keyCompare(const BSONObj& l,const BSONObj& r, const Ordering &ordering) = 0;
         virtual long long fullValidate(const DiskLoc& thisLoc, const BSONObj &order) = 0;
         virtual DiskLoc findSingle(const IndexDetails &indexdetails , const DiskLoc& thisLoc, const BSONObj& key) const = 0;
+        /** @return the number of keys k with low <(=) k <(=) high, see BtreeBucket::countRange() */
+        virtual long long countRange(const DiskLoc& thisLoc, const BSONObj& low, bool lowInclusive,
+                                     const BSONObj& high, bool highInclusive, const Ordering& order,
+                                     long long maxCount, int maxBuckets) const = 0;
+        /** see BtreeBucket::checkWriteFaults() */
+        virtual void checkWriteFaults(const IndexDetails& idx, const BSONObj& key, const Ordering& order) const = 0;
         virtual bool unindex(const DiskLoc thisLoc, IndexDetails& id, const BSONObj& key, const DiskLoc recordLoc) const = 0;
         virtual int bt_insert(const DiskLoc thisLoc, const DiskLoc recordLoc,
             const BSONObj& key, const Ordering &order, bool dupsAllowed,
@@ -22,6 +22,7 @@
 #include "btree.h"
 #include "ops/query.h"
 #include "background.h"
+#include "fieldindex.h"
 #include "../util/stringutils.h"
 #include "../util/text.h"
 
@@ -158,12 +159,13 @@ namespace mongo {
             BSONElement arrElt;
             unsigned arrIdx = ~0;
             int numNotFound = 0;
+            const FieldIndex* fi = FieldIndex::forObj( obj );
             
             for( unsigned i = 0; i < fieldNames.size(); ++i ) {
                 if ( *fieldNames[ i ] == '\0' )
                     continue;
                 
-                BSONElement e = obj.getFieldDottedOrArray( fieldNames[ i ] );
+                BSONElement e = fi ? fi->getFieldDottedOrArray( fieldNames[ i ] ) : obj.getFieldDottedOrArray( fieldNames[ i ] );
                 
                 if ( e.eoo() ) {
                     e = _spec._nullElt; // no matching field
@@ -292,7 +294,8 @@ namespace mongo {
          */
         BSONElement extractNextElement( const BSONObj &obj, const BSONObj &arr, const char *&field, bool &arrayNestedArray ) const {
             string firstField = mongoutils::str::before( field, '.' );
-            bool haveObjField = !obj.getField( firstField ).eoo();
+            const FieldIndex* fi = FieldIndex::forObj( obj );
+            bool haveObjField = !( fi ? fi->getField( firstField ) : obj.getField( firstField ) ).eoo();
             BSONElement arrField = arr.getField( firstField );
             bool haveArrField = !arrField.eoo();
 
@@ -301,7 +304,7 @@ namespace mongo {
 
             arrayNestedArray = false;
 			if ( haveObjField ) {
-                return obj.getFieldDottedOrArray( field );
+                return fi ? fi->getFieldDottedOrArray( field ) : obj.getFieldDottedOrArray( field );
             }
             else if ( haveArrField ) {
                 if ( arrField.type() == Array ) {
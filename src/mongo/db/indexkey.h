@@ -92,6 +92,12 @@ namespace mongo {
          */
         virtual BSONObj adjustIndexSpec( const BSONObj& spec ) const { return spec; }
 
+        /**
+         * @return true if indexes of this type may answer queries the parser marked special,
+         * eg "2d" for $near and $within; suitability() then decides for the actual query
+         */
+        virtual bool handlesSpecial( const string& special ) const { return special == _name; }
+
         // ------- static below -------
 
         static IndexPlugin* get( const string& name ) {
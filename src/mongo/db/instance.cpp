@@ -312,6 +312,26 @@ namespace mongo {
         ::abort();
     }
 
+    /** @return true if the op is a query, getmore or command on a system.profile collection */
+    static bool readsProfile( Message& m , int op , const char *ns , bool isCommand ) {
+        if ( op != dbQuery && op != dbGetMore )
+            return false;
+        if ( !isCommand )
+            return str::endsWith( ns , ".system.profile" );
+        try {
+            DbMessage d( m );
+            QueryMessage q( d );
+            BSONElement e = q.query.firstElement();
+            if ( e.isABSONObj() && ( strcmp( e.fieldName() , "query" ) == 0 || strcmp( e.fieldName() , "$query" ) == 0 ) )
+                e = e.embeddedObject().firstElement();
+            return e.type() == String && strcmp( e.valuestr() , "system.profile" ) == 0;
+        }
+        catch ( AssertionException& ) {
+            // a bad message, receivedQuery() reports it
+            return false;
+        }
+    }
+
     // Returns false when request includes 'end'
     void assembleResponse( Message &m, DbResponse &dbresponse, const HostAndPort& remote ) {
 
@@ -352,6 +372,11 @@ namespace mongo {
 
         globalOpCounters.gotOp( op , isCommand );
 
+        if ( readsProfile( m , op , ns , isCommand ) && !Lock::isLocked() ) {
+            // see what was profiled before this op
+            profileFlush();
+        }
+
         Client& c = cc();
         
         
@@ -444,6 +469,8 @@ namespace mongo {
         currentOp.ensureStarted();
         currentOp.done();
         debug.executionTime = currentOp.totalTimeMillis();
+        if ( ! debug.lockStats.empty() )
+            c.lockStats().add( debug.lockStats );
 
         //DEV log = true;
         if ( log || debug.executionTime > logThreshold ) {
@@ -456,20 +483,8 @@ namespace mongo {
         }
 
         if ( currentOp.shouldDBProfile( debug.executionTime ) ) {
-            // performance profiling is on
-            if ( Lock::isReadLocked() ) {
-                mongo::log(1) << "note: not profiling because recursive read lock" << endl;
-            }
-            else {
-                writelock lk;
-                if ( dbHolder()._isLoaded( nsToDatabase( currentOp.getNS() ) , dbpath ) ) {
-                    Client::Context cx( currentOp.getNS(), dbpath, false );
-                    profile(c , currentOp );
-                }
-                else {
-                    mongo::log() << "note: not profiling because db went away - probably a close on: " << currentOp.getNS() << endl;
-                }
-            }
+            // performance profiling is on, the entry is written in the background
+            profile(c , currentOp );
         }
         
         debug.reset();
@@ -585,19 +600,28 @@ namespace mongo {
         op.debug().query = pattern;
         op.setQuery(pattern);
 
-        writelock lk(ns);
+        PageFaultRetryableSection s;
+        while ( 1 ) {
+            try {
+                writelock lk(ns);
 
-        // writelock is used to synchronize stepdowns w/ writes
-        uassert( 10056 ,  "not master", isMasterNs( ns ) );
+                // writelock is used to synchronize stepdowns w/ writes
+                uassert( 10056 ,  "not master", isMasterNs( ns ) );
 
-        // if this ever moves to outside of lock, need to adjust check Client::Context::_finishInit
-        if ( ! broadcast && handlePossibleShardedMessage( m , 0 ) )
-            return;
+                // if this ever moves to outside of lock, need to adjust check Client::Context::_finishInit
+                if ( ! broadcast && handlePossibleShardedMessage( m , 0 ) )
+                    return;
 
-        Client::Context ctx(ns);
+                Client::Context ctx(ns);
 
-        long long n = deleteObjects(ns, pattern, justOne, true);
-        lastError.getSafe()->recordDelete( n );
+                long long n = deleteObjects(ns, pattern, justOne, true);
+                lastError.getSafe()->recordDelete( n );
+                break;
+            }
+            catch ( PageFaultException& e ) {
+                e.touch();
+            }
+        }
     }
 
     QueryResult* emptyMoreResult(long long);
@@ -717,6 +741,63 @@ namespace mongo {
         return ok;
     }
 
+    /**
+     * A probe descends each index once more than the insert itself will, which is wasted work while the
+     * indexes are in memory.  So once probes find nothing cold only one insert in InsertProbeInterval is
+     * probed, and every insert again for a while after a probe finds a cold bucket.  Faults the skipped
+     * inserts take are counted as under lock.
+     */
+    static const unsigned InsertProbeInterval = 16;
+    static AtomicUInt insertsSinceColdProbe;
+
+    /** yields, see checkWriteFault(), if the index buckets inserting js will write to are likely not in memory */
+    static void checkInsertFaults(NamespaceDetails *d, const BSONObj& js) {
+        unsigned n = insertsSinceColdProbe++;
+        if ( n >= InsertProbeInterval && n % InsertProbeInterval != 0 )
+            return;
+
+        // the insert adds an _id if there is none, an ObjectId made now goes about where that one will
+        BSONObj obj = js;
+        if ( ! js.hasField("_id") ) {
+            BSONObjBuilder b;
+            b.appendOID("_id", 0, true);
+            b.appendElements(js);
+            obj = b.obj();
+        }
+
+        try {
+            for ( int i = 0; i < d->nIndexes; i++ ) {
+                IndexDetails& idx = d->idx(i);
+                if ( idx.head.isNull() )
+                    continue;
+                BSONObjSet keys;
+                idx.getKeysFromObject(obj, keys);
+                Ordering order = Ordering::make(idx.keyPattern());
+                for ( BSONObjSet::const_iterator k = keys.begin(); k != keys.end(); ++k )
+                    idx.idxInterface().checkWriteFaults(idx, *k, order);
+            }
+        }
+        catch ( PageFaultException& ) {
+            insertsSinceColdProbe.zero();
+            throw;
+        }
+    }
+
+    /** checkInsertFaults() for every document of an insert, before the first one is written */
+    static void checkInsertFaults(const char *ns, const BSONObj& first, const vector<BSONObj>& multi) {
+        if ( ! cc().allowedToThrowPageFaultException() )
+            return;
+        NamespaceDetails *d = nsdetails(ns);
+        if ( d == 0 )
+            return;
+        if ( multi.empty() ) {
+            checkInsertFaults(d, first);
+            return;
+        }
+        for ( unsigned i = 0; i < multi.size(); i++ )
+            checkInsertFaults(d, multi[i]);
+    }
+
     void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) { 
         uassert( 10059 , "object to insert too large", js.objsize() <= BSONObjMaxUserSize);
         {
@@ -767,25 +848,36 @@ namespace mongo {
             multi.push_back( d.nextJsObj() );
         }
 
-        writelock lk(ns);
+        PageFaultRetryableSection s;
+        while ( 1 ) {
+            try {
+                writelock lk(ns);
 
-        // CONCURRENCY TODO: is being read locked in big log sufficient here?
-        // writelock is used to synchronize stepdowns w/ writes
-        uassert( 10058 , "not master", isMasterNs(ns) );
+                // CONCURRENCY TODO: is being read locked in big log sufficient here?
+                // writelock is used to synchronize stepdowns w/ writes
+                uassert( 10058 , "not master", isMasterNs(ns) );
 
-        if ( handlePossibleShardedMessage( m , 0 ) )
-            return;
+                if ( handlePossibleShardedMessage( m , 0 ) )
+                    return;
 
-        Client::Context ctx(ns);
+                Client::Context ctx(ns);
 
-        if( !multi.empty() ) {
-            const bool keepGoing = d.reservedField() & InsertOption_ContinueOnError;
-            insertMulti(keepGoing, ns, multi);
-            return;
-        }
+                checkInsertFaults(ns, first, multi);
+
+                if( !multi.empty() ) {
+                    const bool keepGoing = d.reservedField() & InsertOption_ContinueOnError;
+                    insertMulti(keepGoing, ns, multi);
+                    return;
+                }
 
-        checkAndInsert(ns, first);
-        globalOpCounters.incInsertInWriteLock(1);
+                checkAndInsert(ns, first);
+                globalOpCounters.incInsertInWriteLock(1);
+                break;
+            }
+            catch ( PageFaultException& e ) {
+                e.touch();
+            }
+        }
     }
 
     void getDatabaseNames( vector< string > &names , const string& usePath ) {
@@ -1005,6 +1097,7 @@ namespace mongo {
                 }
                 stringstream ss;
                 ss << "dbexit: " << why << "; exiting immediately";
+                Logstream::stopAsyncWriter();
                 tryToOutputFatal( ss.str() );
                 if ( c ) c->shutdown();
                 ::exit( rc );
@@ -1044,6 +1137,7 @@ namespace mongo {
             return;
         }
 #endif
+        Logstream::stopAsyncWriter();
         tryToOutputFatal( "dbexit: really exiting now" );
         if ( c ) c->shutdown();
         ::exit(rc);
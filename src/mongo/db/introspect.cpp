@@ -24,21 +24,308 @@
 #include "jsobj.h"
 #include "pdfile.h"
 #include "curop.h"
+#include "commands.h"
+#include "databaseholder.h"
+#include "querypattern.h"
+#include "../util/background.h"
 
 namespace mongo {
 
-    BufBuilder profileBufBuilder; // reused, instead of allocated every time - avoids a malloc/free cycle
+    namespace {
+
+        SimpleMutex samplingMutex( "profileSampling" );
+        double sampleRate = 1.0;
+        map< string, set<string> > sampledNamespaces; // db -> collections profiled, if filtered
+        unsigned sampleRandom = 2463534242U;
+
+        bool sampled( const char *ns ) {
+            SimpleMutex::scoped_lock lk( samplingMutex );
+            if ( !sampledNamespaces.empty() ) {
+                map< string, set<string> >::const_iterator i = sampledNamespaces.find( nsToDatabase( ns ) );
+                if ( i != sampledNamespaces.end() && i->second.count( ns ) == 0 )
+                    return false;
+            }
+            if ( sampleRate >= 1.0 )
+                return true;
+            // xorshift, good enough to pick ops
+            sampleRandom ^= sampleRandom << 13;
+            sampleRandom ^= sampleRandom >> 17;
+            sampleRandom ^= sampleRandom << 5;
+            return sampleRandom < sampleRate * 4294967296.0;
+        }
+
+        /**
+         * Totals of the profiled queries, updates and removes of each namespace by query pattern,
+         * so the shapes worth an index stand out without reading system.profile.
+         */
+        class QueryPatternStats : boost::noncopyable {
+        public:
+            QueryPatternStats() : _m( "QueryPatternStats" ) , _untracked( 0 ) {}
+
+            void record( const OpDebug& debug );
+            void append( const string& db , BSONObjBuilder& b ) const;
+            void reset( const string& db );
+
+        private:
+            struct Stats {
+                Stats() : count( 0 ) , millis( 0 ) , maxMillis( 0 ) , nscanned( 0 ) , nreturned( 0 ) {}
+                long long count;
+                long long millis;
+                long long maxMillis;
+                long long nscanned;
+                long long nreturned;
+                BSONObj example; // first query seen
+            };
+            typedef map< pair<string,QueryPattern>, Stats > StatsMap;
+
+            enum { MaxPatterns = 1000 };
+
+            mutable SimpleMutex _m;
+            StatsMap _stats;
+            long long _untracked; // ops not counted as MaxPatterns was reached
+        } queryPatternStats;
+
+        void QueryPatternStats::record( const OpDebug& debug ) {
+            if ( debug.iscommand || ( debug.op != dbQuery && debug.op != dbUpdate && debug.op != dbDelete ) )
+                return;
+
+            const string ns = debug.ns.toString();
+            BSONObj query = debug.query;
+            BSONObj sort;
+            if ( debug.op == dbQuery ) {
+                BSONElement e = query["query"];
+                if ( !e.isABSONObj() )
+                    e = query["$query"];
+                if ( e.isABSONObj() ) {
+                    BSONElement o = query["orderby"];
+                    if ( !o.isABSONObj() )
+                        o = query["$orderby"];
+                    if ( o.type() == Object )
+                        sort = o.embeddedObject();
+                    query = e.embeddedObject();
+                }
+            }
+
+            pair<string,QueryPattern> key( ns, QueryPattern( FieldRangeSet( ns.c_str(), query, true ), sort ) );
+
+            SimpleMutex::scoped_lock lk( _m );
+            StatsMap::iterator i = _stats.find( key );
+            if ( i == _stats.end() ) {
+                if ( _stats.size() >= MaxPatterns ) {
+                    _untracked++;
+                    return;
+                }
+                i = _stats.insert( make_pair( key, Stats() ) ).first;
+                i->second.example = query.getOwned();
+            }
+            Stats& s = i->second;
+            s.count++;
+            s.millis += debug.executionTime;
+            s.maxMillis = max( s.maxMillis, (long long) debug.executionTime );
+            s.nscanned += debug.nscanned;
+            s.nreturned += debug.nreturned;
+        }
+
+        void QueryPatternStats::append( const string& db , BSONObjBuilder& b ) const {
+            SimpleMutex::scoped_lock lk( _m );
+            BSONArrayBuilder a( b.subarrayStart( "patterns" ) );
+            for ( StatsMap::const_iterator i = _stats.begin(); i != _stats.end(); ++i ) {
+                if ( nsToDatabase( i->first.first ) != db )
+                    continue;
+                const Stats& s = i->second;
+                BSONObjBuilder p( a.subobjStart() );
+                p.append( "ns" , i->first.first );
+                p.append( "pattern" , i->first.second.toString() );
+                p.append( "example" , s.example );
+                p.appendNumber( "count" , s.count );
+                p.appendNumber( "millis" , s.millis );
+                p.appendNumber( "maxMillis" , s.maxMillis );
+                p.appendNumber( "nscanned" , s.nscanned );
+                p.appendNumber( "nreturned" , s.nreturned );
+                // documents looked at per document returned, 1 is ideal
+                p.append( "nscannedRatio" , s.nreturned ? (double) s.nscanned / s.nreturned : (double) s.nscanned );
+                p.done();
+            }
+            a.done();
+            b.appendNumber( "untracked" , _untracked );
+        }
+
+        void QueryPatternStats::reset( const string& db ) {
+            SimpleMutex::scoped_lock lk( _m );
+            for ( StatsMap::iterator i = _stats.begin(); i != _stats.end(); ) {
+                if ( nsToDatabase( i->first.first ) == db )
+                    _stats.erase( i++ );
+                else
+                    ++i;
+            }
+        }
+
+        /**
+         * Writes the queued profile entries, so the op being profiled doesn't take the write lock.
+         * Entries are written in batches, one lock per batch.
+         */
+        class ProfileWriter : public BackgroundJob {
+        public:
+            ProfileWriter() : _m( "ProfileWriter" ) , _started( false ) , _queued( 0 ) , _written( 0 ) , _dropped( 0 ) {}
+
+            void push( const string& ns , const BSONObj& entry );
+            void flush();
+
+        private:
+            typedef vector< pair<string,BSONObj> > Batch;
+
+            /** most entries queued, past which new ones are dropped rather than hold memory */
+            enum { MaxQueued = 10000 };
+
+            virtual string name() const { return "profileWriter"; }
+            virtual void run();
+            void write( const Batch& batch );
+
+            mongo::mutex _m;
+            boost::condition _queuedCondition;
+            boost::condition _writtenCondition;
+            Batch _queue;
+            bool _started;
+            unsigned long long _queued;
+            unsigned long long _written;
+            unsigned long long _dropped;
+        } profileWriter;
+
+        void ProfileWriter::push( const string& ns , const BSONObj& entry ) {
+            scoped_lock lk( _m );
+            if ( !_started ) {
+                _started = true;
+                go();
+            }
+            if ( _queue.size() >= MaxQueued ) {
+                if ( _dropped++ % 1000 == 0 )
+                    warning() << "profile writes falling behind, " << _dropped << " entries dropped" << endl;
+                return;
+            }
+            _queue.push_back( make_pair( ns, entry ) );
+            _queued++;
+            _queuedCondition.notify_one();
+        }
+
+        void ProfileWriter::flush() {
+            scoped_lock lk( _m );
+            unsigned long long target = _queued;
+            boost::xtime xt;
+            boost::xtime_get( &xt, boost::TIME_UTC );
+            xt.sec += 30;
+            while ( _written < target ) {
+                if ( !_writtenCondition.timed_wait( lk.boost() , xt ) ) {
+                    warning() << "timed out waiting for profile entries to be written" << endl;
+                    return;
+                }
+            }
+        }
+
+        void ProfileWriter::run() {
+            Client::initThread( "profileWriter" );
+            while ( !inShutdown() ) {
+                Batch batch;
+                {
+                    scoped_lock lk( _m );
+                    if ( _queue.empty() ) {
+                        boost::xtime xt;
+                        boost::xtime_get( &xt, boost::TIME_UTC );
+                        xt.sec += 1;
+                        _queuedCondition.timed_wait( lk.boost() , xt );
+                    }
+                    batch.swap( _queue );
+                }
+                if ( batch.empty() )
+                    continue;
+
+                try {
+                    write( batch );
+                }
+                catch ( DBException& e ) {
+                    log() << "profile: failed writing " << batch.size() << " entries: " << e.toString() << endl;
+                }
+
+                scoped_lock lk( _m );
+                _written += batch.size();
+                _writtenCondition.notify_all();
+            }
+            cc().shutdown();
+        }
+
+        void ProfileWriter::write( const Batch& batch ) {
+            writelock lk;
+            for ( Batch::const_iterator i = batch.begin(); i != batch.end(); ) {
+                const string& ns = i->first;
+                if ( !dbHolder()._isLoaded( ns , dbpath ) ) {
+                    mongo::log() << "note: not profiling because db went away - probably a close on: " << ns << endl;
+                    while ( i != batch.end() && i->first == ns )
+                        ++i;
+                    continue;
+                }
+
+                Client::Context cx( ns, dbpath, false );
+                // write: not replicated
+                NamespaceDetails *d = cx.db()->namespaceIndex.details( ns.c_str() );
+                for ( ; i != batch.end() && i->first == ns; ++i ) {
+                    if( d ) {
+                        const BSONObj& p = i->second;
+                        int len = p.objsize();
+                        Record *r = theDataFileMgr.fast_oplog_insert( d, ns.c_str(), len );
+                        memcpy( getDur().writingPtr( r->data, len ), p.objdata(), len );
+                    }
+                    else { 
+                        static time_t last;
+                        if( time(0) > last+10 ) {
+                            log() << "profile: warning ns " << ns << " does not exist" << endl;
+                            last = time(0);
+                        }
+                    }
+                }
+            }
+        }
+
+    } // namespace
+
+    void ProfileSampling::setRate( double rate ) {
+        SimpleMutex::scoped_lock lk( samplingMutex );
+        sampleRate = rate;
+    }
+
+    double ProfileSampling::rate() {
+        SimpleMutex::scoped_lock lk( samplingMutex );
+        return sampleRate;
+    }
+
+    void ProfileSampling::setNamespaces( const string& db , const set<string>& namespaces ) {
+        SimpleMutex::scoped_lock lk( samplingMutex );
+        if ( namespaces.empty() )
+            sampledNamespaces.erase( db );
+        else
+            sampledNamespaces[ db ] = namespaces;
+    }
+
+    set<string> ProfileSampling::namespaces( const string& db ) {
+        SimpleMutex::scoped_lock lk( samplingMutex );
+        map< string, set<string> >::const_iterator i = sampledNamespaces.find( db );
+        return i == sampledNamespaces.end() ? set<string>() : i->second;
+    }
 
     void profile( const Client& c , CurOp& currentOp ) {
-        assertInWriteLock();
+        try {
+            queryPatternStats.record( currentOp.debug() );
+        }
+        catch ( DBException& e ) {
+            // a query the optimizer can't parse, it failed as the op's error already
+            LOG(1) << "profile: no query pattern: " << e.toString() << endl;
+        }
+
+        if ( !sampled( currentOp.getNS() ) )
+            return;
+
+        const string ns = nsToDatabase( currentOp.getNS() ) + ".system.profile";
 
-        Database *db = c.database();
-        DEV assert( db );
-        const char *ns = db->profileName.c_str();
-        
         // build object
-        profileBufBuilder.reset();
-        BSONObjBuilder b(profileBufBuilder);
+        BSONObjBuilder b;
         b.appendDate("ts", jsTime());
         currentOp.debug().append( currentOp , b );
 
@@ -47,7 +334,7 @@ namespace mongo {
         if ( c.getAuthenticationInfo() )
             b.append( "user" , c.getAuthenticationInfo()->getUser( nsToDatabase( ns ) ) );
 
-        BSONObj p = b.done();
+        BSONObj p = b.obj();
 
         if (p.objsize() > 100*1024){
             string small = p.toString(/*isArray*/false, /*full*/false);
@@ -55,7 +342,7 @@ namespace mongo {
             warning() << "can't add full line to system.profile: " << small;
 
             // rebuild with limited info
-            BSONObjBuilder b(profileBufBuilder);
+            BSONObjBuilder b;
             b.appendDate("ts", jsTime());
             b.append("client", c.clientAddress() );
             if ( c.getAuthenticationInfo() )
@@ -66,23 +353,31 @@ namespace mongo {
                 b.append("abbreviated", small);
             }
 
-            p = b.done();
+            p = b.obj();
         }
 
-        // write: not replicated
-        NamespaceDetails *d = db->namespaceIndex.details(ns);
-        if( d ) {
-            int len = p.objsize();
-            Record *r = theDataFileMgr.fast_oplog_insert(d, ns, len);
-            memcpy(getDur().writingPtr(r->data, len), p.objdata(), len);
+        profileWriter.push( ns , p );
+    }
+
+    void profileFlush() {
+        profileWriter.flush();
+    }
+
+    class CmdProfileStats : public Command {
+    public:
+        CmdProfileStats() : Command( "profileStats" ) {}
+        virtual bool slaveOk() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void help( stringstream& help ) const {
+            help << "totals of the profiled queries, updates and removes of this database by query pattern\n";
+            help << "{ profileStats : 1 [, reset : true] }";
         }
-        else { 
-            static time_t last;
-            if( time(0) > last+10 ) {
-                log() << "profile: warning ns " << ns << " does not exist" << endl;
-                last = time(0);
-            }
+        bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
+            queryPatternStats.append( dbname , result );
+            if ( cmdObj["reset"].trueValue() )
+                queryPatternStats.reset( dbname );
+            return true;
         }
-    }
+    } cmdProfileStats;
 
 } // namespace mongo
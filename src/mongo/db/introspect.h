@@ -29,6 +29,31 @@ namespace mongo {
        do when database->profile is set
     */
 
+    /**
+     * Adds currentOp to its query pattern's stats, then if it is sampled (see ProfileSampling)
+     * queues an entry for it to <db>.system.profile.  A background thread does the writes, so the
+     * caller needs no lock.
+     */
     void profile( const Client& c , CurOp& currentOp );
 
+    /**
+     * Waits until the entries queued so far are written, so a reader of system.profile sees them.
+     * Must be called without any lock held.
+     */
+    void profileFlush();
+
+    /**
+     * Sampling settings of the profiler, set with the profile command.  An op is profiled if it
+     * passes the rate, and its collection is in its database's filter if there is one.  The rate
+     * applies to all databases, like slowms.
+     */
+    struct ProfileSampling {
+        /** @param rate fraction of qualifying ops to profile, 0 to 1 */
+        static void setRate( double rate );
+        static double rate();
+        /** @param namespaces full names of the collections of db to profile; empty for all */
+        static void setNamespaces( const string& db , const set<string>& namespaces );
+        static set<string> namespaces( const string& db );
+    };
+
 } // namespace mongo
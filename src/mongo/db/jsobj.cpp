@@ -697,7 +697,7 @@ namespace mongo {
             BSONElement f = i.next();
             if ( f.eoo() )
                 return BSONElement();
-            if ( strcmp( f.fieldName(), fieldName ) == 0 )
+            if ( fieldNamesEqual( f.fieldName(), fieldName ) )
                 break;
             ++j;
         }
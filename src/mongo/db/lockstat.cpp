@@ -0,0 +1,165 @@
+// @file lockstat.cpp
+
+/**
+*    Copyright (C) 2012 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "pch.h"
+#include "lockstat.h"
+#include "jsobj.h"
+
+namespace mongo {
+
+    const char LockStat::Modes[LockStat::N] = { 'r', 'w', 'R', 'W' };
+
+    int LockStat::mapNo( char type ) {
+        switch( type ) {
+        case 'r': return 0;
+        case 'w': return 1;
+        case 'R': return 2;
+        case 'W': return 3;
+        default: return -1;
+        }
+    }
+
+    void LockStat::reset() {
+        for ( int i = 0; i < N; i++ ) {
+            _timeAcquiring[i] = 0;
+            _timeLocked[i] = 0;
+        }
+    }
+
+    void LockStat::recordAcquireTimeMicros( char type , long long micros ) {
+        int i = mapNo( type );
+        if ( i >= 0 )
+            _timeAcquiring[i] += micros;
+    }
+
+    void LockStat::recordLockTimeMicros( char type , long long micros ) {
+        int i = mapNo( type );
+        if ( i >= 0 )
+            _timeLocked[i] += micros;
+    }
+
+    void LockStat::add( const LockStat& other ) {
+        for ( int i = 0; i < N; i++ ) {
+            _timeAcquiring[i] += other._timeAcquiring[i];
+            _timeLocked[i] += other._timeLocked[i];
+        }
+    }
+
+    bool LockStat::empty() const {
+        return timeAcquiringMicros() == 0 && timeLockedMicros() == 0;
+    }
+
+    long long LockStat::timeAcquiringMicros() const {
+        long long t = 0;
+        for ( int i = 0; i < N; i++ )
+            t += _timeAcquiring[i];
+        return t;
+    }
+
+    long long LockStat::timeLockedMicros() const {
+        long long t = 0;
+        for ( int i = 0; i < N; i++ )
+            t += _timeLocked[i];
+        return t;
+    }
+
+    static void appendModes( BSONObjBuilder& b , const char* name , const char* modes , const long long* times , int n ) {
+        BSONObjBuilder bb( b.subobjStart( name ) );
+        for ( int i = 0; i < n; i++ ) {
+            if ( times[i] ) {
+                char m[2] = { modes[i], 0 };
+                bb.appendNumber( m , times[i] );
+            }
+        }
+        bb.done();
+    }
+
+    void LockStat::append( BSONObjBuilder& b ) const {
+        appendModes( b , "timeLockedMicros" , Modes , _timeLocked , N );
+        appendModes( b , "timeAcquiringMicros" , Modes , _timeAcquiring , N );
+    }
+
+    void LockStat::appendTimes( StringBuilder& s , const char* prefix , bool locked ) const {
+        const long long* times = locked ? _timeLocked : _timeAcquiring;
+        for ( int i = 0; i < N; i++ )
+            if ( times[i] )
+                s << ' ' << prefix << Modes[i] << ':' << times[i];
+    }
+
+    const char LockStats::Global[] = ".";
+
+    void LockStats::recordAcquireTimeMicros( const char* db , char type , long long micros ) {
+        scoped_spinlock lk( _lock );
+        _stats[db].recordAcquireTimeMicros( type , micros );
+    }
+
+    void LockStats::recordLockTimeMicros( const char* db , char type , long long micros ) {
+        scoped_spinlock lk( _lock );
+        _stats[db].recordLockTimeMicros( type , micros );
+    }
+
+    void LockStats::add( const LockStats& other ) {
+        // copy first, so the two locks are never held together
+        map<string,LockStat> theirs;
+        {
+            scoped_spinlock lk( other._lock );
+            theirs = other._stats;
+        }
+        scoped_spinlock lk( _lock );
+        for ( map<string,LockStat>::const_iterator i = theirs.begin(); i != theirs.end(); ++i )
+            _stats[i->first].add( i->second );
+    }
+
+    void LockStats::reset() {
+        scoped_spinlock lk( _lock );
+        _stats.clear();
+    }
+
+    bool LockStats::empty() const {
+        scoped_spinlock lk( _lock );
+        for ( map<string,LockStat>::const_iterator i = _stats.begin(); i != _stats.end(); ++i )
+            if ( ! i->second.empty() )
+                return false;
+        return true;
+    }
+
+    void LockStats::append( BSONObjBuilder& b ) const {
+        scoped_spinlock lk( _lock );
+        for ( map<string,LockStat>::const_iterator i = _stats.begin(); i != _stats.end(); ++i ) {
+            BSONObjBuilder bb( b.subobjStart( i->first ) );
+            i->second.append( bb );
+            bb.done();
+        }
+    }
+
+    string LockStats::toString() const {
+        if ( empty() )
+            return "";
+        scoped_spinlock lk( _lock );
+        StringBuilder s;
+        for ( int locked = 1; locked >= 0; locked-- ) {
+            s << ( locked ? " locked(micros)" : " acquiring(micros)" );
+            for ( map<string,LockStat>::const_iterator i = _stats.begin(); i != _stats.end(); ++i ) {
+                string prefix = i->first == Global ? "" : i->first + ".";
+                i->second.appendTimes( s , prefix.c_str() , locked );
+            }
+        }
+        return s.str();
+    }
+
+}
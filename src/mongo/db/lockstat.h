@@ -0,0 +1,85 @@
+// @file lockstat.h
+
+/**
+*    Copyright (C) 2012 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include "../util/concurrency/spin_lock.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class StringBuilder;
+
+    /**
+     * Time spent acquiring and holding one lock, by lock mode: r, w, R and W for the global lock,
+     * r and w for the lock of a database.
+     */
+    class LockStat {
+    public:
+        LockStat() { reset(); }
+        void reset();
+
+        void recordAcquireTimeMicros( char type , long long micros );
+        void recordLockTimeMicros( char type , long long micros );
+        void add( const LockStat& other );
+
+        bool empty() const;
+        long long timeAcquiringMicros() const;
+        long long timeLockedMicros() const;
+
+        /** appends { timeLockedMicros : { r : .. , w : .. , R : .. , W : .. } , timeAcquiringMicros : { .. } } */
+        void append( BSONObjBuilder& b ) const;
+        /** eg " r:120" for the locked (or acquiring) times of log lines, each mode prefixed by prefix */
+        void appendTimes( StringBuilder& s , const char* prefix , bool locked ) const;
+
+    private:
+        enum { N = 4 };
+        static const char Modes[N];
+        static int mapNo( char type );
+
+        long long _timeAcquiring[N];
+        long long _timeLocked[N];
+    };
+
+    /**
+     * Lock stats keyed by database, with the global lock under Global ("."). The owner's thread
+     * records while others (currentOp, serverStatus) read, so all access takes _lock.
+     */
+    class LockStats : boost::noncopyable {
+    public:
+        static const char Global[];
+
+        /** @param db the database whose lock it was, or Global */
+        void recordAcquireTimeMicros( const char* db , char type , long long micros );
+        void recordLockTimeMicros( const char* db , char type , long long micros );
+        void add( const LockStats& other );
+
+        void reset();
+        bool empty() const;
+
+        /** appends { "." : <LockStat> , <db> : <LockStat> , .. } */
+        void append( BSONObjBuilder& b ) const;
+        /** eg " locked(micros) R:120 test.w:30 acquiring(micros) test.w:3" for log lines, nothing if empty */
+        string toString() const;
+
+    private:
+        mutable SpinLock _lock;
+        map<string,LockStat> _stats;
+    };
+
+}
@@ -160,6 +160,7 @@ namespace mongo {
                 _myset->insert(ie);
             }
         }
+        _inValues.assign( _myset->begin(), _myset->end() );
 
         if ( _allMatchers.size() ) {
             uassert( 13020 , "with $all, can't mix $elemMatch and others" , _myset->size() == 0 && !_myregex.get());
@@ -343,7 +344,8 @@ namespace mongo {
         uassert( 10067 , "$where query, but no script engine", globalScriptEngine );
         massert( 13089 , "no current client needed for $where" , haveClient() );
         _where = new Where();
-        _where->scope = globalScriptEngine->getPooledScope( cc().ns() );
+        // pooled by database, like group and mapReduce, so they share warm scopes
+        _where->scope = globalScriptEngine->getPooledScope( cc().database()->name );
         _where->scope->localConnect( cc().database()->name.c_str() );
             
         if ( e.type() == CodeWScope ) {
@@ -457,6 +459,7 @@ namespace mongo {
         while ( i.more() ) {
             parseMatchExpressionElement( i.next(), nested );
         }
+        compile();
     }
 
     Matcher::Matcher( const Matcher &docMatcher, const BSONObj &key ) :
@@ -510,6 +513,109 @@ namespace mongo {
         for( list< shared_ptr< Matcher > >::const_iterator i = docMatcher._orMatchers.begin(); i != docMatcher._orMatchers.end(); ++i ) {
             _orMatchers.push_back( shared_ptr< Matcher >( new Matcher( **i, key ) ) );
         }
+        compile();
+    }
+
+    /**
+     * Rough rank of a basic predicate by cost and selectivity: equalities on scalars are cheap and usually
+     * narrow, negations usually match, and $all / $elemMatch walk arrays.
+     */
+    static int basicRank( const ElementMatcher &bm ) {
+        switch( bm._compareOp ) {
+        case BSONObj::Equality:
+            return bm._toMatch.isABSONObj() ? 2 : 0;
+        case BSONObj::opIN:
+            return 1;
+        case BSONObj::LT:
+        case BSONObj::LTE:
+        case BSONObj::GT:
+        case BSONObj::GTE:
+            return 2;
+        case BSONObj::opMOD:
+        case BSONObj::opTYPE:
+        case BSONObj::opSIZE:
+        case BSONObj::opEXISTS:
+            return 3;
+        case BSONObj::NE:
+        case BSONObj::NIN:
+            return 4;
+        default:
+            return 5;
+        }
+    }
+
+    class BasicRankLess {
+    public:
+        BasicRankLess( const vector<ElementMatcher> &basics ) : _basics( basics ) {}
+        bool operator()( unsigned l, unsigned r ) const {
+            return basicRank( _basics[ l ] ) < basicRank( _basics[ r ] );
+        }
+    private:
+        const vector<ElementMatcher> &_basics;
+    };
+
+    void Matcher::compile() {
+        _basicsOrder.clear();
+        for( unsigned i = 0; i < _basics.size(); ++i ) {
+            _basicsOrder.push_back( i );
+        }
+        stable_sort( _basicsOrder.begin(), _basicsOrder.end(), BasicRankLess( _basics ) );
+
+        _topFields.clear();
+        _basicsTopField.assign( _basics.size(), -1 );
+        memset( _topFirstChars, 0, sizeof( _topFirstChars ) );
+
+        // Index keys are matched with getFieldUsingIndexNames(), and a lone predicate gains nothing.
+        if ( _basics.size() < 2 || !_constrainIndexKey.isEmpty() ) {
+            return;
+        }
+
+        set< string > names;
+        for( unsigned i = 0; i < _basics.size(); ++i ) {
+            if ( _basics[ i ]._compareOp == BSONObj::opALL )
+                continue; // looks up its whole path itself
+            const char *fieldName = _basics[ i ]._toMatch.fieldName();
+            const char *p = strchr( fieldName, '.' );
+            names.insert( p ? string( fieldName, p - fieldName ) : string( fieldName ) );
+        }
+        if ( names.empty() || names.size() > MaxTopFields ) {
+            return;
+        }
+
+        _topFields.assign( names.begin(), names.end() );
+        for( unsigned i = 0; i < _basics.size(); ++i ) {
+            if ( _basics[ i ]._compareOp == BSONObj::opALL )
+                continue;
+            const char *fieldName = _basics[ i ]._toMatch.fieldName();
+            const char *p = strchr( fieldName, '.' );
+            string top = p ? string( fieldName, p - fieldName ) : string( fieldName );
+            _basicsTopField[ i ] = lower_bound( _topFields.begin(), _topFields.end(), top ) - _topFields.begin();
+        }
+        for( vector< string >::const_iterator i = _topFields.begin(); i != _topFields.end(); ++i ) {
+            unsigned char c = (*i)[ 0 ];
+            _topFirstChars[ c >> 5 ] |= 1u << ( c & 31 );
+        }
+    }
+
+    void Matcher::resolveTopFields( const BSONObj &obj, BSONElement *fields ) const {
+        unsigned remaining = _topFields.size();
+        BSONObjIterator i( obj );
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            const char *name = e.fieldName();
+            unsigned char c = name[ 0 ];
+            if ( !( _topFirstChars[ c >> 5 ] & ( 1u << ( c & 31 ) ) ) )
+                continue;
+            vector< string >::const_iterator j = lower_bound( _topFields.begin(), _topFields.end(), name );
+            if ( j == _topFields.end() || j->compare( name ) != 0 )
+                continue;
+            BSONElement &f = fields[ j - _topFields.begin() ];
+            if ( !f.eoo() )
+                continue; // getField() returns the first of duplicate fields
+            f = e;
+            if ( --remaining == 0 )
+                break;
+        }
     }
 
     inline bool regexMatches(const RegexMatcher& rm, const BSONElement& e) {
@@ -536,9 +642,8 @@ namespace mongo {
 
         if ( op == BSONObj::opIN ) {
             // { $in : [1,2,3] }
-            int count = bm._myset->count(l);
-            if ( count )
-                return count;
+            if ( binary_search( bm._inValues.begin(), bm._inValues.end(), l, element_lt() ) )
+                return 1;
             if ( bm._myregex.get() ) {
                 for( vector<RegexMatcher>::const_iterator i = bm._myregex->begin(); i != bm._myregex->end(); ++i ) {
                     if ( regexMatches( *i, l ) ) {
@@ -583,8 +688,8 @@ namespace mongo {
         return (op & z);
     }
 
-    int Matcher::inverseMatch(const char *fieldName, const BSONElement &toMatch, const BSONObj &obj, const ElementMatcher& bm , MatchDetails * details ) const {
-        int inverseRet = matchesDotted( fieldName, toMatch, obj, bm.inverseOfNegativeCompareOp(), bm , false , details );
+    int Matcher::inverseMatch(const char *fieldName, const BSONElement &toMatch, const BSONObj &obj, const ElementMatcher& bm , MatchDetails * details , const BSONElement *top ) const {
+        int inverseRet = matchesDotted( fieldName, toMatch, obj, bm.inverseOfNegativeCompareOp(), bm , false , details , top );
         if ( bm.negativeCompareOpContainsNull() ) {
             return ( inverseRet <= 0 ) ? 1 : 0;
         }
@@ -602,6 +707,7 @@ namespace mongo {
        obj       - database object to check against
        compareOp - Equality, LT, GT, etc.  This may be different than, and should supersede, the compare op in em. 
        isArr     -
+       top       - if set, the element of obj named by the first component of fieldName, already looked up
 
        Special forms:
 
@@ -614,7 +720,7 @@ namespace mongo {
         0 missing element
         1 match
     */
-    int Matcher::matchesDotted(const char *fieldName, const BSONElement& toMatch, const BSONObj& obj, int compareOp, const ElementMatcher& em , bool isArr, MatchDetails * details ) const {
+    int Matcher::matchesDotted(const char *fieldName, const BSONElement& toMatch, const BSONObj& obj, int compareOp, const ElementMatcher& em , bool isArr, MatchDetails * details , const BSONElement *top ) const {
         DEBUGMATCHER( "\t matchesDotted : " << fieldName << " hasDetails: " << ( details ? "yes" : "no" ) );
 
         if ( compareOp == BSONObj::opALL ) {
@@ -683,7 +789,7 @@ namespace mongo {
         } // end opALL
 
         if ( compareOp == BSONObj::NE || compareOp == BSONObj::NIN ) {
-            return inverseMatch( fieldName, toMatch, obj, em , details );
+            return inverseMatch( fieldName, toMatch, obj, em , details , top );
         }
 
         BSONElement e;
@@ -701,9 +807,7 @@ namespace mongo {
 
             const char *p = strchr(fieldName, '.');
             if ( p ) {
-                string left(fieldName, p-fieldName);
-
-                BSONElement se = obj.getField(left.c_str());
+                BSONElement se = top ? *top : obj.getField( string( fieldName, p-fieldName ).c_str() );
                 if ( se.eoo() )
                     ;
                 else if ( se.type() != Object && se.type() != Array )
@@ -755,7 +859,7 @@ namespace mongo {
                 return 0;
             }
             else {
-                e = obj.getField(fieldName);
+                e = top ? *top : obj.getField(fieldName);
             }
         }
 
@@ -829,15 +933,23 @@ namespace mongo {
 
         LOG(5) << "Matcher::matches() " << jsobj.toString() << endl;
 
-        /* assuming there is usually only one thing to match.  if more this
-           could be slow sometimes. */
+        // Look up the top level fields of all the basic predicates in one pass over the document, instead of
+        // walking it once per predicate.
+        BSONElement topFields[ MaxTopFields ];
+        if ( !_topFields.empty() ) {
+            resolveTopFields( jsobj, topFields );
+        }
 
         // check normal non-regex cases:
         for ( unsigned i = 0; i < _basics.size(); i++ ) {
-            const ElementMatcher& bm = _basics[i];
+            // Cheapest predicates first, unless the caller wants to know which array element matched: then the
+            // first predicate in the query to match one has to be the one reporting it.
+            unsigned b = details ? i : _basicsOrder[i];
+            const ElementMatcher& bm = _basics[b];
             const BSONElement& m = bm._toMatch;
+            const BSONElement *top = _basicsTopField[b] < 0 ? 0 : &topFields[ _basicsTopField[b] ];
             // -1=mismatch. 0=missing element. 1=match
-            int cmp = matchesDotted(m.fieldName(), m, jsobj, bm._compareOp, bm , false , details );
+            int cmp = matchesDotted(m.fieldName(), m, jsobj, bm._compareOp, bm , false , details , top );
             if ( cmp == 0 && bm._compareOp == BSONObj::opEXISTS ) {
                 // If missing, match cmp is opposite of $exists spec.
                 cmp = -retExistsFound(bm);
@@ -1162,6 +1274,53 @@ namespace mongo {
     }
 
 
+    /** @return true if a key element equal to v has the same meaning as the array element it came from */
+    static bool keyMatchableValue( const BSONElement &v ) {
+        return v.type() != Array && v.type() != jstNULL && v.type() != Undefined;
+    }
+
+    bool Matcher::multikeyKeyMatch() const {
+        if ( _where || !_regexs.empty() || !_andMatchers.empty() || !_orMatchers.empty() ||
+                !_norMatchers.empty() || !_orDedupConstraints.empty() ) {
+            return false;
+        }
+        set<string> topFields;
+        for ( vector<ElementMatcher>::const_iterator i = _basics.begin(); i != _basics.end(); ++i ) {
+            if ( i->_isNot ) {
+                return false;
+            }
+            switch( i->_compareOp ) {
+            case BSONObj::Equality:
+            case BSONObj::LT:
+            case BSONObj::LTE:
+            case BSONObj::GT:
+            case BSONObj::GTE:
+                if ( !keyMatchableValue( i->_toMatch ) ) {
+                    return false;
+                }
+                break;
+            case BSONObj::opIN:
+                if ( i->_myregex && !i->_myregex->empty() ) {
+                    return false;
+                }
+                for ( vector<BSONElement>::const_iterator j = i->_inValues.begin(); j != i->_inValues.end(); ++j ) {
+                    if ( !keyMatchableValue( *j ) ) {
+                        return false;
+                    }
+                }
+                break;
+            default:
+                return false;
+            }
+            // { 'a.b' : 1, 'a.c' : 2 } may be satisfied by two different elements of array a, which no
+            // single key holds together
+            if ( !topFields.insert( mongoutils::str::before( i->_toMatch.fieldName(), '.' ) ).second ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     /*- just for testing -- */
 #pragma pack(1)
     struct JSObj1 {
@@ -71,6 +71,7 @@ namespace mongo {
         int _compareOp;
         bool _isNot;
         shared_ptr< set<BSONElement,element_lt> > _myset;
+        vector<BSONElement> _inValues; // _myset as a sorted flat array, for $in lookups
         shared_ptr< vector<RegexMatcher> > _myregex;
 
         // these are for specific operators
@@ -123,10 +124,14 @@ namespace mongo {
        TODO: we should rewrite the matcher to be more an AST style.
     */
     class Matcher : boost::noncopyable {
+        /**
+         * @param top if set, the already looked up element of obj named by the first component of fieldName
+         */
         int matchesDotted(
             const char *fieldName,
             const BSONElement& toMatch, const BSONObj& obj,
-            int compareOp, const ElementMatcher& bm, bool isArr , MatchDetails * details ) const;
+            int compareOp, const ElementMatcher& bm, bool isArr , MatchDetails * details ,
+            const BSONElement *top = 0 ) const;
 
         /**
          * Perform a NE or NIN match by returning the inverse of the opposite matching operation.
@@ -135,7 +140,7 @@ namespace mongo {
         int inverseMatch(
             const char *fieldName,
             const BSONElement &toMatch, const BSONObj &obj,
-            const ElementMatcher&bm, MatchDetails * details ) const;
+            const ElementMatcher&bm, MatchDetails * details , const BSONElement *top ) const;
 
     public:
         static int opDirection(int op) {
@@ -188,6 +193,13 @@ namespace mongo {
          * value as the provided doc matcher.
          */
         bool keyMatch( const Matcher &docMatcher ) const;
+
+        /**
+         * @return true if, where keyMatch() holds, matching the single keys of a multikey index gives the
+         * same answer as matching the document: each predicate is a plain comparison on a path of its own,
+         * so the key holding the array element that satisfies it is the one the index scan presents.
+         */
+        bool multikeyKeyMatch() const;
         
         bool singleSimpleCriterion() const {
             return false; // TODO SERVER-958
@@ -218,6 +230,12 @@ namespace mongo {
 
         int valuesMatch(const BSONElement& l, const BSONElement& r, int op, const ElementMatcher& bm) const;
 
+        /** Plans the evaluation of _basics, see the members below. Called once _basics is complete. */
+        void compile();
+
+        /** Looks up every field of _topFields in a single pass over obj. */
+        void resolveTopFields( const BSONObj &obj, BSONElement *fields ) const;
+
         bool parseClause( const BSONElement &e );
         void parseExtractedClause( const BSONElement &e, list< shared_ptr< Matcher > > &matchers );
 
@@ -242,6 +260,13 @@ namespace mongo {
 
         vector<RegexMatcher> _regexs;
 
+        // evaluation plan for _basics, filled in by compile()
+        enum { MaxTopFields = 16 };
+        vector<unsigned> _basicsOrder;    // cheap and selective predicates first
+        vector<string> _topFields;        // sorted top level field names of _basics, looked up together
+        vector<int> _basicsTopField;      // position in _topFields of each basic's top level field, or -1
+        unsigned _topFirstChars[8];       // bitmap of the first characters of _topFields
+
         // so we delete the mem when we're done:
         vector< shared_ptr< BSONObjBuilder > > _builders;
         list< shared_ptr< Matcher > > _andMatchers;
@@ -292,6 +317,7 @@ namespace mongo {
         Matcher _keyMatcher;
 
         bool _needRecord; // if the key itself isn't good enough to determine a positive match
+        bool _multikeyKeyMatch; // if the key is good enough even when the index is multikey
     };
 
 } // namespace mongo
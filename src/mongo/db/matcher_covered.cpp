@@ -47,14 +47,28 @@ namespace mongo {
         _needRecord =
             alwaysUseRecord ||
 	        !_keyMatcher.keyMatch( *_docMatcher );
+        _multikeyKeyMatch = !_needRecord && _docMatcher->multikeyKeyMatch();
+    }
+
+    /** an element of a nested array is indexed as the whole inner array, which the matcher would descend into */
+    static bool hasArrayElement( const BSONObj &key ) {
+        BSONObjIterator i( key );
+        while( i.more() ) {
+            if ( i.next().type() == Array ) {
+                return true;
+            }
+        }
+        return false;
     }
 
     bool CoveredIndexMatcher::matchesCurrent( Cursor * cursor , MatchDetails * details ) {
         // bool keyUsable = ! cursor->isMultiKey() && check for $orish like conditions in matcher SERVER-1264
-        return matches( cursor->currKey() , cursor->currLoc() , details ,
-                       !cursor->indexKeyPattern().isEmpty() // unindexed cursor
-                       && !cursor->isMultiKey() // multikey cursor
-                       );
+        bool keyUsable = !cursor->indexKeyPattern().isEmpty(); // unindexed cursor
+        if ( keyUsable && cursor->isMultiKey() ) {
+            // the caller dedups, so a document matching through several of its keys is still counted once
+            keyUsable = _multikeyKeyMatch && !hasArrayElement( cursor->currKey() );
+        }
+        return matches( cursor->currKey() , cursor->currLoc() , details , keyUsable );
     }
 
     bool CoveredIndexMatcher::matches(const BSONObj &key, const DiskLoc &recLoc , MatchDetails * details , bool keyUsable ) {
@@ -89,6 +103,8 @@ namespace mongo {
         
         if ( _needRecord )
             buf << "needRecord ";
+        else if ( _multikeyKeyMatch )
+            buf << "multikeyKeyMatch ";
         
         buf << "keyMatcher: " << _keyMatcher.toString() << " ";
         
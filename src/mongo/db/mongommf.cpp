@@ -305,7 +305,67 @@ namespace mongo {
         return false;
     }
 
-    MongoMMF::MongoMMF() : _willNeedRemap(false) {
+    AtomicUInt MongoMMF::_totalDirty;
+
+    void MongoMMF::noteDirty(unsigned long long ofs, unsigned len) {
+        if( len == 0 )
+            return;
+        unsigned first = (unsigned) (ofs / DirtyChunkSize);
+        unsigned last = (unsigned) ((ofs + len - 1) / DirtyChunkSize);
+        SimpleMutex::scoped_lock lk(_dirtyMutex);
+        for( unsigned c = first; c <= last; c++ ) {
+            if( _dirty.insert(c).second )
+                _totalDirty++;
+        }
+    }
+
+    unsigned MongoMMF::_flushDirty(unsigned maxChunks) {
+        unsigned n = 0;
+        while( n < maxChunks ) {
+            unsigned c;
+            {
+                SimpleMutex::scoped_lock lk(_dirtyMutex);
+                if( _dirty.empty() )
+                    break;
+                c = *_dirty.begin();
+                _dirty.erase(_dirty.begin());
+                _totalDirty--;
+            }
+            // a write after the erase marks the chunk again, so nothing is missed
+            flushRange((unsigned long long) c * DirtyChunkSize, DirtyChunkSize);
+            n++;
+        }
+        return n;
+    }
+
+    void MongoMMF::_clearDirty() {
+        SimpleMutex::scoped_lock lk(_dirtyMutex);
+        _totalDirty.signedAdd(-(int)_dirty.size());
+        _dirty.clear();
+    }
+
+    /*static*/ unsigned MongoMMF::flushSomeDirty(unsigned maxChunks) {
+        // shared: files can't close under us, WRITETODATAFILES can go on
+        LockMongoFilesShared lk;
+        unsigned n = 0;
+        set<MongoFile*>& files = MongoFile::getAllFiles();
+        for( set<MongoFile*>::iterator i = files.begin(); i != files.end() && n < maxChunks; i++ ) {
+            if( (*i)->isMongoMMF() )
+                n += ((MongoMMF*) *i)->_flushDirty(maxChunks - n);
+        }
+        return n;
+    }
+
+    /*static*/ void MongoMMF::clearAllDirty() {
+        LockMongoFilesShared lk;
+        set<MongoFile*>& files = MongoFile::getAllFiles();
+        for( set<MongoFile*>::iterator i = files.begin(); i != files.end(); i++ ) {
+            if( (*i)->isMongoMMF() )
+                ((MongoMMF*) *i)->_clearDirty();
+        }
+    }
+
+    MongoMMF::MongoMMF() : _dirtyMutex("MongoMMF::dirty"), _willNeedRemap(false) {
         _view_write = _view_private = 0;
     }
 
@@ -340,6 +400,7 @@ namespace mongo {
         }
 
         LockMongoFilesExclusive lk;
+        _clearDirty();
         privateViews.remove(_view_private);
         memconcept::invalidate(_view_private);
         _view_write = _view_private = 0;
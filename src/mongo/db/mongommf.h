@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include "../bson/util/atomic_int.h"
 #include "../util/mmap.h"
 #include "../util/paths.h"
 
@@ -92,7 +93,30 @@ namespace mongo {
 
         virtual bool isMongoMMF() { return true; }
 
+        /** granularity of the dirty region tracking for continuous flushing */
+        static const unsigned DirtyChunkSize = 1024 * 1024;
+
+        /** note that WRITETODATAFILES wrote [ofs, ofs+len) of view_write(), see flushSomeDirty() */
+        void noteDirty(unsigned long long ofs, unsigned len);
+
+        /** write back up to maxChunks dirty chunks of the open files, waiting for each.
+            @return number of chunks written
+        */
+        static unsigned flushSomeDirty(unsigned maxChunks);
+
+        /** forget the dirty chunks, as a full flushAll() is about to write them anyway */
+        static void clearAllDirty();
+
+        /** dirty chunks of all files not yet written back */
+        static unsigned dirtyChunks() { return _totalDirty.get(); }
+
     private:
+        unsigned _flushDirty(unsigned maxChunks);
+        void _clearDirty();
+
+        SimpleMutex _dirtyMutex;
+        set<unsigned> _dirty;   // chunk numbers, ofs / DirtyChunkSize
+        static AtomicUInt _totalDirty;
 
         void *_view_write;
         void *_view_private;
@@ -24,6 +24,123 @@
 #include "../queryutil.h"
 
 namespace mongo {
+
+    /** most buckets rangeCountFromIndex() visits, about what a cursor scans before it first yields */
+    static const int RangeCountMaxBuckets = 256;
+
+    /**
+     * @return true if every value between two bounds of e's canonical type compares the same way
+     * in the index as in the matcher, so a key range holds exactly the matching values.
+     */
+    static bool rangeCountableValue( const BSONElement &e ) {
+        switch( e.type() ) {
+        case NumberDouble:
+            return e.number() == e.number(); // not NaN
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case Date:
+        case jstOID:
+        case Bool:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /** @return the index order bound of the range with first key field 'first', other fields filled */
+    static BSONObj rangeBoundKey( const BSONObj &keyPattern, const BSONElement &first, bool fillLow ) {
+        BSONObjBuilder b;
+        b.appendAs( first, "" );
+        BSONObjIterator i( keyPattern );
+        i.next();
+        while( i.more() ) {
+            bool ascending = i.next().number() >= 0;
+            if ( fillLow == ascending )
+                b.appendMinKey( "" );
+            else
+                b.appendMaxKey( "" );
+        }
+        return b.obj();
+    }
+
+    /**
+     * Counts a query made of a single equality or two sided range on the first field of a btree
+     * index from the btree structure, without a cursor, matcher or dedup set.  Only applies when
+     * the index entries are exactly the matching documents: the index is not multikey and the
+     * bounds are of one type whose index order is the matcher's.
+     * The btree is walked under the read lock without yielding, so the walk is bounded to
+     * RangeCountMaxBuckets buckets; larger ranges are left to the yielding cursor path.
+     * @param maxCount if > 0, the count stops at this many keys
+     * @return false if the query doesn't qualify or the range is too large.
+     */
+    static bool rangeCountFromIndex( NamespaceDetails *d, const BSONObj &query, long long maxCount,
+                                     long long &count ) {
+        if ( query.nFields() != 1 )
+            return false;
+        BSONElement e = query.firstElement();
+        if ( e.fieldName()[ 0 ] == '$' )
+            return false;
+
+        BSONElement low, high;
+        bool lowInclusive = true, highInclusive = true;
+        if ( e.type() == Object && e.embeddedObject().firstElementFieldName()[ 0 ] == '$' ) {
+            BSONObjIterator i( e.embeddedObject() );
+            while( i.more() ) {
+                BSONElement op = i.next();
+                switch( op.getGtLtOp() ) {
+                case BSONObj::GT:
+                case BSONObj::GTE:
+                    if ( !low.eoo() )
+                        return false;
+                    low = op;
+                    lowInclusive = op.getGtLtOp() == BSONObj::GTE;
+                    break;
+                case BSONObj::LT:
+                case BSONObj::LTE:
+                    if ( !high.eoo() )
+                        return false;
+                    high = op;
+                    highInclusive = op.getGtLtOp() == BSONObj::LTE;
+                    break;
+                default:
+                    return false;
+                }
+            }
+        }
+        else {
+            low = high = e;
+        }
+        // a one sided range would need type bracketing the index doesn't do
+        if ( low.eoo() || high.eoo() || !rangeCountableValue( low ) || !rangeCountableValue( high ) ||
+            low.canonicalType() != high.canonicalType() )
+            return false;
+
+        for( int i = 0; i < d->nIndexes; ++i ) {
+            IndexDetails &idx = d->idx( i );
+            BSONObj keyPattern = idx.keyPattern();
+            // v0 indexes order dates differently from the matcher
+            if ( idx.version() < 1 || idx.getSpec().getType() || d->isMultikey( i ) ||
+                strcmp( keyPattern.firstElementFieldName(), e.fieldName() ) != 0 )
+                continue;
+
+            bool ascending = keyPattern.firstElement().number() >= 0;
+            BSONElement start = ascending ? low : high;
+            BSONElement end = ascending ? high : low;
+            bool startInclusive = ascending ? lowInclusive : highInclusive;
+            bool endInclusive = ascending ? highInclusive : lowInclusive;
+            count = idx.idxInterface().countRange( idx.head,
+                                                   rangeBoundKey( keyPattern, start, startInclusive ),
+                                                   startInclusive,
+                                                   rangeBoundKey( keyPattern, end, !endInclusive ),
+                                                   endInclusive,
+                                                   Ordering::make( keyPattern ),
+                                                   maxCount,
+                                                   RangeCountMaxBuckets );
+            return count >= 0;
+        }
+        return false;
+    }
     
     long long runCount( const char *ns, const BSONObj &cmd, string &err ) {
         Client::Context cx(ns);
@@ -43,13 +160,25 @@ namespace mongo {
         long long count = 0;
         long long skip = cmd["skip"].numberLong();
         long long limit = cmd["limit"].numberLong();
-        bool simpleEqualityMatch = false;
-        shared_ptr<Cursor> cursor =
-        NamespaceDetailsTransient::getCursor( ns, query, BSONObj(), QueryPlanSelectionPolicy::any(),
-                                             &simpleEqualityMatch );
-        ClientCursor::CleanupPointer ccPointer;
-        ElapsedTracker timeToStartYielding( 256, 20 );
+
         try {
+            if ( rangeCountFromIndex( d, query, limit > 0 ? skip + limit : 0, count ) ) {
+                if ( skip > 0 ) {
+                    count = count > skip ? count - skip : 0;
+                }
+                if ( limit > 0 && count > limit ) {
+                    count = limit;
+                }
+                return count;
+            }
+            count = 0;
+
+            bool simpleEqualityMatch = false;
+            shared_ptr<Cursor> cursor =
+            NamespaceDetailsTransient::getCursor( ns, query, BSONObj(), QueryPlanSelectionPolicy::any(),
+                                                 &simpleEqualityMatch );
+            ClientCursor::CleanupPointer ccPointer;
+            ElapsedTracker timeToStartYielding( 256, 20 );
             while( cursor->ok() ) {
                 if ( !ccPointer ) {
                     if ( timeToStartYielding.intervalHasElapsed() ) {
@@ -20,6 +20,7 @@
 #include "delete.h"
 #include "../queryutil.h"
 #include "../oplog.h"
+#include "../pagefault.h"
 
 namespace mongo {
     
@@ -106,6 +107,9 @@ namespace mongo {
 
             assert( !dup ); // can't be a dup, we deleted it!
 
+            // before the first write, so the first record to delete can be faulted in unlocked
+            checkWriteFault( rloc.rec() );
+
             if ( !justOne ) {
                 /* NOTE: this is SLOW.  this is not good, noteLocation() was designed to be called across getMore
                     blocks.  here we might call millions of times which would be bad.
@@ -296,6 +296,7 @@ namespace mongo {
     _cursor( cursor ),
     _queryOptimizerCursor( dynamic_pointer_cast<QueryOptimizerCursor>( _cursor ) ),
     _buf( buf ),
+    _matchNeededRecord(),
     _planKeyFieldsOnly( queryPlan._keyFieldsOnly ) {
     }
 
@@ -321,6 +322,27 @@ namespace mongo {
         return ret;
     }
 
+    bool ResponseBuildStrategy::currentNeedsRecord( bool allowCovered ) const {
+        if ( _parsedQuery.returnKey() ) {
+            return false;
+        }
+        return !( allowCovered && keyFieldsOnly() );
+    }
+
+    bool ResponseBuildStrategy::orderCovered() const {
+        const Projection::KeyOnly *fields = keyFieldsOnly();
+        if ( !fields ) {
+            return false;
+        }
+        BSONObjIterator i( _parsedQuery.getOrder() );
+        while( i.more() ) {
+            if ( !fields->includes( i.next().fieldName() ) ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     const Projection::KeyOnly *ResponseBuildStrategy::keyFieldsOnly() const {
         if ( !_parsedQuery.getFields() ) {
             return 0;
@@ -341,6 +363,7 @@ namespace mongo {
     }
     
     bool OrderedBuildStrategy::handleMatch( bool &orderedMatch ) {
+        _matchNeededRecord = false;
         DiskLoc loc = _cursor->currLoc();
         if ( _cursor->getsetdup( loc ) ) {
             return orderedMatch = false;
@@ -349,6 +372,7 @@ namespace mongo {
             --_skip;
             return orderedMatch = false;
         }
+        _matchNeededRecord = currentNeedsRecord( true );
         // Explain does not obey soft limits, so matches should not be buffered.
         if ( !_parsedQuery.isExplain() ) {
             fillQueryResultFromObj( _buf, _parsedQuery.getFields(), current( true ),
@@ -369,6 +393,7 @@ namespace mongo {
 
     bool ReorderBuildStrategy::handleMatch( bool &orderedMatch ) {
         orderedMatch = false;
+        _matchNeededRecord = false;
         if ( _cursor->getsetdup( _cursor->currLoc() ) ) {
             return false;
         }
@@ -378,7 +403,11 @@ namespace mongo {
     
     void ReorderBuildStrategy::_handleMatchNoDedup() {
         DiskLoc loc = _cursor->currLoc();
-        _scanAndOrder->add( current( false ), _parsedQuery.showDiskLoc() ? &loc : 0 );
+        // the buffered documents are sorted on their own fields, so the index key will only do
+        // if the projection keeps every sort field
+        bool covered = orderCovered();
+        _matchNeededRecord = currentNeedsRecord( covered );
+        _scanAndOrder->add( current( covered ), _parsedQuery.showDiskLoc() ? &loc : 0 );
     }
 
     int ReorderBuildStrategy::rewriteMatches() {
@@ -419,19 +448,23 @@ namespace mongo {
     
     bool HybridBuildStrategy::handleMatch( bool &orderedMatch ) {
         if ( !_queryOptimizerCursor->currentPlanScanAndOrderRequired() ) {
-            return _orderedBuild.handleMatch( orderedMatch );
+            bool match = _orderedBuild.handleMatch( orderedMatch );
+            _matchNeededRecord = _orderedBuild.matchNeededRecord();
+            return match;
         }
         orderedMatch = false;
         return handleReorderMatch();
     }
     
     bool HybridBuildStrategy::handleReorderMatch() {
+        _matchNeededRecord = false;
         DiskLoc loc = _cursor->currLoc();
         if ( _scanAndOrderDups.getsetdup( loc ) ) {
             return false;
         }
         try {
             _reorderBuild._handleMatchNoDedup();
+            _matchNeededRecord = _reorderBuild.matchNeededRecord();
         } catch ( const UserException &e ) {
             if ( e.getCode() == ScanAndOrderMemoryLimitExceededAssertionCode ) {
                 if ( _queryOptimizerCursor->runningInitialCachedPlan() ) {
@@ -476,21 +509,25 @@ namespace mongo {
     _queryOptimizerCursor( dynamic_pointer_cast<QueryOptimizerCursor>( _cursor ) ),
     _buf( 32768 ), // TODO be smarter here
     _chunkManager( newChunkManager() ),
+    _shardKey( _chunkManager ? _chunkManager->getKey() : BSONObj() ),
     _explain( newExplainRecordingStrategy( queryPlan, oldPlan ) ),
     _builder( newResponseBuildStrategy( queryPlan ) ) {
         _builder->resetBuf();
     }
 
     bool QueryResponseBuilder::addMatch() {
-        if ( !currentMatches() ) {
+        MatchDetails details;
+        if ( !currentMatches( details ) ) {
             return false;
         }
-        if ( !chunkMatches() ) {
+        bool loadedRecord = details._loadedObject;
+        if ( !chunkMatches( loadedRecord ) ) {
             return false;
         }
         bool orderedMatch = false;
         bool match = _builder->handleMatch( orderedMatch );
-        _explain->noteIterate( match, orderedMatch, true, false );
+        loadedRecord = loadedRecord || _builder->matchNeededRecord();
+        _explain->noteIterate( match, orderedMatch, loadedRecord, false );
         return match;
     }
 
@@ -586,8 +623,7 @@ namespace mongo {
         ( new HybridBuildStrategy( _parsedQuery, _queryOptimizerCursor, _buf ) );
     }
 
-    bool QueryResponseBuilder::currentMatches() {
-        MatchDetails details;
+    bool QueryResponseBuilder::currentMatches( MatchDetails &details ) {
         if ( _cursor->currentMatches( &details ) ) {
             return true;
         }
@@ -595,17 +631,55 @@ namespace mongo {
         return false;
     }
 
-    bool QueryResponseBuilder::chunkMatches() {
+    bool QueryResponseBuilder::chunkMatches( bool &loadedRecord ) {
         if ( !_chunkManager ) {
             return true;
         }
-        // TODO: should make this covered at some point
-        if ( _chunkManager->belongsToMe( _cursor->current() ) ) {
+        BSONObj shardKey = currentShardKeyFromIndex();
+        if ( shardKey.isEmpty() ) {
+            shardKey = _cursor->current();
+            loadedRecord = true;
+        }
+        if ( _chunkManager->belongsToMe( shardKey ) ) {
             return true;
         }
-        _explain->noteIterate( false, false, true, true );
+        _explain->noteIterate( false, false, loadedRecord, true );
         return false;
     }
+
+    BSONObj QueryResponseBuilder::currentShardKeyFromIndex() const {
+        BSONObj keyPattern = _cursor->indexKeyPattern();
+        if ( keyPattern.isEmpty() || _cursor->isMultiKey() ) {
+            return BSONObj();
+        }
+        BSONObj key = _cursor->currKey();
+        BSONObjBuilder b( 64 );
+        BSONObjIterator i( _shardKey );
+        while( i.more() ) {
+            const char *name = i.next().fieldName();
+            if ( strchr( name, '.' ) ) {
+                // belongsToMe() would look for a nested field
+                return BSONObj();
+            }
+            BSONObjIterator p( keyPattern );
+            BSONObjIterator k( key );
+            bool found = false;
+            while( p.more() && k.more() ) {
+                BSONElement pe = p.next();
+                BSONElement ke = k.next();
+                // only plain index fields hold the document's values, not "2d" etc
+                if ( pe.isNumber() && str::equals( pe.fieldName(), name ) ) {
+                    b.appendAs( ke, name );
+                    found = true;
+                    break;
+                }
+            }
+            if ( !found ) {
+                return BSONObj();
+            }
+        }
+        return b.obj();
+    }
     
     /**
      * Run a query with a cursor provided by the query optimizer, or FindingStartCursor.
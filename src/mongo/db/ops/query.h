@@ -151,16 +151,27 @@ namespace mongo {
         virtual void finishedFirstBatch() {}
         /** Reset the buffer. */
         void resetBuf();
+        /**
+         * @return true if the last handleMatch() read the document rather than building the
+         * response from the index key, or would have had the query not been an explain.
+         */
+        bool matchNeededRecord() const { return _matchNeededRecord; }
     protected:
         /**
          * Return the document for the current iterate.  Implements the $returnKey option.
          * @param allowCovered - enable covered index support.
          */
         BSONObj current( bool allowCovered ) const;
+        /** @return true if current( allowCovered ) reads the document. */
+        bool currentNeedsRecord( bool allowCovered ) const;
+        /** @return true if the sort fields are all in the covered projection, so that a response to
+         * be reordered can still be built from the index key. */
+        bool orderCovered() const;
         const ParsedQuery &_parsedQuery;
         shared_ptr<Cursor> _cursor;
         shared_ptr<QueryOptimizerCursor> _queryOptimizerCursor;
         BufBuilder &_buf;
+        bool _matchNeededRecord;
     private:
         const Projection::KeyOnly *keyFieldsOnly() const;
         shared_ptr<Projection::KeyOnly> _planKeyFieldsOnly;
@@ -257,13 +268,19 @@ namespace mongo {
         ( const QueryPlan::Summary &queryPlan, const BSONObj &oldPlan ) const;
         shared_ptr<ResponseBuildStrategy> newResponseBuildStrategy
         ( const QueryPlan::Summary &queryPlan );
-        bool currentMatches();
-        bool chunkMatches();
+        bool currentMatches( MatchDetails &details );
+        bool chunkMatches( bool &loadedRecord );
+        /**
+         * @return the shard key values of the current iterate taken from its index key, or an empty
+         * object if the key doesn't hold them all.
+         */
+        BSONObj currentShardKeyFromIndex() const;
         const ParsedQuery &_parsedQuery;
         shared_ptr<Cursor> _cursor;
         shared_ptr<QueryOptimizerCursor> _queryOptimizerCursor;
         BufBuilder _buf;
         ShardChunkManagerPtr _chunkManager;
+        BSONObj _shardKey; // of _chunkManager
         shared_ptr<ExplainRecordingStrategy> _explain;
         shared_ptr<ResponseBuildStrategy> _builder;
     };
@@ -955,10 +955,7 @@ namespace mongo {
             }
         }
         Record *r = loc.rec();
-
-        if ( cc().allowedToThrowPageFaultException() && ! r->likelyInPhysicalMemory() ) {
-            throw PageFaultException( r );
-        }
+        checkWriteFault( r );
 
         /* look for $inc etc.  note as listed here, all fields to inc must be this type, you can't set some
            regular ones at the moment. */
@@ -1081,11 +1078,8 @@ namespace mongo {
             auto_ptr<ClientCursor> cc;
             do {
                 
-                if ( cc.get() == 0 && 
-                     client.allowedToThrowPageFaultException() && 
-                     ! c->currLoc().isNull() && 
-                     ! c->currLoc().rec()->likelyInPhysicalMemory() ) {
-                    throw PageFaultException( c->currLoc().rec() );
+                if ( cc.get() == 0 && ! c->currLoc().isNull() ) {
+                    checkWriteFault( c->currLoc().rec() );
                 }
 
                 bool atomic = c->matcher() && c->matcher()->docMatcher().atomic();
@@ -6,6 +6,7 @@
 #include "client.h"
 #include "pdfile.h"
 #include "server.h"
+#include "stats/counters.h"
 
 namespace mongo { 
 
@@ -28,6 +29,15 @@ namespace mongo {
             return;
         }
         r->touch();
+        globalWriteFaultCounters.yielded();
+    }
+
+    void checkWriteFault(Record *r) { 
+        if( r->likelyInPhysicalMemory() )
+            return;
+        if( cc().allowedToThrowPageFaultException() )
+            throw PageFaultException(r);
+        globalWriteFaultCounters.underLock();
     }
 
     PageFaultRetryableSection::~PageFaultRetryableSection() {
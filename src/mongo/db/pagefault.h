@@ -25,6 +25,13 @@ namespace mongo {
         PageFaultRetryableSection();
         ~PageFaultRetryableSection();
     };
+
+    /** 
+     * For write paths, before reading r write locked.  If r is likely not in physical memory, throws 
+     * PageFaultException when the enclosing PageFaultRetryableSection can still retry, i.e. nothing was 
+     * written this pass, so the fault is taken with the lock released; otherwise counts a fault under lock.
+     */
+    void checkWriteFault(Record *r);
 #if 0
     inline void how_to_use_example() {
         // ...
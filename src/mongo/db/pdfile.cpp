@@ -46,6 +46,8 @@ _ disallow system* manipulations from the database.
 #include "instance.h"
 #include "replutil.h"
 #include "memconcept.h"
+#include "fieldindex.h"
+#include "../s/d_logic.h"
 
 #include <boost/filesystem/operations.hpp>
 
@@ -969,6 +971,7 @@ namespace mongo {
     static void unindexRecord(NamespaceDetails *d, Record *todelete, const DiskLoc& dl, bool noWarn = false) {
         BSONObj obj(todelete);
         int n = d->nIndexes;
+        FieldIndex::Scope fis( obj , n + ( d->indexBuildInProgress ? 1 : 0 ) );
         for ( int i = 0; i < n; i++ )
             _unindexRecord(d->idx(i), obj, dl, !noWarn);
         if( d->indexBuildInProgress ) { // background index
@@ -1162,6 +1165,8 @@ namespace mongo {
         //  update in place
         int sz = objNew.objsize();
         memcpy(getDur().writingPtr(toupdate->data, sz), objNew.objdata(), sz);
+        if ( shardingState.enabled() )
+            shardingState.noteChunkWrite( ns , objNew , sz );
         return dl;
     }
 
@@ -1252,6 +1257,8 @@ namespace mongo {
         IndexInterface::phasedBegin();
 
         int n = d->nIndexesBeingBuilt();
+        // stays in scope for the rollback below, which generates the keys again
+        FieldIndex::Scope fis( obj , n );
         {
             BSONObjSet keys;
             for ( int i = 0; i < n; i++ ) {
@@ -2092,6 +2099,12 @@ namespace mongo {
 
         d->paddingFits();
 
+        // every write path ends up here or in updateRecord(), so this is where the shard counts chunk writes
+        if ( !god && shardingState.enabled() ) {
+            BSONObj obj(r->data);
+            shardingState.noteChunkWrite( ns , obj , obj.objsize() );
+        }
+
         return loc;
     }
 
@@ -40,6 +40,14 @@ namespace mongo {
             void addNo() { _add( false , "" ); }
             void addYes( const string& name ) { _add( true , name ); }
 
+            /** @return true if name is one of the fields hydrate() outputs */
+            bool includes( const char *name ) const {
+                for ( unsigned i = 0; i < _names.size(); i++ )
+                    if ( _include[i] && _names[i] == name )
+                        return true;
+                return false;
+            }
+
         private:
 
             void _add( bool b , const string& name ) {
@@ -486,18 +486,28 @@ doneCheckOrder:
         DEBUGQO( "\t special : " << _frsp->getSpecial() );
         if ( _frsp->getSpecial().size() ) {
             _special = _frsp->getSpecial();
-            NamespaceDetails::IndexIterator i = d->ii();
-            while( i.more() ) {
-                int j = i.pos();
-                IndexDetails& ii = i.next();
-                const IndexSpec& spec = ii.getSpec();
-                if ( spec.getTypeName() == _special && spec.suitability( _originalQuery , _order ) ) {
-                    _plans.push_back( QueryPlanPtr( new QueryPlan( d , j , *_frsp ,
-                                                                  _originalFrsp.get() ,
-                                                                  _originalQuery, _fields, _order ,
-                                                                  BSONObj() , BSONObj() ,
-                                                                  _special ) ) );
-                    return;
+            // indexes of the special type itself come first, other types that also handle it
+            // (eg 2dsphere for "2d") only get the queries none of those is suitable for, so the
+            // answer doesn't depend on which index was created first
+            for ( int pass = 0; pass < 2; pass++ ) {
+                NamespaceDetails::IndexIterator i = d->ii();
+                while( i.more() ) {
+                    int j = i.pos();
+                    IndexDetails& ii = i.next();
+                    const IndexSpec& spec = ii.getSpec();
+                    if ( ! spec.getType() )
+                        continue;
+                    const IndexPlugin* plugin = spec.getType()->getPlugin();
+                    bool own = plugin->getName() == _special;
+                    if ( ( pass == 0 ? own : ! own && plugin->handlesSpecial( _special ) ) &&
+                         spec.suitability( _originalQuery , _order ) ) {
+                        _plans.push_back( QueryPlanPtr( new QueryPlan( d , j , *_frsp ,
+                                                                      _originalFrsp.get() ,
+                                                                      _originalQuery, _fields, _order ,
+                                                                      BSONObj() , BSONObj() ,
+                                                                      _special ) ) );
+                        return;
+                    }
                 }
             }
             uassert( 13038 , (string)"can't find special index: " + _special + " for: " + _originalQuery.toString() , 0 );
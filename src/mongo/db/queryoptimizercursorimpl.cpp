@@ -192,8 +192,10 @@ namespace mongo {
 
             if ( _explainPlanInfo ) {
                 bool countableMatch = newMatch && _matchCounter.wouldCountMatch( _c->currLoc() );
+                // a match is then read to build the response, unless it is built from the key
                 _explainPlanInfo->noteIterate( countableMatch,
-                                              countableMatch || myDetails._loadedObject, *_c );
+                                              myDetails._loadedObject ||
+                                              ( countableMatch && !keyFieldsOnly() ), *_c );
             }
             if ( details ) *details = myDetails;
 
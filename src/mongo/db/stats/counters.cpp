@@ -131,13 +131,29 @@ namespace mongo {
         : _total_time(0)
         , _flushes(0)
         , _last()
+        , _writeback_bytes(0)
+        , _writeback_time(0)
+        , _backlog(0)
+        , _cycle_bytes(0)
+        , _last_rate(0)
     {}
 
     void FlushCounters::flushed(int ms) {
+        Date_t now = jsTime();
+        if ( _last.millis && now.millis > _last.millis )
+            _last_rate = _cycle_bytes / ( 1024.0 * 1024.0 ) / ( ( now.millis - _last.millis ) / 1000.0 );
+        _cycle_bytes = 0;
+
         _flushes++;
         _total_time += ms;
         _last_time = ms;
-        _last = jsTime();
+        _last = now;
+    }
+
+    void FlushCounters::wroteBack(long long bytes, int ms) {
+        _writeback_bytes += bytes;
+        _writeback_time += ms;
+        _cycle_bytes += bytes;
     }
 
     void FlushCounters::append( BSONObjBuilder& b ) {
@@ -146,9 +162,18 @@ namespace mongo {
         b.appendNumber( "average_ms" , (_flushes ? (_total_time / double(_flushes)) : 0.0) );
         b.appendNumber( "last_ms" , _last_time );
         b.append("last_finished", _last);
+        b.appendNumber( "writeback_mb" , _writeback_bytes / ( 1024 * 1024 ) );
+        b.appendNumber( "writeback_ms" , _writeback_time );
+        b.appendNumber( "writeback_mb_s" , _last_rate );
+        b.appendNumber( "backlog_mb" , _backlog / ( 1024.0 * 1024.0 ) );
     }
 
 
+    void WriteFaultCounters::append( BSONObjBuilder& b ) {
+        b.appendNumber( "yielded" , _yielded );
+        b.appendNumber( "underLock" , _underLock );
+    }
+
     void GenericCounter::hit( const string& name , int count ) {
         scoped_lock lk( _mutex );
         _counts[name]++;
@@ -202,6 +227,7 @@ namespace mongo {
     OpCounters replOpCounters;
     IndexCounters globalIndexCounters;
     FlushCounters globalFlushCounters;
+    WriteFaultCounters globalWriteFaultCounters;
     NetworkCounter networkCounter;
 
 }
@@ -118,6 +118,12 @@ namespace mongo {
 
         void flushed(int ms);
 
+        /** continuous flushing wrote back bytes of dirty regions in ms between full flushes */
+        void wroteBack(long long bytes, int ms);
+
+        /** dirty bytes waiting for continuous flushing */
+        void backlog(long long bytes) { _backlog = bytes; }
+
         void append( BSONObjBuilder& b );
 
     private:
@@ -125,10 +131,34 @@ namespace mongo {
         long long _flushes;
         int _last_time;
         Date_t _last;
+
+        long long _writeback_bytes;
+        long long _writeback_time;
+        long long _backlog;
+        long long _cycle_bytes;   // written back since the last full flush
+        double _last_rate;        // MB/s written back during the last full interval
     };
 
     extern FlushCounters globalFlushCounters;
 
+    /** page faults of the write paths: yielded for (see PageFaultRetryableSection) or taken holding the lock */
+    class WriteFaultCounters {
+    public:
+        WriteFaultCounters() : _yielded(0), _underLock(0) {}
+
+        // used without a mutex intentionally (can race)
+        void yielded() { _yielded++; }
+        void underLock() { _underLock++; }
+
+        void append( BSONObjBuilder& b );
+
+    private:
+        long long _yielded;
+        long long _underLock;
+    };
+
+    extern WriteFaultCounters globalWriteFaultCounters;
+
 
     class GenericCounter {
     public:
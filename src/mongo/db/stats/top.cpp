@@ -42,7 +42,7 @@ namespace mongo {
 
     }
 
-    void Top::record( const string& ns , int op , int lockType , long long micros , bool command ) {
+    void Top::record( const string& ns , int op , int lockType , long long micros , long long lockWaitMicros , bool command ) {
         if ( ns[0] == '?' )
             return;
 
@@ -57,6 +57,34 @@ namespace mongo {
         CollectionData& coll = _usage[ns];
         _record( coll , op , lockType , micros , command );
         _record( _global , op , lockType , micros , command );
+        _recordLatency( _latency[ns] , op , micros , lockWaitMicros , command );
+        _recordLatency( _globalLatency , op , micros , lockWaitMicros , command );
+    }
+
+    void Top::_recordLatency( LatencyData& l , int op , long long micros , long long lockWaitMicros , bool command ) {
+        LatencyHistogram* h = 0;
+        switch ( op ) {
+        case dbUpdate:
+            h = &l.update;
+            break;
+        case dbInsert:
+            h = &l.insert;
+            break;
+        case dbQuery:
+            h = command ? &l.commands : &l.queries;
+            break;
+        case dbGetMore:
+            h = &l.getmore;
+            break;
+        case dbDelete:
+            h = &l.remove;
+            break;
+        default:
+            // unknown ops are logged by _record()
+            return;
+        }
+        h->insert( micros > 0 ? micros : 0 );
+        l.lockWait.insert( lockWaitMicros > 0 ? lockWaitMicros : 0 );
     }
 
     void Top::_record( CollectionData& c , int op , int lockType , long long micros , bool command ) {
@@ -105,6 +133,7 @@ namespace mongo {
         //cout << "collectionDropped: " << ns << endl;
         scoped_lock lk(_lock);
         _usage.erase(ns);
+        _latency.erase(ns);
         _lastDropped = ns;
     }
 
@@ -118,6 +147,11 @@ namespace mongo {
         _appendToUsageMap( b , _usage );
     }
 
+    void Top::appendGlobalLatency( BSONObjBuilder& b ) const {
+        scoped_lock lk( _lock );
+        _appendLatency( b , _globalLatency );
+    }
+
     void Top::_appendToUsageMap( BSONObjBuilder& b , const UsageMap& map ) const {
         for ( UsageMap::const_iterator i=map.begin(); i!=map.end(); i++ ) {
             BSONObjBuilder bb( b.subobjStart( i->first ) );
@@ -136,6 +170,13 @@ namespace mongo {
             _appendStatsEntry( b , "remove" , coll.remove );
             _appendStatsEntry( b , "commands" , coll.commands );
 
+            LatencyMap::const_iterator l = _latency.find( i->first );
+            if ( l != _latency.end() ) {
+                BSONObjBuilder lb( b.subobjStart( "latency" ) );
+                _appendLatency( lb , l->second );
+                lb.done();
+            }
+
             bb.done();
         }
     }
@@ -147,6 +188,28 @@ namespace mongo {
         bb.done();
     }
 
+    void Top::_appendLatency( BSONObjBuilder& b , const LatencyData& l ) const {
+        _appendLatencyEntry( b , "queries" , l.queries );
+        _appendLatencyEntry( b , "getmore" , l.getmore );
+        _appendLatencyEntry( b , "insert" , l.insert );
+        _appendLatencyEntry( b , "update" , l.update );
+        _appendLatencyEntry( b , "remove" , l.remove );
+        _appendLatencyEntry( b , "commands" , l.commands );
+        _appendLatencyEntry( b , "lockWait" , l.lockWait );
+    }
+
+    void Top::_appendLatencyEntry( BSONObjBuilder& b , const char * statsName , const LatencyHistogram& h ) const {
+        if ( h.count() == 0 )
+            return;
+        BSONObjBuilder bb( b.subobjStart( statsName ) );
+        bb.appendNumber( "count" , (long long) h.count() );
+        bb.appendNumber( "p50" , (long long) h.percentile( 0.50 ) );
+        bb.appendNumber( "p95" , (long long) h.percentile( 0.95 ) );
+        bb.appendNumber( "p99" , (long long) h.percentile( 0.99 ) );
+        bb.appendNumber( "max" , (long long) h.max() );
+        bb.done();
+    }
+
     class TopCmd : public Command {
     public:
         TopCmd() : Command( "top", true ) {}
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include "../../util/histogram.h"
 #undef assert
 #define assert MONGO_assert
 
@@ -65,9 +66,29 @@ namespace mongo {
 
         typedef map<string,CollectionData> UsageMap;
 
+        /**
+         * Latency distributions of a collection.  Kept apart from CollectionData, which is copied
+         * and diffed for snapshots, as these are much bigger and only ever accumulate.
+         */
+        struct LatencyData {
+            LatencyHistogram queries;
+            LatencyHistogram getmore;
+            LatencyHistogram insert;
+            LatencyHistogram update;
+            LatencyHistogram remove;
+            LatencyHistogram commands;
+
+            /** time each operation spent waiting for locks, part of the above */
+            LatencyHistogram lockWait;
+        };
+
+        typedef map<string,LatencyData> LatencyMap;
+
     public:
-        void record( const string& ns , int op , int lockType , long long micros , bool command );
+        void record( const string& ns , int op , int lockType , long long micros , long long lockWaitMicros , bool command );
         void append( BSONObjBuilder& b );
+        /** appends the latency percentiles of all collections together, for serverStatus */
+        void appendGlobalLatency( BSONObjBuilder& b ) const;
         void cloneMap(UsageMap& out) const;
         CollectionData getGlobalData() const { return _global; }
         void collectionDropped( const string& ns );
@@ -79,10 +100,15 @@ namespace mongo {
         void _appendToUsageMap( BSONObjBuilder& b , const UsageMap& map ) const;
         void _appendStatsEntry( BSONObjBuilder& b , const char * statsName , const UsageData& map ) const;
         void _record( CollectionData& c , int op , int lockType , long long micros , bool command );
+        void _recordLatency( LatencyData& l , int op , long long micros , long long lockWaitMicros , bool command );
+        void _appendLatency( BSONObjBuilder& b , const LatencyData& l ) const;
+        void _appendLatencyEntry( BSONObjBuilder& b , const char * statsName , const LatencyHistogram& h ) const;
 
         mutable mongo::mutex _lock;
         CollectionData _global;
         UsageMap _usage;
+        LatencyData _globalLatency;
+        LatencyMap _latency;
         string _lastDropped;
     };
 
@@ -592,6 +592,22 @@ namespace BasicTests {
         }
     };
 
+    class BoundedQueueTest {
+    public:
+        void run() {
+            BlockingQueue<int> q( 2 );
+            q.push( 1 );
+            q.push( 2 );
+            boost::thread pusher( boost::bind( &BlockingQueue<int>::push , &q , 3 ) );
+            sleepmillis( 100 );
+            ASSERT_EQUALS( 2u , q.size() ); // full, the third push waits
+            ASSERT_EQUALS( 1 , q.blockingPop() );
+            pusher.join();
+            ASSERT_EQUALS( 2 , q.blockingPop() );
+            ASSERT_EQUALS( 3 , q.blockingPop() );
+        }
+    };
+
     class StrTests {
     public:
 
@@ -699,6 +715,7 @@ namespace BasicTests {
             add< IsValidUTF8Test >();
 
             add< QueueTest >();
+            add< BoundedQueueTest >();
 
             add< StrTests >();
 
@@ -235,6 +235,77 @@ namespace ChunkTests {
             }
         };
 
+        class ShardQueriesBase {
+        public:
+            virtual ~ShardQueriesBase() {}
+            void run() {
+                ChunkManager chunkManager;
+                chunkManager.setShardKey( shardKey() );
+                chunkManager.setSingleChunkForShards( splitPoints() );
+
+                map<Shard,BSONObj> shardQueries;
+                chunkManager.getShardQueries( query(), shardQueries );
+
+                BSONObjBuilder b;
+                for( map<Shard,BSONObj>::const_iterator i = shardQueries.begin(); i != shardQueries.end(); ++i ) {
+                    b.append( i->first.getName(), i->second );
+                }
+                ASSERT_EQUALS( expected(), b.obj() );
+            }
+        protected:
+            virtual BSONObj shardKey() const { return BSON( "a" << 1 ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << "x" ) );
+                ret.push_back( BSON( "a" << "y" ) );
+                ret.push_back( BSON( "a" << "z" ) );
+                return ret;
+            }
+            virtual BSONObj query() const = 0;
+            virtual BSONObj expected() const = 0;
+        };
+
+        class ShardQueriesNoIn : public ShardQueriesBase {
+            virtual BSONObj query() const { return fromjson( "{a:{$gt:'u'},b:1}" ); }
+            virtual BSONObj expected() const { return BSONObj(); }
+        };
+
+        class ShardQueriesSplitIn : public ShardQueriesBase {
+            virtual BSONObj query() const {
+                return fromjson( "{b:1,a:{$in:['u','x','y','v'],$ne:'w'}}" );
+            }
+            virtual BSONObj expected() const {
+                return fromjson( "{'0':{b:1,a:{$in:['u','v'],$ne:'w'}},"
+                                 "'1':{b:1,a:{$in:['x'],$ne:'w'}},"
+                                 "'2':{b:1,a:{$in:['y'],$ne:'w'}}}" );
+            }
+        };
+
+        class ShardQueriesSingleShard : public ShardQueriesBase {
+            virtual BSONObj query() const { return fromjson( "{a:{$in:['u','v']}}" ); }
+            virtual BSONObj expected() const { return BSONObj(); }
+        };
+
+        class ShardQueriesRegex : public ShardQueriesBase {
+            virtual BSONObj query() const { return fromjson( "{a:{$in:['u',/^y/]}}" ); }
+            virtual BSONObj expected() const { return BSONObj(); }
+        };
+
+        class ShardQueriesCompoundKey : public ShardQueriesBase {
+            virtual BSONObj shardKey() const { return BSON( "a" << 1 << "b" << 1 ); }
+            virtual vector<BSONObj> splitPoints() const {
+                vector<BSONObj> ret;
+                ret.push_back( BSON( "a" << "x" << "b" << 0 ) );
+                ret.push_back( BSON( "a" << "y" << "b" << 0 ) );
+                ret.push_back( BSON( "a" << "z" << "b" << 0 ) );
+                return ret;
+            }
+            virtual BSONObj query() const { return fromjson( "{a:{$in:['u','y']}}" ); }
+            virtual BSONObj expected() const {
+                return fromjson( "{'0':{a:{$in:['u']}},'1':{a:{$in:['y']}},'2':{a:{$in:['y']}}}" );
+            }
+        };
+
     } // namespace ChunkManagerTests
     
     class All : public Suite {
@@ -263,6 +334,11 @@ namespace ChunkTests {
             add<ChunkManagerTests::InequalityThenUnsatisfiable>();
             add<ChunkManagerTests::OrEqualityUnsatisfiableInequality>();
             add<ChunkManagerTests::InMultiShard>();
+            add<ChunkManagerTests::ShardQueriesNoIn>();
+            add<ChunkManagerTests::ShardQueriesSplitIn>();
+            add<ChunkManagerTests::ShardQueriesSingleShard>();
+            add<ChunkManagerTests::ShardQueriesRegex>();
+            add<ChunkManagerTests::ShardQueriesCompoundKey>();
         }
     } myall;
     
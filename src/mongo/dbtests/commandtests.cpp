@@ -84,6 +84,103 @@ namespace CommandTests {
         };
     }
 
+    namespace GeoSearch {
+        /** the same documents indexed with string buckets and with binary buckets */
+        struct Base {
+            Base() {
+                for ( int v = 0; v < 2; v++ ) {
+                    db.dropCollection( ns( v ) );
+                    db.insert( "test.system.indexes" , BSON( "ns" << ns( v ) << "key" << BSON( "pos" << "geoHaystack" << "type" << 1 ) <<
+                                                             "name" << "pos_geoHaystack_type_1" << "bucketSize" << 1 <<
+                                                             "bucketKeyVersion" << v ) );
+                }
+                int id = 0;
+                for ( double x = -10; x <= 10; x += 0.7 ) {
+                    for ( double y = -10; y <= 10; y += 0.7 ) {
+                        BSONObj o = BSON( "_id" << id << "pos" << BSON_ARRAY( x << y ) << "type" << ( id % 3 == 0 ? "a" : "b" ) );
+                        db.insert( ns( 0 ) , o );
+                        db.insert( ns( 1 ) , o );
+                        id++;
+                    }
+                }
+                ASSERT( db.getLastError().empty() );
+            }
+
+            static string coll( int v ) { return v ? "geosearch_v1" : "geosearch_v0"; }
+            static string ns( int v ) { return "test." + coll( v ); }
+
+            BSONObj search( int v , double x , double y , double maxDistance , const BSONObj& search , int limit ) {
+                BSONObj result;
+                ASSERT( db.runCommand( "test" , BSON( "geoSearch" << coll( v ) << "near" << BSON_ARRAY( x << y ) <<
+                                                      "maxDistance" << maxDistance << "search" << search <<
+                                                      "limit" << limit ) , result ) );
+                return result;
+            }
+
+            static set<int> ids( const BSONObj& result ) {
+                set<int> s;
+                BSONObjIterator i( result["results"].Obj() );
+                while ( i.more() )
+                    s.insert( i.next()["_id"].numberInt() );
+                return s;
+            }
+
+            DBDirectClient db;
+        };
+
+        struct SameResults : Base {
+            void run() {
+                BSONObj searches[] = { BSON( "type" << "a" ) , BSON( "type" << "b" ) , BSON( "type" << "c" ) , BSONObj() };
+                double centers[][2] = { { 0 , 0 } , { 3.3 , -2.1 } , { -9.5 , 9.5 } };
+                for ( int s = 0; s < 4; s++ ) {
+                    for ( int c = 0; c < 3; c++ ) {
+                        for ( double d = 0.5; d < 4; d += 1.1 ) {
+                            // compared as sets: the two formats scan buckets in different orders
+                            set<int> v0 = ids( search( 0 , centers[c][0] , centers[c][1] , d , searches[s] , 100000 ) );
+                            set<int> v1 = ids( search( 1 , centers[c][0] , centers[c][1] , d , searches[s] , 100000 ) );
+                            ASSERT( v0 == v1 );
+                            if ( s >= 2 )
+                                ASSERT( v1.empty() );
+                        }
+                    }
+                }
+            }
+        };
+
+        struct BinaryKeys : Base {
+            void run() {
+                BSONObj spec = db.findOne( "test.system.indexes" , BSON( "ns" << ns( 1 ) << "name" << "pos_geoHaystack_type_1" ) );
+                ASSERT_EQUALS( 1 , spec["bucketKeyVersion"].numberInt() );
+
+                // new indexes default to binary buckets
+                db.dropCollection( "test.geosearch_default" );
+                db.insert( "test.system.indexes" , BSON( "ns" << "test.geosearch_default" << "key" << BSON( "pos" << "geoHaystack" << "type" << 1 ) <<
+                                                         "name" << "pos_geoHaystack_type_1" << "bucketSize" << 1 ) );
+                spec = db.findOne( "test.system.indexes" , BSON( "ns" << "test.geosearch_default" << "name" << "pos_geoHaystack_type_1" ) );
+                ASSERT_EQUALS( 1 , spec["bucketKeyVersion"].numberInt() );
+                db.dropCollection( "test.geosearch_default" );
+            }
+        };
+
+        struct Limit : Base {
+            void run() {
+                for ( int v = 0; v < 2; v++ ) {
+                    BSONObj all = search( v , 0 , 0 , 3 , BSON( "type" << "b" ) , 100000 );
+                    ASSERT( all["stats"]["n"].numberInt() > 5 );
+
+                    // the scan stops once limit documents are found
+                    BSONObj some = search( v , 0 , 0 , 3 , BSON( "type" << "b" ) , 5 );
+                    ASSERT_EQUALS( 5 , some["stats"]["n"].numberInt() );
+                    ASSERT( some["stats"]["btreeMatches"].numberLong() < all["stats"]["btreeMatches"].numberLong() );
+                    set<int> allIds = ids( all );
+                    set<int> someIds = ids( some );
+                    for ( set<int>::const_iterator i = someIds.begin(); i != someIds.end(); ++i )
+                        ASSERT( allIds.count( *i ) );
+                }
+            }
+        };
+    }
+
     class All : public Suite {
     public:
         All() : Suite( "commands" ) {
@@ -92,6 +189,9 @@ namespace CommandTests {
         void setupTests() {
             add< FileMD5::Type0 >();
             add< FileMD5::Type2 >();
+            add< GeoSearch::SameResults >();
+            add< GeoSearch::BinaryKeys >();
+            add< GeoSearch::Limit >();
         }
 
     } all;
@@ -125,6 +125,42 @@ namespace CountTests {
         }
     };
     
+    class CountIndexedRange : public Base {
+    public:
+        void run() {
+            addIndex( fromjson( "{b:-1,c:1}" ) );
+            for( int i = 0; i < 3000; ++i ) {
+                insert( BSON( "a" << i << "b" << i % 1000 << "c" << i ) );
+            }
+            insert( "{a:'x',b:'x'}" );
+            string err;
+            // counted from the btrees
+            ASSERT_EQUALS( 1400, runCount( ns(), fromjson( "{query:{a:{$gte:100,$lt:1500}}}" ), err ) );
+            ASSERT_EQUALS( 1400, runCount( ns(), fromjson( "{query:{a:{$gt:100,$lte:1500}}}" ), err ) );
+            ASSERT_EQUALS( 1, runCount( ns(), fromjson( "{query:{a:7.0}}" ), err ) );
+            ASSERT_EQUALS( 0, runCount( ns(), fromjson( "{query:{a:{$gt:5,$lt:5}}}" ), err ) );
+            ASSERT_EQUALS( 3, runCount( ns(), fromjson( "{query:{b:7}}" ), err ) );
+            ASSERT_EQUALS( 300, runCount( ns(), fromjson( "{query:{b:{$gte:10,$lt:110}}}" ), err ) );
+            ASSERT_EQUALS( 297, runCount( ns(), fromjson( "{query:{b:{$gte:10,$lt:110}},skip:3}" ), err ) );
+            ASSERT_EQUALS( 5, runCount( ns(), fromjson( "{query:{b:{$gte:10,$lt:110}},limit:5}" ), err ) );
+            ASSERT_EQUALS( 5, runCount( ns(), fromjson( "{query:{b:{$gte:10,$lt:110}},skip:295,limit:10}" ), err ) );
+            ASSERT_EQUALS( 0, runCount( ns(), fromjson( "{query:{b:{$gte:10,$lt:110}},skip:400,limit:10}" ), err ) );
+            // not a two sided range of one type, counted with a cursor
+            ASSERT_EQUALS( 2899, runCount( ns(), fromjson( "{query:{a:{$gt:100}}}" ), err ) );
+            ASSERT_EQUALS( 1399, runCount( ns(), fromjson( "{query:{a:{$gte:100,$lt:1500,$ne:200}}}" ), err ) );
+        }
+    };
+
+    class CountIndexedRangeMultikey : public Base {
+    public:
+        void run() {
+            insert( "{a:[1,2,3]}" );
+            insert( "{a:2}" );
+            string err;
+            ASSERT_EQUALS( 2, runCount( ns(), fromjson( "{query:{a:{$gte:1,$lte:3}}}" ), err ) );
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "count" ) {
@@ -136,6 +172,8 @@ namespace CountTests {
             add< CountFields >();
             add< CountQueryFields >();
             add< CountIndexedRegex >();
+            add< CountIndexedRange >();
+            add< CountIndexedRangeMultikey >();
         }
     } myall;
     
@@ -178,6 +178,48 @@ namespace {
         }
     };
 
+    class GetChunkForTests {
+    public:
+        void run() {
+            BSONObj collection = BSON( "_id"     << "x.y" <<
+                                       "dropped" << false <<
+                                       "key"     << BSON( "a" << 1 ) <<
+                                       "unique"  << false );
+
+            // 3-chunk collection, 2 of them being contiguous
+            // [min->10) , [10->20) , <gap> , [30->max)
+            BSONObj key_a10 = BSON( "a" << 10 );
+            BSONObj key_a30 = BSON( "a" << 30 );
+            BSONObj key_min = BSON( "a" << MINKEY );
+            BSONArray chunks = BSON_ARRAY( BSON( "_id" << "x.y-a_MinKey" <<
+                                                 "ns"  << "x.y" <<
+                                                 "min" << key_min <<
+                                                 "max" << key_a10 ) <<
+                                           BSON( "_id" << "x.y-a_10" <<
+                                                 "ns"  << "x.y" <<
+                                                 "min" << key_a10 <<
+                                                 "max" << BSON( "a" << 20 ) ) <<
+                                           BSON( "_id" << "x.y-a_30" <<
+                                                 "ns"  << "x.y" <<
+                                                 "min" << key_a30 <<
+                                                 "max" << BSON( "a" << MAXKEY ) ) );
+            ShardChunkManager s ( collection , chunks );
+
+            BSONObj foundMin;
+            ASSERT( s.getChunkFor( BSON( "a" << 5 << "b" << 1 ) , &foundMin ) );
+            ASSERT( foundMin.woCompare( key_min ) == 0 );
+            ASSERT( s.getChunkFor( BSON( "a" << 10 ) , &foundMin ) );
+            ASSERT( foundMin.woCompare( key_a10 ) == 0 );
+            ASSERT( s.getChunkFor( BSON( "a" << 40 ) , &foundMin ) );
+            ASSERT( foundMin.woCompare( key_a30 ) == 0 );
+
+            // not in this shard, no shard key, or not an equality
+            ASSERT( ! s.getChunkFor( BSON( "a" << 25 ) , &foundMin ) );
+            ASSERT( ! s.getChunkFor( BSON( "b" << 5 ) , &foundMin ) );
+            ASSERT( ! s.getChunkFor( BSON( "a" << BSON( "$gt" << 5 ) ) , &foundMin ) );
+        }
+    };
+
     class DeletedTests {
     public:
         void run() {
@@ -453,6 +495,7 @@ namespace {
             add< BasicCompoundTests >();
             add< RangeTests >();
             add< GetNextTests >();
+            add< GetChunkForTests >();
             add< DeletedTests >();
             add< ClonePlusTests >();
             add< ClonePlusExceptionTests >();
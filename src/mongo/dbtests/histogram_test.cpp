@@ -79,6 +79,45 @@ namespace mongo {
         }
     };
 
+    class LatencyBuckets {
+    public:
+        void run() {
+            // exact below 8, then four buckets per power of two
+            for ( uint64_t v = 0; v < 8; v++ ) {
+                ASSERT_EQUALS( LatencyHistogram::bucketFor( v ), (int) v );
+                ASSERT_EQUALS( LatencyHistogram::lowerBound( (int) v ), v );
+            }
+            ASSERT_EQUALS( LatencyHistogram::bucketFor( 8 ), 8 );
+            ASSERT_EQUALS( LatencyHistogram::bucketFor( 9 ), 8 );
+            ASSERT_EQUALS( LatencyHistogram::bucketFor( 10 ), 9 );
+            ASSERT_EQUALS( LatencyHistogram::lowerBound( 9 ), 10u );
+            for ( int i = 0; i < LatencyHistogram::NumBuckets; i++ ) {
+                ASSERT_EQUALS( LatencyHistogram::bucketFor( LatencyHistogram::lowerBound( i ) ), i );
+            }
+            ASSERT_EQUALS( LatencyHistogram::bucketFor( 1ULL << 40 ), LatencyHistogram::NumBuckets - 1 );
+        }
+    };
+
+    class LatencyPercentiles {
+    public:
+        void run() {
+            LatencyHistogram h;
+            ASSERT_EQUALS( h.percentile( 0.99 ), 0u );
+            for ( uint64_t v = 1; v <= 1000; v++ ) {
+                h.insert( v );
+            }
+            ASSERT_EQUALS( h.count(), 1000u );
+            ASSERT_EQUALS( h.sum(), 500500u );
+            ASSERT_EQUALS( h.max(), 1000u );
+            // within the 25% resolution of the buckets, and never below the true value
+            uint64_t p50 = h.percentile( 0.50 );
+            ASSERT( p50 >= 500 && p50 <= 625 );
+            uint64_t p99 = h.percentile( 0.99 );
+            ASSERT( p99 >= 990 && p99 <= 1000 );
+            ASSERT_EQUALS( h.percentile( 1.0 ), 1000u );
+        }
+    };
+
     class HistogramSuite : public Suite {
     public:
         HistogramSuite() : Suite( "histogram" ) {}
@@ -87,6 +126,8 @@ namespace mongo {
             add< BoundariesInit >();
             add< BoundariesExponential >();
             add< BoundariesFind >();
+            add< LatencyBuckets >();
+            add< LatencyPercentiles >();
             // TODO: complete the test suite
         }
     } histogramSuite;
@@ -1422,6 +1422,35 @@ namespace JsobjTests {
         }
     };
 
+    class FieldNameCompareTest {
+    public:
+        void run() {
+            // place names at every alignment and up to a page end, so both the 16 byte and the byte by byte compares are taken
+            vector<char> buf( 3 * 4096 );
+            char *page = &buf[0] + ( 4096 - ( (size_t) &buf[0] ) % 4096 );
+            const char *names[] = { "", "a", "b", "ab", "abc", "abd", "field1", "field10", "field2",
+                                    "abcdefghijklmno", "abcdefghijklmnop", "abcdefghijklmnoq",
+                                    "abcdefghijklmnopqrstuvwxyz0123456789", "abcdefghijklmnopqrstuvwxyz0123456780",
+                                    "\xff", "\x7f" };
+            const int n = sizeof( names ) / sizeof( names[0] );
+            for( int off = 4096 - 48; off < 4096; off++ ) {
+                for( int i = 0; i < n; i++ ) {
+                    char *l = page + off;
+                    strcpy( l, names[i] );
+                    for( int j = 0; j < n; j++ ) {
+                        char *r = page + 2 * 4096 - 64 + ( off % 8 );
+                        strcpy( r, names[j] );
+                        int expected = strcmp( l, r );
+                        int got = fieldNameCompare( l, r );
+                        ASSERT_EQUALS( expected < 0, got < 0 );
+                        ASSERT_EQUALS( expected == 0, got == 0 );
+                        ASSERT_EQUALS( expected == 0, fieldNamesEqual( l, r ) );
+                    }
+                }
+            }
+        }
+    };
+
     class ComparatorTest {
     public:
         BSONObj one( string s ) {
@@ -2230,6 +2259,7 @@ namespace JsobjTests {
             add< MinMaxKeyBuilder >();
             add< MinMaxElementTest >();
             add< ComparatorTest >();
+            add< FieldNameCompareTest >();
             add< ExtractFieldsTest >();
             add< external_sort::Basic1 >();
             add< external_sort::Basic2 >();
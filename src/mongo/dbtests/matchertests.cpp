@@ -119,6 +119,46 @@ namespace MatcherTests {
         }
     };
 
+    class MultipleFields {
+    public:
+        void run() {
+            Matcher m( fromjson( "{a:1,'b.c':2,d:{$gt:3},e:{$in:[4,5]},f:{$ne:6},g:{$exists:false}}" ) );
+            ASSERT( m.matches( fromjson( "{z:0,a:1,b:{c:2},d:4,e:5,f:7}" ) ) );
+            ASSERT( m.matches( fromjson( "{a:1,b:[{c:1},{c:2}],d:4,e:5}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:1,b:{c:2},d:4,e:5,f:7,g:1}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:1,b:{c:3},d:4,e:5}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:1,b:{c:2},d:4,e:5,f:6}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:1,b:{c:2},e:5}" ) ) );
+            // the first of duplicate fields is the one matched, as with getField()
+            ASSERT( m.matches( BSON( "a" << 1 << "a" << 2 << "b" << BSON( "c" << 2 ) << "d" << 4 << "e" << 4 ) ) );
+            ASSERT( !m.matches( BSON( "a" << 2 << "a" << 1 << "b" << BSON( "c" << 2 ) << "d" << 4 << "e" << 4 ) ) );
+        }
+    };
+
+    class InMixedTypes {
+    public:
+        void run() {
+            Matcher m( fromjson( "{a:{$in:[1,'x',null,2.5]},b:{$nin:[1,'x']}}" ) );
+            ASSERT( m.matches( fromjson( "{a:2.5}" ) ) );
+            ASSERT( m.matches( fromjson( "{a:1.0}" ) ) );
+            ASSERT( m.matches( fromjson( "{a:'x',b:2}" ) ) );
+            ASSERT( m.matches( fromjson( "{}" ) ) );
+            ASSERT( m.matches( fromjson( "{a:[3,1]}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:'y'}" ) ) );
+            ASSERT( !m.matches( fromjson( "{a:1,b:'x'}" ) ) );
+        }
+    };
+
+    class ElemMatchKeyOrder {
+    public:
+        void run() {
+            // predicates are evaluated out of order, but the reported array position follows the query
+            Matcher m( fromjson( "{x:{$gt:0},y:1}" ) );
+            MatchDetails details;
+            ASSERT( m.matches( fromjson( "{x:[0,3],y:[1]}" ), &details ) );
+            ASSERT_EQUALS( string( "0" ), string( details._elemMatchKey ) );
+        }
+    };
 
     class TimingBase {
     public:
@@ -132,6 +172,20 @@ namespace MatcherTests {
         }
     };
 
+    class MultikeyKeyMatch {
+    public:
+        void run() {
+            ASSERT( Matcher( fromjson( "{a:{$gt:1,$lt:5}}" ) ).multikeyKeyMatch() == false );
+            ASSERT( Matcher( fromjson( "{a:{$gt:1},b:{$in:[1,2]}}" ) ).multikeyKeyMatch() );
+            ASSERT( Matcher( fromjson( "{'a.b':1,c:2}" ) ).multikeyKeyMatch() );
+            ASSERT( Matcher( fromjson( "{'a.b':1,'a.c':2}" ) ).multikeyKeyMatch() == false );
+            ASSERT( Matcher( fromjson( "{a:null}" ) ).multikeyKeyMatch() == false );
+            ASSERT( Matcher( fromjson( "{a:{$in:[1,null]}}" ) ).multikeyKeyMatch() == false );
+            ASSERT( Matcher( fromjson( "{a:{$ne:1}}" ) ).multikeyKeyMatch() == false );
+            ASSERT( Matcher( fromjson( "{a:/x/}" ) ).multikeyKeyMatch() == false );
+        }
+    };
+
     class AllTiming : public TimingBase {
     public:
         void run() {
@@ -156,6 +210,10 @@ namespace MatcherTests {
             add< Size >();
             add< MixedNumericEmbedded >();
             add< AllTiming >();
+            add< MultipleFields >();
+            add< InMixedTypes >();
+            add< ElemMatchKeyOrder >();
+            add< MultikeyKeyMatch >();
         }
     } dball;
 
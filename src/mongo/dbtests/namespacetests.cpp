@@ -23,6 +23,7 @@
 
 #include "../db/db.h"
 #include "../db/json.h"
+#include "../db/fieldindex.h"
 
 #include "dbtests.h"
 
@@ -917,6 +918,44 @@ namespace NamespaceTests {
         };
         
         // also test numeric string field names
+
+        class GetKeysFromWideObject : public Base {
+        public:
+            void run() {
+                create();
+
+                BSONObjBuilder b;
+                for( int i = 0; i < FieldIndex::MinFields; ++i )
+                    b.append( string( str::stream() << "f" << i ), i );
+                b.append( "a", BSON( "b" << 4 << "c" << BSON_ARRAY( 5 << 6 ) ) );
+                b.append( "f3", "duplicate" );
+                BSONObj o = b.obj();
+
+                BSONObjSet plain;
+                id().getKeysFromObject( o, plain );
+                ASSERT( FieldIndex::forObj( o ) == 0 );
+
+                FieldIndex::Scope fis( o, 2 );
+                const FieldIndex *fi = FieldIndex::forObj( o );
+                ASSERT( fi );
+                for( int i = 0; i < FieldIndex::MinFields; ++i ) {
+                    string name = str::stream() << "f" << i;
+                    ASSERT_EQUALS( i, fi->getField( name.c_str() ).numberInt() );
+                }
+                ASSERT( fi->getField( "f3" ).isNumber() );
+                ASSERT( fi->getField( "missing" ).eoo() );
+                const char *dotted = "a.c";
+                ASSERT_EQUALS( Array, fi->getFieldDottedOrArray( dotted ).type() );
+                ASSERT_EQUALS( string( "" ), string( dotted ) );
+
+                BSONObjSet indexed;
+                id().getKeysFromObject( o, indexed );
+                checkSize( 2, indexed );
+                ASSERT( plain == indexed );
+            }
+        protected:
+            BSONObj key() const { return BSON( "a.c" << 1 << "f10" << 1 ); }
+        };
         
     } // namespace IndexDetailsTests
 
@@ -1232,6 +1271,7 @@ namespace NamespaceTests {
             add< IndexDetailsTests::GetKeysFromArrayFirstElement >();
             add< IndexDetailsTests::GetKeysFromArraySecondElement >();
             add< IndexDetailsTests::GetKeysFromSecondLevelArray >();
+            add< IndexDetailsTests::GetKeysFromWideObject >();
             add< IndexDetailsTests::ParallelArraysBasic >();
             add< IndexDetailsTests::ArraySubobjectBasic >();
             add< IndexDetailsTests::ArraySubobjectMultiFieldIndex >();
@@ -37,6 +37,7 @@
 #include "../util/checksum.h"
 #include "../util/version.h"
 #include "../db/key.h"
+#include "../db/matcher.h"
 #include "../util/compress.h"
 #include "../util/concurrency/qlock.h"
 #include <boost/filesystem/operations.hpp>
@@ -457,6 +458,74 @@ namespace PerfTests {
         }
     };
 
+    /** looks up fields towards the end of a 200 field document */
+    class BSONGetFieldWide : public NonDurTest {
+    public:
+        int n;
+        bo b;
+        string name() { return "BSONGetFieldWide"; }
+        BSONGetFieldWide() {
+            n = 0;
+            bob d;
+            for( int i = 0; i < 200; i++ ) {
+                d.append( string( str::stream() << "somewhatlongfield" << i ) , i );
+            }
+            b = d.obj();
+        }
+        void timed() {
+            if( b["somewhatlongfield150"].eoo() )
+                n++;
+            if( b["somewhatlongfield199"].eoo() )
+                n++;
+            if( b["missing"].eoo() )
+                n++;
+        }
+    };
+
+    /** compares compound index style keys that differ in their last component */
+    class BSONWoCompareKeys : public NonDurTest {
+    public:
+        int n;
+        bo a, b;
+        Ordering o;
+        string name() { return "BSONWoCompareKeys"; }
+        BSONWoCompareKeys() : o( Ordering::make( BSON( "a" << 1 << "b" << -1 << "c" << 1 ) ) ) {
+            n = 0;
+            a = BSON( "" << 12345 << "" << "some string value" << "" << 3.5 );
+            b = BSON( "" << 12345 << "" << "some string value" << "" << 4.5 );
+        }
+        void timed() {
+            if( a.woCompare( b , o , false ) < 0 )
+                n++;
+            if( a.woCompare( b ) < 0 )
+                n++;
+        }
+    };
+
+    /** a conjunction of 8 predicates against a 200 field document */
+    class MatcherWide : public NonDurTest {
+    public:
+        int n;
+        bo doc, query;
+        scoped_ptr<Matcher> m;
+        string name() { return "MatcherWide"; }
+        MatcherWide() {
+            n = 0;
+            bob d;
+            for( int i = 0; i < 200; i++ ) {
+                d.append( string( str::stream() << "field" << i ) , i );
+            }
+            doc = d.obj();
+            query = fromjson( "{field190:190,field7:{$gt:3},field150:{$in:[1,150,300]},field99:{$ne:5},"
+                              "field20:{$lte:20},field175:{$exists:true},field60:60,field120:{$gte:0}}" );
+            m.reset( new Matcher( query ) );
+        }
+        void timed() {
+            if( m->matches( doc ) )
+                n++;
+        }
+    };
+
     class KeyTest : public B {
     public:
         KeyV1Owned a,b,c;
@@ -1098,6 +1167,9 @@ namespace PerfTests {
                 add< BSONIter >();
                 add< BSONGetFields1 >();
                 add< BSONGetFields2 >();
+                add< BSONGetFieldWide >();
+                add< BSONWoCompareKeys >();
+                add< MatcherWide >();
                 //add< TaskQueueTest >();
                 add< InsertDup >();
                 add< Insert1 >();
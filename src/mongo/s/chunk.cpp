@@ -179,7 +179,8 @@ namespace mongo {
         conn.done();
     }
 
-    void Chunk::pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize /* bytes */, int maxPoints, int maxObjs ) const {
+    void Chunk::pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize /* bytes */, int maxPoints, int maxObjs ,
+                                 bool autoSplit ) const {
         // Ask the mongod holding this chunk to figure out the split points.
         ScopedDbConnection conn( getShard().getConnString() );
         BSONObj result;
@@ -191,6 +192,11 @@ namespace mongo {
         cmd.append( "maxChunkSizeBytes" , chunkSize );
         cmd.append( "maxSplitPoints" , maxPoints );
         cmd.append( "maxChunkObjects" , maxObjs );
+        if ( autoSplit ) {
+            // the shard sees the writes from every mongos, so it gets the final say on whether to look
+            cmd.appendBool( "estimate" , true );
+            cmd.append( "minBytesWritten" , chunkSize / 5 );
+        }
         BSONObj cmdObj = cmd.obj();
 
         if ( ! conn->runCommand( "admin" , cmdObj , result )) {
@@ -216,7 +222,8 @@ namespace mongo {
         if ( ! force ) {
             vector<BSONObj> candidates;
             const int maxPoints = 2;
-            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk );
+            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk ,
+                             true /* autoSplit */ );
             if ( candidates.size() <= 1 ) {
                 // no split points means there isn't enough data to split on
                 // 1 split point means we have between half the chunk size to full chunk size
@@ -886,6 +893,78 @@ namespace mongo {
         }
     }
 
+    void ChunkManager::getShardQueries( const BSONObj& query , map<Shard,BSONObj>& shardQueries ) const {
+        const char * keyField = _key.key().firstElementFieldName();
+
+        BSONElement keyElt = query[ keyField ];
+        if ( keyElt.type() != Object )
+            return;
+
+        BSONElement inElt = keyElt.embeddedObject()[ "$in" ];
+        if ( inElt.type() != Array )
+            return;
+
+        map< Shard , vector<BSONElement> > shardValues;
+        unsigned numValues = 0;
+
+        BSONForEach( value , inElt.embeddedObject() ) {
+            // regexes and arrays can match documents in any chunk
+            if ( value.type() == RegEx || value.type() == Array )
+                return;
+
+            // the value pins the first key field, the rest of the shard key is unconstrained
+            BSONObjBuilder minB;
+            BSONObjBuilder maxB;
+            minB.appendAs( value , keyField );
+            maxB.appendAs( value , keyField );
+
+            BSONObjIterator keyParts( _key.key() );
+            keyParts.next();
+            while ( keyParts.more() ) {
+                const char * keyPart = keyParts.next().fieldName();
+                minB.appendMinKey( keyPart );
+                maxB.appendMaxKey( keyPart );
+            }
+
+            set<Shard> shards;
+            getShardsForRange( shards , minB.obj() , maxB.obj() , false );
+            for ( set<Shard>::const_iterator i = shards.begin(); i != shards.end(); ++i )
+                shardValues[ *i ].push_back( value );
+
+            numValues++;
+        }
+
+        for ( map< Shard , vector<BSONElement> >::const_iterator i = shardValues.begin(); i != shardValues.end(); ++i ) {
+            // this shard needs every value, the original query is fine
+            if ( i->second.size() == numValues )
+                continue;
+
+            BSONObjBuilder b;
+            BSONForEach( e , query ) {
+                if ( strcmp( e.fieldName() , keyField ) != 0 ) {
+                    b.append( e );
+                    continue;
+                }
+
+                BSONObjBuilder sub( b.subobjStart( keyField ) );
+                BSONForEach( op , keyElt.embeddedObject() ) {
+                    if ( strcmp( op.fieldName() , "$in" ) != 0 ) {
+                        sub.append( op );
+                        continue;
+                    }
+
+                    BSONArrayBuilder values( sub.subarrayStart( "$in" ) );
+                    for ( vector<BSONElement>::const_iterator v = i->second.begin(); v != i->second.end(); ++v )
+                        values.append( *v );
+                    values.done();
+                }
+                sub.done();
+            }
+
+            shardQueries[ i->first ] = b.obj();
+        }
+    }
+
     void ChunkManager::getAllShards( set<Shard>& all ) const {
         all.insert(_shards.begin(), _shards.end());
     }
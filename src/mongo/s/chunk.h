@@ -129,8 +129,11 @@ namespace mongo {
          * @param chunkSize chunk size to target in bytes
          * @param maxPoints limits the number of split points that are needed, zero is max (optional)
          * @param maxObjs limits the number of objects in each chunk, zero is as max (optional)
+         * @param autoSplit if true, the shard estimates the split points from its index and may skip the lookup
+         *        altogether if it hasn't seen enough writes to this chunk since the last one (optional)
          */
-        void pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize , int maxPoints = 0, int maxObjs = 0) const;
+        void pickSplitVector( vector<BSONObj>& splitPoints , int chunkSize , int maxPoints = 0, int maxObjs = 0,
+                              bool autoSplit = false ) const;
 
         //
         // migration support
@@ -316,6 +319,13 @@ namespace mongo {
         void getAllShards( set<Shard>& all ) const;
         void getShardsForRange(set<Shard>& shards, const BSONObj& min, const BSONObj& max, bool fullKeyReq = true) const; // [min, max)
 
+        /**
+         * For a query with a $in on the first shard key field, computes the query each shard
+         * should receive, with the $in list narrowed to the values that shard's chunks can hold.
+         * Shards that would receive the original query are not added to shardQueries.
+         */
+        void getShardQueries( const BSONObj& query , map<Shard,BSONObj>& shardQueries ) const;
+
         ChunkMap getChunkMap() const { return _chunkMap; }
 
         /**
@@ -32,6 +32,7 @@ namespace mongo {
         assert( cursor );
         _cursor = cursor;
 
+        _ns = q.ns;
         _skip = q.ntoskip;
         _ntoreturn = q.ntoreturn;
 
@@ -45,6 +46,22 @@ namespace mongo {
         }
         else
             _lastAccessMillis = Listener::getElapsedTimeMillis();
+
+        _createdMillis = Listener::getElapsedTimeMillis();
+        _bytesSent = 0;
+        _docsSent = 0;
+        _batches = 0;
+        _pendingBytes = 0;
+        _pendingDocs = 0;
+        _pendingBatches = 0;
+
+        ParallelSortClusteredCursor * pcursor = dynamic_cast<ParallelSortClusteredCursor*>( cursor );
+        if ( pcursor ) {
+            set<Shard> shards;
+            pcursor->getQueryShards( shards );
+            for ( set<Shard>::iterator i = shards.begin(); i != shards.end(); ++i )
+                _shards.push_back( i->getName() );
+        }
     }
 
     ShardedClientCursor::~ShardedClientCursor() {
@@ -68,6 +85,13 @@ namespace mongo {
     void ShardedClientCursor::accessed() {
         if ( _lastAccessMillis > 0 )
             _lastAccessMillis = Listener::getElapsedTimeMillis();
+
+        _batches += _pendingBatches;
+        _bytesSent += _pendingBytes;
+        _docsSent += _pendingDocs;
+        _pendingBatches = 0;
+        _pendingBytes = 0;
+        _pendingDocs = 0;
     }
 
     long long ShardedClientCursor::idleTime( long long now ) {
@@ -76,6 +100,20 @@ namespace mongo {
         return now - _lastAccessMillis;
     }
 
+    void ShardedClientCursor::appendStats( BSONObjBuilder& b , long long now ) const {
+        b.appendNumber( "id" , _id );
+        b.append( "ns" , _ns );
+        b.append( "shards" , _shards );
+        b.append( "batches" , _batches );
+        b.appendNumber( "docs" , _docsSent );
+        b.appendNumber( "bytes" , _bytesSent );
+        b.appendNumber( "ageMillis" , now - _createdMillis );
+        if ( _lastAccessMillis )
+            b.appendNumber( "idleMillis" , now - _lastAccessMillis );
+        else
+            b.appendBool( "noTimeout" , true );
+    }
+
     bool ShardedClientCursor::sendNextBatchAndReply( Request& r ){
         BufBuilder buffer( INIT_REPLY_BUFFER_SIZE );
         int docCount = 0;
@@ -136,6 +174,11 @@ namespace mongo {
         _totalSent += docCount;
         _done = ! hasMore;
 
+        // the stats are only touched under the stripe lock, see accessed()
+        _pendingBatches++;
+        _pendingBytes += buffer.len();
+        _pendingDocs += docCount;
+
         return hasMore;
     }
 
@@ -143,28 +186,35 @@ namespace mongo {
 
     long long CursorCache::TIMEOUT = 600000;
 
-    CursorCache::CursorCache()
-        :_mutex( "CursorCache" ), _shardedTotal(0) {
+    CursorCache::CursorCache() {
     }
 
     CursorCache::~CursorCache() {
         // TODO: delete old cursors?
+        size_t sharded = 0;
+        size_t refs = 0;
+        for ( int i=0; i<NumStripes; i++ ) {
+            sharded += _stripes[i].cursors.size();
+            refs += _stripes[i].refs.size();
+        }
+
         bool print = logLevel > 0;
-        if ( _cursors.size() || _refs.size() )
+        if ( sharded || refs )
             print = true;
         
         if ( print ) 
             cout << " CursorCache at shutdown - "
-                 << " sharded: " << _cursors.size()
-                 << " passthrough: " << _refs.size()
+                 << " sharded: " << sharded
+                 << " passthrough: " << refs
                  << endl;
     }
 
     ShardedClientCursorPtr CursorCache::get( long long id ) const {
         LOG(_myLogLevel) << "CursorCache::get id: " << id << endl;
-        scoped_lock lk( _mutex );
-        MapSharded::const_iterator i = _cursors.find( id );
-        if ( i == _cursors.end() ) {
+        Stripe& s = _stripe( id );
+        scoped_lock lk( s.mutex );
+        MapSharded::const_iterator i = s.cursors.find( id );
+        if ( i == s.cursors.end() ) {
             OCCASIONALLY log() << "Sharded CursorCache missing cursor id: " << id << endl;
             return ShardedClientCursorPtr();
         }
@@ -174,32 +224,64 @@ namespace mongo {
 
     void CursorCache::store( ShardedClientCursorPtr cursor ) {
         LOG(_myLogLevel) << "CursorCache::store cursor " << " id: " << cursor->getId() << endl;
-        assert( cursor->getId() );
-        scoped_lock lk( _mutex );
-        _cursors[cursor->getId()] = cursor;
-        _shardedTotal++;
+        long long id = cursor->getId();
+        assert( id );
+        Stripe& s = _stripe( id );
+        scoped_lock lk( s.mutex );
+        s.cursors[id] = cursor;
+        cursor->accessed();
+        if ( cursor->lastAccessMillis() )
+            _schedule( s , id , cursor->lastAccessMillis() + TIMEOUT );
+        s.shardedTotal++;
+    }
+
+    void CursorCache::accessed( long long id ) {
+        Stripe& s = _stripe( id );
+        scoped_lock lk( s.mutex );
+        MapSharded::iterator i = s.cursors.find( id );
+        if ( i != s.cursors.end() )
+            i->second->accessed();
     }
+
+    void CursorCache::setTimeout( long long millis ) {
+        TIMEOUT = millis;
+        for ( int i=0; i<NumStripes; i++ ) {
+            Stripe& s = _stripes[i];
+            scoped_lock lk( s.mutex );
+            for ( int k=0; k<WheelSlots; k++ )
+                s.wheel[k].clear();
+            for ( MapSharded::iterator j=s.cursors.begin(); j!=s.cursors.end(); ++j ) {
+                if ( j->second->lastAccessMillis() )
+                    _schedule( s , j->first , j->second->lastAccessMillis() + TIMEOUT );
+            }
+        }
+    }
+
     void CursorCache::remove( long long id ) {
         assert( id );
-        scoped_lock lk( _mutex );
-        _cursors.erase( id );
+        Stripe& s = _stripe( id );
+        scoped_lock lk( s.mutex );
+        // the wheel entry is dropped lazily when its slot comes due
+        s.cursors.erase( id );
     }
     
     void CursorCache::storeRef( const string& server , long long id ) {
         LOG(_myLogLevel) << "CursorCache::storeRef server: " << server << " id: " << id << endl;
         assert( id );
-        scoped_lock lk( _mutex );
-        _refs[id] = server;
+        Stripe& s = _stripe( id );
+        scoped_lock lk( s.mutex );
+        s.refs[id] = server;
     }
 
     string CursorCache::getRef( long long id ) const {
         assert( id );
-        scoped_lock lk( _mutex );
-        MapNormal::const_iterator i = _refs.find( id );
+        Stripe& s = _stripe( id );
+        scoped_lock lk( s.mutex );
+        MapNormal::const_iterator i = s.refs.find( id );
 
-        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == _refs.end() ? " NONE " : i->second ) << endl;
+        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == s.refs.end() ? " NONE " : i->second ) << endl;
 
-        if ( i == _refs.end() )
+        if ( i == s.refs.end() )
             return "";
         return i->second;
     }
@@ -213,13 +295,14 @@ namespace mongo {
             if ( x < 0 )
                 x *= -1;
 
-            scoped_lock lk( _mutex );
-            MapSharded::iterator i = _cursors.find( x );
-            if ( i != _cursors.end() )
+            Stripe& s = _stripe( x );
+            scoped_lock lk( s.mutex );
+            MapSharded::iterator i = s.cursors.find( x );
+            if ( i != s.cursors.end() )
                 continue;
 
-            MapNormal::iterator j = _refs.find( x );
-            if ( j != _refs.end() )
+            MapNormal::iterator j = s.refs.find( x );
+            if ( j != s.refs.end() )
                 continue;
 
             return x;
@@ -251,21 +334,22 @@ namespace mongo {
 
             string server;
             {
-                scoped_lock lk( _mutex );
+                Stripe& s = _stripe( id );
+                scoped_lock lk( s.mutex );
 
-                MapSharded::iterator i = _cursors.find( id );
-                if ( i != _cursors.end() ) {
-                    _cursors.erase( i );
+                MapSharded::iterator i = s.cursors.find( id );
+                if ( i != s.cursors.end() ) {
+                    s.cursors.erase( i );
                     continue;
                 }
 
-                MapNormal::iterator j = _refs.find( id );
-                if ( j == _refs.end() ) {
+                MapNormal::iterator j = s.refs.find( id );
+                if ( j == s.refs.end() ) {
                     log( LL_WARNING ) << "can't find cursor: " << id << endl;
                     continue;
                 }
                 server = j->second;
-                _refs.erase( j );
+                s.refs.erase( j );
             }
 
             LOG(_myLogLevel) << "CursorCache::found gotKillCursors id: " << id << " server: " << server << endl;
@@ -278,27 +362,94 @@ namespace mongo {
     }
 
     void CursorCache::appendInfo( BSONObjBuilder& result ) const {
-        scoped_lock lk( _mutex );
-        result.append( "sharded" , (int)_cursors.size() );
-        result.appendNumber( "shardedEver" , _shardedTotal );
-        result.append( "refs" , (int)_refs.size() );
-        result.append( "totalOpen" , (int)(_cursors.size() + _refs.size() ) );
+        int sharded = 0;
+        int refs = 0;
+        long long shardedTotal = 0;
+        for ( int i=0; i<NumStripes; i++ ) {
+            scoped_lock lk( _stripes[i].mutex );
+            sharded += _stripes[i].cursors.size();
+            refs += _stripes[i].refs.size();
+            shardedTotal += _stripes[i].shardedTotal;
+        }
+        result.append( "sharded" , sharded );
+        result.appendNumber( "shardedEver" , shardedTotal );
+        result.append( "refs" , refs );
+        result.append( "totalOpen" , sharded + refs );
     }
 
-    void CursorCache::doTimeouts() {
+    bool CursorCache::appendCursorStats( BSONObjBuilder& result , long long id ) const {
         long long now = Listener::getElapsedTimeMillis();
-        scoped_lock lk( _mutex );
-        for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
-            long long idleFor = i->second->idleTime( now );
-            if ( idleFor < TIMEOUT ) {
-                continue;
+
+        if ( id ) {
+            Stripe& s = _stripe( id );
+            scoped_lock lk( s.mutex );
+            MapSharded::const_iterator i = s.cursors.find( id );
+            if ( i == s.cursors.end() )
+                return false;
+            BSONObjBuilder b( result.subobjStart( "cursor" ) );
+            i->second->appendStats( b , now );
+            b.done();
+            return true;
+        }
+
+        BSONArrayBuilder arr( result.subarrayStart( "cursors" ) );
+        for ( int i=0; i<NumStripes; i++ ) {
+            scoped_lock lk( _stripes[i].mutex );
+            for ( MapSharded::const_iterator j=_stripes[i].cursors.begin(); j!=_stripes[i].cursors.end(); ++j ) {
+                BSONObjBuilder b( arr.subobjStart() );
+                j->second->appendStats( b , now );
+                b.done();
             }
-            log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make log(1)
-            _cursors.erase( i );
-            i = _cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
-            if ( i == _cursors.end() )
-                break;
         }
+        arr.done();
+        return true;
+    }
+
+    void CursorCache::_schedule( Stripe& s , long long id , long long expireMillis ) {
+        // never file into a slot the sweep has already passed
+        long long tick = max( expireMillis / WheelSlotMillis , s.wheelTick + 1 );
+        s.wheel[ tick % WheelSlots ].push_back( id );
+    }
+
+    void CursorCache::_doTimeouts( Stripe& s , long long now ) {
+        scoped_lock lk( s.mutex );
+
+        long long nowTick = now / WheelSlotMillis;
+        if ( s.wheelTick == 0 || nowTick - s.wheelTick > WheelSlots )
+            s.wheelTick = nowTick - WheelSlots; // first sweep, or we fell a full turn behind
+
+        while ( s.wheelTick < nowTick ) {
+            s.wheelTick++;
+
+            vector<long long> due;
+            due.swap( s.wheel[ s.wheelTick % WheelSlots ] );
+
+            for ( size_t i=0; i<due.size(); i++ ) {
+                MapSharded::iterator j = s.cursors.find( due[i] );
+                if ( j == s.cursors.end() )
+                    continue; // already removed
+
+                long long lastAccess = j->second->lastAccessMillis();
+                if ( lastAccess == 0 )
+                    continue; // no timeout
+
+                long long idleFor = now - lastAccess;
+                if ( idleFor < TIMEOUT ) {
+                    // used since it was filed, or the timeout was raised
+                    _schedule( s , due[i] , lastAccess + TIMEOUT );
+                    continue;
+                }
+
+                log() << "killing old cursor " << due[i] << " idle for: " << idleFor << "ms" << endl; // TODO: make log(1)
+                s.cursors.erase( j );
+            }
+        }
+    }
+
+    void CursorCache::doTimeouts() {
+        long long now = Listener::getElapsedTimeMillis();
+        for ( int i=0; i<NumStripes; i++ )
+            _doTimeouts( _stripes[i] , now );
     }
 
     CursorCache cursorCache;
@@ -322,13 +473,24 @@ namespace mongo {
         CmdCursorInfo() : Command( "cursorInfo", true ) {}
         virtual bool slaveOk() const { return true; }
         virtual void help( stringstream& help ) const {
-            help << " example: { cursorInfo : 1 }";
+            help << " example: { cursorInfo : 1 }\n"
+                 << " { cursorInfo : 1 , verbose : true } lists the stats of each sharded cursor\n"
+                 << " { cursorInfo : 1 , id : <cursorid> } gives the stats of one";
         }
         virtual LockType locktype() const { return NONE; }
         bool run(const string&, BSONObj& jsobj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
             cursorCache.appendInfo( result );
             if ( jsobj["setTimeout"].isNumber() )
-                CursorCache::TIMEOUT = jsobj["setTimeout"].numberLong();
+                cursorCache.setTimeout( jsobj["setTimeout"].numberLong() );
+            if ( jsobj["id"].isNumber() ) {
+                if ( ! cursorCache.appendCursorStats( result , jsobj["id"].numberLong() ) ) {
+                    errmsg = "cursor not found";
+                    return false;
+                }
+            }
+            else if ( jsobj["verbose"].trueValue() ) {
+                cursorCache.appendCursorStats( result , 0 );
+            }
             return true;
         }
     } cmdCursorInfo;
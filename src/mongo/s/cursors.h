@@ -62,10 +62,20 @@ namespace mongo {
          */
         bool sendNextBatch( Request& r, int ntoreturn, BufBuilder& buffer, int& docCount );
 
+        /**
+         * marks the cursor as used now and counts the batches sendNextBatch() built since in the stats,
+         * call through CursorCache::store() or accessed() which hold its stripe lock
+         */
         void accessed();
         /** @return idle time in ms */
         long long idleTime( long long now );
 
+        /** @return when this cursor was last used, 0 if it never times out */
+        long long lastAccessMillis() const { return _lastAccessMillis; }
+
+        /** id, namespace, shards, batches and bytes returned so far */
+        void appendStats( BSONObjBuilder& b , long long now ) const;
+
         // The default initial buffer size for sending responses.
         static const int INIT_REPLY_BUFFER_SIZE;
 
@@ -73,6 +83,7 @@ namespace mongo {
 
         ClusteredCursor * _cursor;
 
+        string _ns;
         int _skip;
         int _ntoreturn;
 
@@ -82,10 +93,31 @@ namespace mongo {
         long long _id;
         long long _lastAccessMillis; // 0 means no timeout
 
+        // stats, read under the stripe lock by appendStats()
+        long long _createdMillis;
+        long long _bytesSent;
+        long long _docsSent;
+        int _batches;
+        vector<string> _shards;
+
+        // sent by sendNextBatch() but not yet counted by accessed()
+        long long _pendingBytes;
+        int _pendingDocs;
+        int _pendingBatches;
+
     };
 
     typedef boost::shared_ptr<ShardedClientCursor> ShardedClientCursorPtr;
 
+    /**
+     * Holds the sharded cursors and passthrough cursor references of a mongos.
+     *
+     * Cursors are spread over stripes by id, each with its own mutex, so concurrent
+     * getMores for different cursors rarely contend.  Idle sharded cursors are found
+     * with a timing wheel: each cursor is filed under the slot for the time it would
+     * expire, and a sweep only looks at the slots that have come due.  A cursor used
+     * since it was filed is refiled for its new expiry time rather than killed.
+     */
     class CursorCache {
     public:
 
@@ -101,6 +133,12 @@ namespace mongo {
         void store( ShardedClientCursorPtr cursor );
         void remove( long long id );
 
+        /** marks id as used now, once a getMore on it is done */
+        void accessed( long long id );
+
+        /** sets TIMEOUT and refiles every cursor for it, so a lowered timeout applies right away */
+        void setTimeout( long long millis );
+
         void storeRef( const string& server , long long id );
 
         /** @return the server for id or "" */
@@ -110,17 +148,50 @@ namespace mongo {
 
         void appendInfo( BSONObjBuilder& result ) const ;
 
+        /**
+         * appends the stats of the sharded cursor id, or of all of them if id is 0
+         * @return false if id was given but no such cursor is open
+         */
+        bool appendCursorStats( BSONObjBuilder& result , long long id ) const;
+
         long long genId();
 
         void doTimeouts();
         void startTimeoutThread();
     private:
-        mutable mongo::mutex _mutex;
 
-        MapSharded _cursors;
-        MapNormal _refs;
+        enum { NumStripes = 16 , WheelSlots = 64 };
+
+        // width of a timing wheel slot
+        static const long long WheelSlotMillis = 1000;
+
+        struct Stripe {
+            Stripe() : mutex( "CursorCache" ) , wheelTick( 0 ) , shardedTotal( 0 ) {}
+
+            mutable mongo::mutex mutex;
+
+            MapSharded cursors;
+            MapNormal refs;
+
+            // ids of sharded cursors, in the slot of their expiry tick
+            vector<long long> wheel[WheelSlots];
+
+            // last tick the sweep has processed
+            long long wheelTick;
+
+            // sharded cursors ever stored in this stripe
+            long long shardedTotal;
+        };
+
+        Stripe& _stripe( long long id ) const { return _stripes[ (unsigned long long)id % NumStripes ]; }
+
+        /** files id in the wheel of s for expiry at expireMillis, must hold s.mutex */
+        static void _schedule( Stripe& s , long long id , long long expireMillis );
+
+        /** kills the due cursors of one stripe */
+        static void _doTimeouts( Stripe& s , long long now );
 
-        long long _shardedTotal;
+        mutable Stripe _stripes[NumStripes];
 
         static const int _myLogLevel;
     };
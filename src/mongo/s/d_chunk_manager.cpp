@@ -200,6 +200,34 @@ namespace mongo {
         return true;
     }
 
+    bool ShardChunkManager::getChunkFor( const BSONObj& obj , BSONObj* foundMin ) const {
+        assert( foundMin );
+
+        if ( _chunksMap.empty() )
+            return false;
+
+        BSONObj x = obj.extractFields( _key , false );
+        if ( x.nFields() != _key.nFields() )
+            return false;
+
+        // a query such as { a : { $gt : 5 } } doesn't pin a single chunk
+        BSONForEach( e , x ) {
+            if ( e.type() == Object && e.embeddedObject().firstElementFieldName()[0] == '$' )
+                return false;
+        }
+
+        RangeMap::const_iterator it = _chunksMap.upper_bound( x );
+        if ( it == _chunksMap.begin() )
+            return false;
+        it--;
+
+        if ( ! contains( it->first , it->second , x ) )
+            return false;
+
+        *foundMin = it->first;
+        return true;
+    }
+
     void ShardChunkManager::_assertChunkExists( const BSONObj& min , const BSONObj& max ) const {
         RangeMap::const_iterator it = _chunksMap.find( min );
         if ( it == _chunksMap.end() ) {
@@ -121,6 +121,15 @@ namespace mongo {
          */
         bool getNextChunk( const BSONObj& lookupKey, BSONObj* foundMin , BSONObj* foundMax ) const;
 
+        /**
+         * Finds the chunk in this shard that would hold a document or an equality query on the shard key.
+         *
+         * @param obj document or query containing all the sharding keys as plain values
+         * @param foundMin OUT min for the chunk holding 'obj'
+         * @return true if 'obj' carries a complete shard key and one of this shard's chunks contains it
+         */
+        bool getChunkFor( const BSONObj& obj , BSONObj* foundMin ) const;
+
         // accessors
 
         ShardChunkVersion getVersion() const { return _version; }
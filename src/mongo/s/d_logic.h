@@ -139,6 +139,36 @@ namespace mongo {
 
         bool inCriticalMigrateSection();
 
+        // split support
+
+        /**
+         * Accounts 'bytes' written to the chunk of this shard that holds 'obj'. Called by the storage layer for every
+         * record it writes, so all write paths (inserts, updates, upserts, mapReduce output) are covered. Only writes
+         * from a connection that set a version for 'ns', ie from mongos, to collections whose chunks were looked up
+         * through shouldCheckChunkForSplit() are accounted; anything else returns without taking a lock. Documents
+         * cloned in by a migration aren't counted, they were counted by the donor shard.
+         *
+         * @param ns the collection
+         * @param obj the document as written
+         * @param bytes size of the write
+         */
+        void noteChunkWrite( const string& ns , const BSONObj& obj , int bytes );
+
+        /**
+         * Decides whether a split point lookup for a chunk is worth doing, based on the bytes this shard saw
+         * written to it since the previous lookup. Several mongoses may ask about the same chunk at about the
+         * same time; only the first of them is let through and the others are turned away until more data lands.
+         * A chunk whose writes were never tracked (e.g. after a restart) is always let through.
+         *
+         * @param ns the collection
+         * @param chunkMin min boundary of the chunk
+         * @param minBytesWritten bytes that need to have been written since the previous lookup
+         * @param bytesWritten OUT bytes written since the previous lookup, if known
+         * @return true if the lookup should go ahead, in which case the chunk's counter is reset
+         */
+        bool shouldCheckChunkForSplit( const string& ns , const BSONObj& chunkMin , long long minBytesWritten ,
+                                       long long* bytesWritten );
+
     private:
         bool _enabled;
 
@@ -157,6 +187,29 @@ namespace mongo {
         // a ShardChunkManager carries all state we need for a collection at this shard, including its version information
         typedef map<string,ShardChunkManagerPtr> ChunkManagersMap;
         ChunkManagersMap _chunks;
+
+        // bytes written per chunk, keyed by the chunk's min, since the last split point lookup for that chunk
+        struct ChunkWrites {
+            ChunkWrites() : bytes(0) , lookedUp(false) {}
+            long long bytes;
+            bool lookedUp;    // true once a lookup has reset 'bytes'; only then does 'bytes' cover the whole chunk
+        };
+        typedef map<BSONObj,ChunkWrites,BSONObjCmp> ChunkWritesMap;
+        struct NSChunkWrites {
+            ShardChunkManagerPtr manager; // copy of _chunks[ns], so that writers need not take _mutex
+            ChunkWritesMap chunks;
+        };
+        typedef map<string,NSChunkWrites> NSChunkWritesMap;
+
+        // protects _chunkWrites; when both are needed, _mutex is taken first
+        mutable mongo::mutex _writesMutex;
+        NSChunkWritesMap _chunkWrites;
+
+        /** installs (or, if null, drops) the chunk manager of 'ns' for both maps above, _mutex must be held */
+        void _setChunkManager( const string& ns , const ShardChunkManagerPtr& p );
+
+        /** forgets the write counters of chunks in [min,max), _mutex must be held */
+        void _forgetChunkWrites( const string& ns , const BSONObj& min , const BSONObj& max );
     };
 
     extern ShardingState shardingState;
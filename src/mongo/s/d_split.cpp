@@ -236,6 +236,157 @@ namespace mongo {
         }
     } cmdCheckShardingIndex;
 
+    /**
+     * Estimates split points for an index range from the shape of the btree, without visiting every key.
+     *
+     * The buckets along the path from the root to the range's first key give the average number of keys per
+     * bucket and, from that, the expected number of keys under a bucket at each height. Only the levels whose
+     * keys are spaced closely enough (a small fraction of the desired chunk size) are walked; each subtree below
+     * them is accounted for with its expected size. This touches about a bucket per split point instead of every
+     * leaf in the chunk.
+     */
+    template< class V >
+    class SplitPointEstimator : boost::noncopyable {
+    public:
+        typedef typename BtreeBucket<V>::Key Key;
+
+        SplitPointEstimator( const IndexDetails& idx , const BSONObj& min , const BSONObj& max ,
+                             long long keyCount , long long maxSplitPoints )
+            : _idx( idx ) , _ordering( Ordering::make( idx.keyPattern() ) ) , _min( min ) , _max( max ) ,
+              _keyCount( keyCount ) , _maxSplitPoints( maxSplitPoints ) , _level( 0 ) , _count( 0 ) , _seen( 0 ) {
+        }
+
+        /**
+         * @param splitKeys OUT split points, in index key format (no field names)
+         * @return false if the tree is too small or too shallow for an estimate to be any cheaper than a scan
+         */
+        bool run( vector<BSONObj>& splitKeys ) {
+            // Sample the buckets along the path to the first key in range.
+            vector<int> pathN;
+            DiskLoc loc = _idx.head;
+            while ( ! loc.isNull() ) {
+                const BtreeBucket<V>* b = loc.btree<V>();
+                pathN.push_back( b->getN() );
+                int i = 0;
+                while ( i < b->getN() && _cmp( b->keyNode( i ).key , _min ) < 0 )
+                    i++;
+                loc = _child( b , i );
+            }
+
+            // The root's occupancy says little about the rest of the tree, so it is left out of the average.
+            if ( pathN.size() < 2 )
+                return false;
+            double keysPerBucket = 0;
+            for ( unsigned i = 1; i < pathN.size(); i++ )
+                keysPerBucket += pathN[i];
+            keysPerBucket /= pathN.size() - 1;
+
+            _subtree.push_back( keysPerBucket );
+            for ( unsigned h = 1; h < pathN.size(); h++ )
+                _subtree.push_back( keysPerBucket + ( keysPerBucket + 1 ) * _subtree[h-1] );
+
+            // Walk down to the lowest level whose keys are at most an eighth of a chunk apart. If that would be
+            // the leaves, a plain index scan is just as good.
+            const double spacing = _keyCount / 8.0;
+            if ( _subtree[0] > spacing )
+                return false;
+            _level = 1;
+            while ( _level + 1 < (int)pathN.size() && _subtree[_level] <= spacing )
+                _level++;
+
+            _visit( _idx.head , pathN.size() - 1 , splitKeys );
+            return true;
+        }
+
+        /** @return estimated number of keys in the range walked so far */
+        long long keysSeen() const { return _seen; }
+
+    private:
+        int _cmp( const Key& key , const BSONObj& bound ) const {
+            return key.toBson().woCompare( bound , _ordering , false );
+        }
+
+        static DiskLoc _child( const BtreeBucket<V>* b , int i ) {
+            return DiskLoc( i == b->getN() ? b->getNextChild() : b->k( i ).prevChildBucket );
+        }
+
+        /** @return true when the walk is over, either past the range or with enough split points */
+        bool _visit( const DiskLoc& loc , int height , vector<BSONObj>& splitKeys ) {
+            const BtreeBucket<V>* b = loc.btree<V>();
+            for ( int i = 0; i <= b->getN(); i++ ) {
+                const bool last = ( i == b->getN() );
+
+                // keys below a key that is itself below min are all out of range
+                if ( ! last && _cmp( b->keyNode( i ).key , _min ) < 0 )
+                    continue;
+
+                DiskLoc child = _child( b , i );
+                if ( ! child.isNull() ) {
+                    if ( height - 1 >= _level ) {
+                        if ( _visit( child , height - 1 , splitKeys ) )
+                            return true;
+                    }
+                    else {
+                        _add( (long long)_subtree[height-1] );
+                    }
+                }
+
+                if ( last )
+                    break;
+
+                typename BtreeBucket<V>::KeyNode kn = b->keyNode( i );
+                if ( _cmp( kn.key , _max ) >= 0 )
+                    return true;
+
+                _add( 1 );
+                if ( _count > _keyCount && b->isUsed( i ) ) {
+                    BSONObj key = kn.key.toBson();
+                    if ( key.woCompare( _min , _ordering , false ) != 0 &&
+                         ( splitKeys.empty() || key.woCompare( splitKeys.back() , _ordering , false ) != 0 ) ) {
+                        splitKeys.push_back( key.getOwned() );
+                        _count = 0;
+                        if ( _maxSplitPoints && (long long)splitKeys.size() >= _maxSplitPoints )
+                            return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void _add( long long n ) {
+            _count += n;
+            _seen += n;
+        }
+
+        const IndexDetails& _idx;
+        const Ordering _ordering;
+        const BSONObj _min;
+        const BSONObj _max;
+        const long long _keyCount;
+        const long long _maxSplitPoints;
+
+        vector<double> _subtree;    // expected number of keys under a bucket, by height above the leaves
+        int _level;                 // lowest height walked
+        long long _count;           // keys accounted for since the last split point
+        long long _seen;
+    };
+
+    /** @return true if an estimate was made, see SplitPointEstimator */
+    static bool estimateSplitKeys( const IndexDetails& idx , const BSONObj& min , const BSONObj& max ,
+                                   long long keyCount , long long maxSplitPoints ,
+                                   vector<BSONObj>& splitKeys , long long* keysSeen ) {
+        if ( idx.version() == 1 ) {
+            SplitPointEstimator<V1> e( idx , min , max , keyCount , maxSplitPoints );
+            bool ok = e.run( splitKeys );
+            *keysSeen = e.keysSeen();
+            return ok;
+        }
+        SplitPointEstimator<V0> e( idx , min , max , keyCount , maxSplitPoints );
+        bool ok = e.run( splitKeys );
+        *keysSeen = e.keysSeen();
+        return ok;
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -251,6 +402,9 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  'estimate' derives split points from the index's btree shape instead of scanning the range\n"
+                 "  'minBytesWritten' skips the lookup unless this shard saw that many bytes written to the chunk\n"
+                 "  since the previous lookup with that option\n"
                  "NOTE: This command may take a while to run";
         }
 
@@ -294,6 +448,23 @@ namespace mongo {
                 maxChunkObjects = MaxChunkObjectsElem.numberLong();
             }
 
+            bool estimate = jsobj["estimate"].trueValue();
+
+            // When asked, let the shard's own record of writes to this chunk decide whether it is worth looking.
+            // This keeps several mongoses, each seeing part of the writes, from scanning the same chunk in turn.
+            long long minBytesWritten = jsobj["minBytesWritten"].numberLong();
+            if ( minBytesWritten > 0 && shardingState.enabled() ) {
+                long long bytesWritten = 0;
+                if ( ! shardingState.shouldCheckChunkForSplit( ns , min , minBytesWritten , &bytesWritten ) ) {
+                    LOG(1) << "skipping split points lookup for chunk " << ns << " " << min << " -->> " << max
+                           << ", only " << bytesWritten << " bytes written since the last one" << endl;
+                    vector<BSONObj> emptyVector;
+                    result.append( "splitKeys" , emptyVector );
+                    result.appendNumber( "bytesWritten" , bytesWritten );
+                    return true;
+                }
+            }
+
             vector<BSONObj> splitKeys;
 
             {
@@ -370,12 +541,33 @@ namespace mongo {
                 }
                 
                 //
-                // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
+                // 2.a If an estimate is good enough, take the split points from the btree's upper levels.
+                //
+                
+                Timer timer;
+                if ( estimate && ! force ) {
+                    long long keysSeen = 0;
+                    if ( estimateSplitKeys( *idx , min , max , keyCount , maxSplitPoints , splitKeys , &keysSeen ) ) {
+                        for ( vector<BSONObj>::iterator it = splitKeys.begin(); it != splitKeys.end() ; ++it ) {
+                            *it = it->replaceFieldNames( idx->keyPattern() ).clientReadable();
+                        }
+                        
+                        LOG(1) << "estimated " << splitKeys.size() << " split points for chunk " << ns << " " << min
+                               << " -->> " << max << " over about " << keysSeen << " keys in " << timer.millis()
+                               << "ms" << endl;
+                        
+                        result.append( "splitKeys" , splitKeys );
+                        result.appendBool( "estimated" , true );
+                        return true;
+                    }
+                }
+                
+                //
+                // 2.b Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
                 //    instances of a given key value live in the same chunk.
                 //
                 
-                Timer timer;
                 long long currCount = 0;
                 long long numChunks = 0;
                 
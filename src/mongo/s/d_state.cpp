@@ -46,7 +46,8 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false) , _mutex( "ShardingState" ),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _writesMutex( "ShardingStateWrites" ) {
     }
 
     void ShardingState::enable( const string& server ) {
@@ -108,6 +109,8 @@ namespace mongo {
         _shardName.clear();
         _shardHost.clear();
         _chunks.clear();
+        scoped_lock wlk( _writesMutex );
+        _chunkWrites.clear();
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
@@ -154,7 +157,8 @@ namespace mongo {
         version = ( p->getNumChunks() > 1 ) ? version : ShardChunkVersion( 0 , 0 );
 
         ShardChunkManagerPtr cloned( p->cloneMinus( min , max , version ) );
-        _chunks[ns] = cloned;
+        _setChunkManager( ns , cloned );
+        _forgetChunkWrites( ns , min , max );
     }
 
     void ShardingState::undoDonateChunk( const string& ns , const BSONObj& min , const BSONObj& max , ShardChunkVersion version ) {
@@ -163,7 +167,7 @@ namespace mongo {
         ChunkManagersMap::const_iterator it = _chunks.find( ns );
         assert( it != _chunks.end() ) ;
         ShardChunkManagerPtr p( it->second->clonePlus( min , max , version ) );
-        _chunks[ns] = p;
+        _setChunkManager( ns , p );
     }
 
     void ShardingState::splitChunk( const string& ns , const BSONObj& min , const BSONObj& max , const vector<BSONObj>& splitKeys ,
@@ -173,13 +177,92 @@ namespace mongo {
         ChunkManagersMap::const_iterator it = _chunks.find( ns );
         assert( it != _chunks.end() ) ;
         ShardChunkManagerPtr p( it->second->cloneSplit( min , max , splitKeys , version ) );
-        _chunks[ns] = p;
+        _setChunkManager( ns , p );
+        _forgetChunkWrites( ns , min , max );
     }
 
     void ShardingState::resetVersion( const string& ns ) {
         scoped_lock lk( _mutex );
 
-        _chunks.erase( ns );
+        _setChunkManager( ns , ShardChunkManagerPtr() );
+    }
+
+    void ShardingState::_setChunkManager( const string& ns , const ShardChunkManagerPtr& p ) {
+        if ( p )
+            _chunks[ns] = p;
+        else
+            _chunks.erase( ns );
+
+        scoped_lock lk( _writesMutex );
+        if ( ! p ) {
+            _chunkWrites.erase( ns );
+            return;
+        }
+
+        NSChunkWritesMap::iterator i = _chunkWrites.find( ns );
+        if ( i != _chunkWrites.end() )
+            i->second.manager = p;
+    }
+
+    void ShardingState::noteChunkWrite( const string& ns , const BSONObj& obj , int bytes ) {
+        // writes to a sharded collection come from mongos with a version for it set on the
+        // connection, which is thread local. other writes, eg to unsharded collections, don't lock
+        ShardedConnectionInfo* info = ShardedConnectionInfo::get( false );
+        if ( ! info || info->getVersion( ns ) == 0 )
+            return;
+
+        scoped_lock lk( _writesMutex );
+
+        // only collections somebody asked about are tracked, which keeps unsharded writes to a map miss
+        NSChunkWritesMap::iterator i = _chunkWrites.find( ns );
+        if ( i == _chunkWrites.end() || ! i->second.manager )
+            return;
+
+        BSONObj chunkMin;
+        if ( ! i->second.manager->getChunkFor( obj , &chunkMin ) )
+            return;
+
+        ChunkWritesMap::iterator j = i->second.chunks.find( chunkMin );
+        if ( j != i->second.chunks.end() )
+            j->second.bytes += bytes;
+    }
+
+    bool ShardingState::shouldCheckChunkForSplit( const string& ns , const BSONObj& chunkMin , long long minBytesWritten ,
+                                                  long long* bytesWritten ) {
+        scoped_lock lk( _mutex );
+
+        ChunkManagersMap::const_iterator it = _chunks.find( ns );
+        if ( it == _chunks.end() ) {
+            // without a chunk manager writes to the collection can't be attributed, so the counter isn't fed
+            *bytesWritten = 0;
+            return true;
+        }
+
+        scoped_lock wlk( _writesMutex );
+
+        NSChunkWrites& nsw = _chunkWrites[ns];
+        nsw.manager = it->second;
+
+        ChunkWrites& w = nsw.chunks[chunkMin.getOwned()];
+        *bytesWritten = w.bytes;
+
+        if ( w.lookedUp && w.bytes < minBytesWritten )
+            return false;
+
+        w.bytes = 0;
+        w.lookedUp = true;
+        return true;
+    }
+
+    void ShardingState::_forgetChunkWrites( const string& ns , const BSONObj& min , const BSONObj& max ) {
+        scoped_lock lk( _writesMutex );
+
+        NSChunkWritesMap::iterator i = _chunkWrites.find( ns );
+        if ( i == _chunkWrites.end() )
+            return;
+
+        ChunkWritesMap& m = i->second.chunks;
+        m.erase( m.lower_bound( min ) , m.lower_bound( max ) );
     }
 
     bool ShardingState::trySetVersion( const string& ns , ConfigVersion& version /* IN-OUT */ ) {
@@ -240,7 +323,7 @@ namespace mongo {
             // make sure we keep the freshest config info only
             ChunkManagersMap::const_iterator it = _chunks.find( ns );
             if ( it == _chunks.end() || p->getVersion() >= it->second->getVersion() ) {
-                _chunks[ns] = p;
+                _setChunkManager( ns , p );
             }
 
             ShardChunkVersion oldVersion = version;
@@ -270,6 +353,25 @@ namespace mongo {
             bb.done();
         }
 
+        {
+            BSONObjBuilder bb( b.subobjStart( "chunkWrites" ) );
+
+            scoped_lock lk(_writesMutex);
+
+            for ( NSChunkWritesMap::const_iterator i = _chunkWrites.begin(); i != _chunkWrites.end(); ++i ) {
+                const ChunkWritesMap& m = i->second.chunks;
+                long long bytes = 0;
+                for ( ChunkWritesMap::const_iterator j = m.begin(); j != m.end(); ++j )
+                    bytes += j->second.bytes;
+
+                BSONObjBuilder nb( bb.subobjStart( i->first ) );
+                nb.appendNumber( "chunks" , (long long)m.size() );
+                nb.appendNumber( "bytesSinceLastCheck" , bytes );
+                nb.done();
+            }
+            bb.done();
+        }
+
     }
 
     bool ShardingState::needShardChunkManager( const string& ns ) const {
@@ -476,5 +476,6 @@ void mongo::dbexit( ExitCode rc, const char *why, bool tryToGetLock ) {
           << " rc:" << rc
           << " " << ( why ? why : "" )
           << endl;
+    Logstream::stopAsyncWriter();
     ::exit(rc);
 }
@@ -289,9 +289,6 @@ namespace mongo {
         bool _setVersion;
     };
 
-
-    extern DBConnectionPool shardConnectionPool;
-
     class ShardingConnectionHook : public DBConnectionHook {
     public:
 
@@ -29,6 +29,8 @@ namespace mongo {
     /**
      * holds all the actual db connections for a client to various servers
      * 1 per thread, so doesn't have to be thread safe
+     * the connection kept for each host is parked in shardConnectionPool, so it doesn't count against the
+     * host's in use limit while idle
      */
     class ClientConnections : boost::noncopyable {
     public:
@@ -55,7 +57,7 @@ namespace mongo {
                         delete ss->avail;
                     }
                     else
-                        release( addr , ss->avail );
+                        shardConnectionPool.releaseParked( addr , ss->avail );
                     ss->avail = 0;
                 }
                 delete ss;
@@ -73,14 +75,18 @@ namespace mongo {
             if ( s->avail ) {
                 DBClientBase* c = s->avail;
                 s->avail = 0;
-                try {
-                    shardConnectionPool.onHandedOut( c );
-                }
-                catch ( std::exception& ) {
-                    delete c;
-                    throw;
+                // at the limit, it goes to the pool and we wait our turn below
+                if ( shardConnectionPool.unpark( addr , c ) ) {
+                    try {
+                        shardConnectionPool.onHandedOut( c );
+                    }
+                    catch ( std::exception& ) {
+                        shardConnectionPool.decrementEgress( addr , c );
+                        delete c;
+                        throw;
+                    }
+                    return c;
                 }
-                return c;
             }
 
             s->created++;
@@ -90,10 +96,12 @@ namespace mongo {
         void done( const string& addr , DBClientBase* conn ) {
             Status* s = _hosts[addr];
             assert( s );
-            if ( s->avail ) {
+            // don't hold on to a connection other threads are waiting for
+            if ( s->avail || conn->isFailed() || shardConnectionPool.isAtLimit( addr ) ) {
                 release( addr , conn );
                 return;
             }
+            shardConnectionPool.park( addr , conn );
             s->avail = conn;
         }
 
@@ -122,8 +130,10 @@ namespace mongo {
                     s = new Status();
                 }
 
-                if( ! s->avail )
+                if( ! s->avail ) {
                     s->avail = shardConnectionPool.get( sconnString );
+                    shardConnectionPool.park( sconnString , s->avail );
+                }
 
                 versionManager.checkShardVersionCB( s->avail, ns, false, 1 );
 
@@ -210,6 +220,7 @@ namespace mongo {
     void ShardConnection::kill() {
         if ( _conn ) {
             if( versionManager.isVersionableCB( _conn ) ) versionManager.resetShardVersionCB( _conn );
+            shardConnectionPool.decrementEgress( _addr , _conn );
             delete _conn;
             _conn = 0;
             _finishedInit = true;
@@ -156,7 +156,7 @@ namespace mongo {
 
                 if ( hasMore ) {
                     // still more data
-                    cursor->accessed();
+                    cursorCache.accessed( id );
                 }
                 else {
                     // we've exhausted the cursor
@@ -224,6 +224,26 @@ namespace mongo {
 
     }
 
+    void Scope::snapshotGlobals() {
+        execSetup( "if ( typeof ___poolGlobals == 'undefined' ) ___poolGlobals = {};"
+                   "for ( var ___k in this ) ___poolGlobals[___k] = true;" , "snapshot globals" );
+    }
+
+    void Scope::resetGlobals() {
+        // var declarations can't be deleted, those are left undefined.
+        // __cf__ globals hold the functions compiled by _createFunction, see _cachedFunctions
+        execSetup( "for ( var ___k in this ) {"
+                   "    if ( ___poolGlobals[___k] || ___k.indexOf( '__cf__' ) == 0 ) continue;"
+                   "    delete this[___k];"
+                   "    if ( ___k in this ) this[___k] = undefined;"
+                   "}" , "reset globals" );
+        _loadedVersion = 0;
+    }
+
+    // compiled functions found in, or added to, the cache of their scope
+    static AtomicUInt functionCacheHits;
+    static AtomicUInt functionCacheMisses;
+
     ScriptingFunction Scope::createFunction( const char * code ) {
         if ( code[0] == '/' && code [1] == '*' ) {
             code += 2;
@@ -236,8 +256,11 @@ namespace mongo {
             }
         }
         map<string,ScriptingFunction>::iterator i = _cachedFunctions.find( code );
-        if ( i != _cachedFunctions.end() )
+        if ( i != _cachedFunctions.end() ) {
+            functionCacheHits++;
             return i->second;
+        }
+        functionCacheMisses++;
         ScriptingFunction f = _createFunction( code );
         _cachedFunctions[code] = f;
         return f;
@@ -266,79 +289,154 @@ namespace mongo {
 
     typedef map< string , list<Scope*> > PoolToScopes;
 
-    class ScopeCache {
-    public:
+    // pool statistics
+    static AtomicUInt poolHits;
+    static AtomicUInt poolMisses;
+    static AtomicUInt poolRetired;
+    static AtomicUInt poolIdle;
+    static AtomicUInt poolWarmed;
 
-        ScopeCache() : _mutex("ScopeCache") {
-            _magic = 17;
+    /** a new scope for a pool, with its globals snapshotted for Scope::resetGlobals() */
+    static Scope * newPoolScope() {
+        Scope * s = globalScriptEngine->newScope();
+        try {
+            s->snapshotGlobals();
+        }
+        catch ( ... ) {
+            delete s;
+            throw;
         }
+        return s;
+    }
 
-        ~ScopeCache() {
-            assert( _magic == 17 );
-            _magic = 1;
+    /**
+     * idle scopes by pool (database), shared by all connections. a scope is cleaned by PooledScope
+     * before it comes back, so a connection doesn't see what another left behind. pools that ran
+     * low are topped up to MinIdlePerPool in the background by warm(), so operations don't wait
+     * for a context to be set up
+     */
+    class ScopeCache {
+    public:
+        /** most idle scopes kept for one pool, and for all of them */
+        static const unsigned MaxIdlePerPool = 10;
+        static const unsigned MaxIdle = 100;
 
-            if ( inShutdown() )
-                return;
+        /** idle scopes warm() keeps ready for a pool that is in use */
+        static const unsigned MinIdlePerPool = 2;
 
-            clear();
-        }
+        /** a scope is retired after this many uses, so whatever leaks in a context doesn't build up */
+        static const int MaxUses = 100;
+
+        ScopeCache() : _mutex("ScopeCache") , _idle(0) {}
 
         void done( const string& pool , Scope * s ) {
-            scoped_lock lk( _mutex );
-            list<Scope*> & l = _pools[pool];
             bool oom = s->hasOutOfMemoryException();
+            list<Scope*> toDelete;
+            {
+                scoped_lock lk( _mutex );
+                list<Scope*> & l = _pools[pool];
+
+                // do not keep too many contexts, or use them for too long
+                if ( oom || s->getTimeUsed() > MaxUses || l.size() >= MaxIdlePerPool || _idle >= MaxIdle ) {
+                    toDelete.push_back( s );
+                }
+                else {
+                    s->reset();
+                    l.push_back( s );
+                    _idle++;
+                    poolIdle++;
+                }
 
-            // do not keep too many contexts, or use them for too long
-            if ( l.size() > 10 || s->getTimeUsed() > 100 || oom ) {
-                delete s;
-            }
-            else {
-                l.push_back( s );
-                s->reset();
-            }
-
-            if (oom) {
-                // out of mem, make some room
-                log() << "Clearing all idle JS contexts due to out of memory" << endl;
-                clear();
+                if ( oom ) {
+                    // out of mem, make some room
+                    log() << "Clearing all idle JS contexts due to out of memory" << endl;
+                    _takeAll( toDelete );
+                }
             }
+            _retire( toDelete );
         }
 
         Scope * get( const string& pool ) {
             scoped_lock lk( _mutex );
             list<Scope*> & l = _pools[pool];
-            if ( l.size() == 0 )
+            if ( l.size() <= MinIdlePerPool )
+                _low.insert( pool );
+            if ( l.size() == 0 ) {
+                poolMisses++;
                 return 0;
+            }
 
             Scope * s = l.back();
             l.pop_back();
+            _idle--;
+            poolIdle--;
+            poolHits++;
             s->reset();
             s->incTimeUsed();
             return s;
         }
 
-        void clear() {
-            set<Scope*> seen;
+        /** creates scopes for the pools that ran low since the last call */
+        void warm() {
+            set<string> low;
+            {
+                scoped_lock lk( _mutex );
+                low.swap( _low );
+            }
 
-            for ( PoolToScopes::iterator i=_pools.begin() ; i != _pools.end(); i++ ) {
-                for ( list<Scope*>::iterator j=i->second.begin(); j != i->second.end(); j++ ) {
-                    Scope * s = *j;
-                    assert( ! seen.count( s ) );
-                    delete s;
-                    seen.insert( s );
+            for ( set<string>::iterator i = low.begin(); i != low.end(); ++i ) {
+                while ( ! inShutdown() ) {
+                    {
+                        scoped_lock lk( _mutex );
+                        if ( _pools[*i].size() >= MinIdlePerPool || _idle >= MaxIdle )
+                            break;
+                    }
+
+                    // outside the lock, setting up a context takes a while
+                    Scope * s = newPoolScope();
+
+                    scoped_lock lk( _mutex );
+                    _pools[*i].push_back( s );
+                    _idle++;
+                    poolIdle++;
+                    poolWarmed++;
                 }
             }
+        }
 
+    private:
+        /** moves every idle scope to l, must hold _mutex */
+        void _takeAll( list<Scope*>& l ) {
+            for ( PoolToScopes::iterator i=_pools.begin() ; i != _pools.end(); i++ ) {
+                _idle -= i->second.size();
+                for ( unsigned k = 0; k < i->second.size(); k++ )
+                    poolIdle--;
+                l.splice( l.end() , i->second );
+            }
             _pools.clear();
         }
 
-    private:
+        /** deletes scopes outside _mutex */
+        static void _retire( list<Scope*>& l ) {
+            for ( list<Scope*>::iterator i = l.begin(); i != l.end(); ++i ) {
+                delete *i;
+                poolRetired++;
+            }
+        }
+
         PoolToScopes _pools;
+        set<string> _low; // pools get() found at or below MinIdlePerPool
         mongo::mutex _mutex;
-        int _magic;
+        unsigned _idle;
     };
 
-    thread_specific_ptr<ScopeCache> scopeCache;
+    static ScopeCache& scopeCache = *(new ScopeCache()); // never deleted, scopes may be in use at exit
+
+    /** stands in for an injected native function once the scope is back in the pool */
+    static BSONObj nativeUnbound( const BSONObj& args , void* data ) {
+        uasserted( 16147 , "native function called after the operation that injected it ended" );
+        return BSONObj();
+    }
 
     class PooledScope : public Scope {
     public:
@@ -346,18 +444,22 @@ namespace mongo {
             _real->loadStored( true );
         };
         virtual ~PooledScope() {
-            ScopeCache * sc = scopeCache.get();
-            if ( sc ) {
-                sc->done( _pool , _real );
-                _real = 0;
+            // natives may point at the state of the operation that injected them, eg mapReduce's
+            // emit, and globals belong to the connection that set them
+            try {
+                for ( set<string>::iterator i = _injected.begin(); i != _injected.end(); ++i )
+                    _real->injectNative( i->c_str() , nativeUnbound );
+                _real->resetGlobals();
             }
-            else {
-                // this means that the Scope was killed from a different thread
-                // for example a cursor got timed out that has a $where clause
-                log(3) << "warning: scopeCache is empty!" << endl;
+            catch ( std::exception& e ) {
+                log(3) << "not returning scope to the pool: " << e.what() << endl;
                 delete _real;
+                poolRetired++;
                 _real = 0;
+                return;
             }
+            scopeCache.done( _pool , _real );
+            _real = 0;
         }
 
         void reset() {
@@ -368,7 +470,11 @@ namespace mongo {
         }
 
         void localConnect( const char * dbName ) {
+            bool fresh = ! _real->isLocallyConnected();
             _real->localConnect( dbName );
+            // the globals of the connection, which the scope keeps for its next user
+            if ( fresh )
+                _real->snapshotGlobals();
         }
         void externalSetup() {
             _real->externalSetup();
@@ -449,6 +555,7 @@ namespace mongo {
         }
 
         void injectNative( const char *field, NativeFunction func, void* data ) {
+            _injected.insert( field );
             _real->injectNative( field , func, data );
         }
 
@@ -463,16 +570,13 @@ namespace mongo {
     private:
         string _pool;
         Scope * _real;
+        set<string> _injected; // unbound when the scope goes back to the pool
     };
 
     auto_ptr<Scope> ScriptEngine::getPooledScope( const string& pool ) {
-        if ( ! scopeCache.get() ) {
-            scopeCache.reset( new ScopeCache() );
-        }
-
-        Scope * s = scopeCache->get( pool );
+        Scope * s = scopeCache.get( pool );
         if ( ! s ) {
-            s = newScope();
+            s = newPoolScope();
         }
 
         auto_ptr<Scope> p;
@@ -480,11 +584,22 @@ namespace mongo {
         return p;
     }
 
+    void ScriptEngine::warmScopePools() {
+        scopeCache.warm();
+    }
+
     void ScriptEngine::threadDone() {
-        ScopeCache * sc = scopeCache.get();
-        if ( sc ) {
-            sc->clear();
-        }
+        // idle scopes are shared by all threads, a thread has none of its own to release
+    }
+
+    void ScriptEngine::appendPoolStats( BSONObjBuilder& b ) {
+        b.appendNumber( "idle" , (long long)poolIdle.get() );
+        b.appendNumber( "hits" , (long long)poolHits.get() );
+        b.appendNumber( "misses" , (long long)poolMisses.get() );
+        b.appendNumber( "retired" , (long long)poolRetired.get() );
+        b.appendNumber( "warmed" , (long long)poolWarmed.get() );
+        b.appendNumber( "functionCacheHits" , (long long)functionCacheHits.get() );
+        b.appendNumber( "functionCacheMisses" , (long long)functionCacheMisses.get() );
     }
 
     void ( *ScriptEngine::_connectCallback )( DBClientWithCommands & ) = 0;
@@ -120,6 +120,17 @@ namespace mongo {
         virtual void gc() = 0;
 
         void loadStored( bool ignoreNotConnected = false );
+        bool isLocallyConnected() const { return _localDBName.size() > 0; }
+
+        /** adds the globals this scope has now to those resetGlobals() keeps */
+        void snapshotGlobals();
+
+        /**
+         * Removes the globals added since the snapshotGlobals() calls, except compiled functions,
+         * so the scope can be handed to another connection. Stored functions are loaded again by the
+         * next loadStored().
+         */
+        void resetGlobals();
 
         /**
          if any changes are made to .system.js, call this
@@ -175,14 +186,25 @@ namespace mongo {
 
         static void setup();
 
-        /** gets a scope from the pool or a new one if pool is empty
+        /** gets a scope from the pool or a new one if pool is empty.
+         * the pools are shared by all connections. the scope goes back to its pool when deleted,
+         * with the globals it was given and the native functions injected into it removed
          * @param pool An identifier for the pool, usually the db name
          * @return the scope */
         auto_ptr<Scope> getPooledScope( const string& pool );
 
+        /**
+         * sets up scopes for the pools that ran low since the last call, so their next users find
+         * one ready. call it periodically from a thread of its own
+         */
+        static void warmScopePools();
+
         /** call this method to release some JS resources when a thread is done */
         void threadDone();
 
+        /** pool hits and misses, idle and retired scopes, and compiled function cache hits and misses */
+        static void appendPoolStats( BSONObjBuilder& b );
+
         struct Unlocker { virtual ~Unlocker() {} };
         virtual auto_ptr<Unlocker> newThreadUnlocker() { return auto_ptr< Unlocker >( new Unlocker ); }
 
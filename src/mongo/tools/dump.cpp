@@ -27,6 +27,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
+#include <boost/thread/thread.hpp>
 
 using namespace mongo;
 
@@ -42,13 +43,16 @@ class Dump : public Tool {
         FILE* _f;
     };
 public:
-    Dump() : Tool( "dump" , ALL , "" , "" , true ) {
+    Dump() : Tool( "dump" , ALL , "" , "" , true ) , _compress(false) , _numWorkers(1) , _splitMB(0) , _jobFailed(false) {
         add_options()
         ("out,o", po::value<string>()->default_value("dump"), "output directory or \"-\" for stdout")
         ("query,q", po::value<string>() , "json query" )
         ("oplog", "Use oplog for point-in-time snapshotting" )
         ("repair", "try to recover a crashed database" )
         ("forceTableScan", "force a table scan (do not use $snapshot)" )
+        ("numParallelCollections,j", po::value<int>()->default_value(1), "number of collections to dump in parallel" )
+        ("splitCollectionsOverMB", po::value<int>(), "with -j, dump collections larger than this in _id ranges of about this size in parallel" )
+        ("compress", "snappy compress the .bson files, mongorestore and bsondump read them" )
         ;
     }
 
@@ -65,20 +69,16 @@ public:
         out << "Export MongoDB data to BSON files.\n" << endl;
     }
 
-    // This is a functor that writes a BSONObj to a file
-    struct Writer {
-        Writer(FILE* out, ProgressMeter* m) :_out(out), _m(m) {}
+    // This is a functor that writes a BSONObj to a file, in blocks so threads dumping parts of a
+    // collection don't interleave within objects. Call flush() when done.
+    struct Writer : boost::noncopyable {
+        Writer(BSONFileWriter& out, ProgressMeter* m) : _out(out), _m(m), _buf(BSONFileWriter::BlockSize + 64 * 1024), _count(0) {}
 
         void operator () (const BSONObj& obj) {
-            size_t toWrite = obj.objsize();
-            size_t written = 0;
-
-            while (toWrite) {
-                size_t ret = fwrite( obj.objdata()+written, 1, toWrite, _out );
-                uassert(14035, errnoWithPrefix("couldn't write to file"), ret);
-                toWrite -= ret;
-                written += ret;
-            }
+            if ( _buf.len() && _buf.len() + obj.objsize() > BSONFileWriter::BlockSize )
+                flush();
+            _buf.appendBuf( obj.objdata() , obj.objsize() );
+            _count++;
 
             // if there's a progress bar, hit it
             if (_m) {
@@ -86,26 +86,26 @@ public:
             }
         }
 
-        FILE* _out;
+        void flush() {
+            _out.write( _buf.buf() , _buf.len() );
+            _buf.reset();
+        }
+
+        BSONFileWriter& _out;
         ProgressMeter* _m;
+        BufBuilder _buf;
+        long long _count;
     };
 
-    void doCollection( const string coll , FILE* out , ProgressMeter *m ) {
-        Query q = _query;
-
+    void doCollection( DBClientBase& connBase , const string coll , Query q , Writer& writer ) {
         int queryOptions = QueryOption_SlaveOk | QueryOption_NoCursorTimeout;
         if (startsWith(coll.c_str(), "local.oplog."))
             queryOptions |= QueryOption_OplogReplay;
-        else if ( _query.isEmpty() && !hasParam("dbpath") && !hasParam("forceTableScan") )
-            q.snapshot();
-        
-        DBClientBase& connBase = conn(true);
-        Writer writer(out, m);
 
         // use low-latency "exhaust" mode if going over the network
         if (!_usingMongos && typeid(connBase) == typeid(DBClientConnection&)) {
             DBClientConnection& conn = static_cast<DBClientConnection&>(connBase);
-            boost::function<void(const BSONObj&)> castedWriter(writer); // needed for overload resolution
+            boost::function<void(const BSONObj&)> castedWriter( boost::ref( writer ) ); // needed for overload resolution
             conn.query( castedWriter, coll.c_str() , q , NULL, queryOptions | QueryOption_Exhaust);
         }
         else {
@@ -115,6 +115,16 @@ public:
                 writer(cursor->next());
             }
         }
+        writer.flush();
+    }
+
+    void doCollection( const string coll , BSONFileWriter& out , ProgressMeter *m ) {
+        Query q = _query;
+        if ( _query.isEmpty() && !startsWith(coll.c_str(), "local.oplog.") && !hasParam("dbpath") && !hasParam("forceTableScan") )
+            q.snapshot();
+
+        Writer writer(out, m);
+        doCollection( conn(true) , coll , q , writer );
     }
 
     void writeCollectionFile( const string coll , boost::filesystem::path outputFile ) {
@@ -122,15 +132,178 @@ public:
 
         FilePtr f (fopen(outputFile.string().c_str(), "wb"));
         uassert(10262, errnoWithPrefix("couldn't open file"), f);
+        BSONFileWriter out( f , _compress );
 
         ProgressMeter m( conn( true ).count( coll.c_str() , BSONObj() , QueryOption_SlaveOk ) );
         m.setUnits("objects");
 
-        doCollection(coll, f, &m);
+        doCollection(coll, out, &m);
 
         log() << "\t\t " << m.done() << " objects" << endl;
     }
 
+    /**
+     * A collection file written by one or more jobs, each dumping an _id range. Opened by the first
+     * job to start and closed when the last one is done, so at most numParallelCollections are open.
+     */
+    struct OutputFile : boost::noncopyable {
+        OutputFile( const string& coll , const boost::filesystem::path& path , unsigned parts )
+            : coll( coll ) , path( path ) , partsLeft( parts ) , count( 0 ) , m( "dumpOutputFile" ) {}
+
+        const string coll;
+        const boost::filesystem::path path;
+        unsigned partsLeft;
+        long long count;
+        SimpleMutex m;
+        scoped_ptr<FilePtr> f;
+        scoped_ptr<BSONFileWriter> out;
+    };
+
+    /** _id index bounds of part of a collection, min inclusive and max exclusive, an empty max has no upper bound */
+    struct Range {
+        BSONObj min;
+        BSONObj max;
+    };
+
+    struct Job {
+        shared_ptr<OutputFile> file;
+        bool split;
+        Range range; // if split
+    };
+
+    /**
+     * @return _id index ranges of about splitMB each, or an empty vector to dump the collection in one go.
+     * they're index bounds rather than $gte/$lt queries, so documents with _ids of any type fall in one
+     */
+    vector<Range> splitRanges( const string& coll , long long splitMB ) {
+        vector<Range> ranges;
+        const string db = nsToDatabase( coll.c_str() );
+        BSONObj stats;
+        if ( ! conn( true ).runCommand( db , BSON( "collStats" << coll.substr( db.size() + 1 ) ) , stats ) ||
+             stats["size"].numberLong() <= splitMB * 1024 * 1024 )
+            return ranges;
+
+        BSONObj res;
+        if ( ! conn( true ).runCommand( db , BSON( "splitVector" << coll << "keyPattern" << BSON( "_id" << 1 ) <<
+                                                      "maxChunkSizeBytes" << splitMB * 1024 * 1024 <<
+                                                      "maxChunkObjects" << numeric_limits<int>::max() ) , res ) ) {
+            log() << "\tcouldn't split " << coll << ", dumping it in one piece: " << res["errmsg"].str() << endl;
+            return ranges;
+        }
+
+        vector<BSONElement> keys = res["splitKeys"].Array();
+        if ( keys.empty() )
+            return ranges;
+        for ( unsigned i = 0; i <= keys.size(); i++ ) {
+            Range r;
+            if ( i == 0 ) {
+                BSONObjBuilder b;
+                b.appendMinKey( "_id" );
+                r.min = b.obj();
+            }
+            else {
+                r.min = keys[i-1].Obj().getOwned();
+            }
+            // the last range has no max, so it includes an _id of MaxKey too
+            if ( i < keys.size() )
+                r.max = keys[i].Obj().getOwned();
+            ranges.push_back( r );
+        }
+        return ranges;
+    }
+
+    void runJobs( DBClientBase& c ) {
+        for ( unsigned i; !_jobFailed && ( i = _nextJob++ ) < _jobs.size(); ) {
+            Job& job = _jobs[i];
+            OutputFile& file = *job.file;
+
+            {
+                SimpleMutex::scoped_lock lk( file.m );
+                if ( ! file.out ) {
+                    FILE* f = fopen( file.path.string().c_str() , "wb" );
+                    uassert( 16130 , errnoWithPrefix( "couldn't open file" ) , f );
+                    file.f.reset( new FilePtr( f ) );
+                    file.out.reset( new BSONFileWriter( *file.f , _compress ) );
+                }
+            }
+
+            Query q;
+            if ( ! job.split ) {
+                q = _query;
+                if ( _query.isEmpty() && !hasParam("forceTableScan") )
+                    q.snapshot();
+            }
+            else {
+                // walks the _id index between the bounds, like $snapshot does for the whole collection
+                q.hint( BSON( "_id" << 1 ) ).minKey( job.range.min );
+                if ( ! job.range.max.isEmpty() )
+                    q.maxKey( job.range.max );
+            }
+
+            Writer writer( *file.out , NULL );
+            doCollection( c , file.coll , q , writer );
+
+            SimpleMutex::scoped_lock lk( file.m );
+            file.count += writer._count;
+            if ( --file.partsLeft == 0 ) {
+                file.out.reset();
+                file.f.reset();
+                log() << "\t" << file.coll << " to " << file.path.string() << ", " << file.count << " objects" << endl;
+            }
+        }
+    }
+
+    void runJobsThread() {
+        try {
+            scoped_ptr<DBClientBase> c( newConnection() );
+            if ( ! c ) {
+                _jobFailed = true;
+                return;
+            }
+            runJobs( *c );
+        }
+        catch ( DBException& e ) {
+            error() << "dump thread failed: " << e.toString() << endl;
+            _jobFailed = true;
+        }
+    }
+
+    /** dumps the collections of one database with _numWorkers threads, each with its own connection */
+    void writeCollectionFiles( const vector<string>& collections , const string& db , const boost::filesystem::path& outdir ) {
+        for ( unsigned i = 0; i < collections.size(); i++ ) {
+            const string& name = collections[i];
+            vector<Range> ranges;
+            if ( _splitMB > 0 && _query.isEmpty() && !_usingMongos && !hasParam("forceTableScan") )
+                ranges = splitRanges( name , _splitMB );
+
+            shared_ptr<OutputFile> file( new OutputFile( name , outdir / ( name.substr( db.size() + 1 ) + ".bson" ) ,
+                                                         std::max( (size_t)1 , ranges.size() ) ) );
+            if ( ranges.empty() ) {
+                Job job;
+                job.file = file;
+                job.split = false;
+                _jobs.push_back( job );
+            }
+            for ( unsigned k = 0; k < ranges.size(); k++ ) {
+                Job job;
+                job.file = file;
+                job.split = true;
+                job.range = ranges[k];
+                _jobs.push_back( job );
+            }
+        }
+
+        log() << "\tdumping " << collections.size() << " collections in " << _jobs.size() << " parts with " << _numWorkers << " threads" << endl;
+        _nextJob.zero();
+        boost::thread_group threads;
+        for ( int i = 0; i < _numWorkers; i++ )
+            threads.create_thread( boost::bind( &Dump::runJobsThread , this ) );
+        threads.join_all();
+        _jobs.clear();
+
+        uassert( 16131 , "dump failed, see errors above" , !_jobFailed );
+    }
+
     void writeMetadataFile( const string coll, boost::filesystem::path outputFile, 
                             map<string, BSONObj> options, multimap<string, BSONObj> indexes ) {
         log() << "\tMetadata for " << coll << " to " << outputFile.string() << endl;
@@ -167,7 +340,8 @@ public:
 
 
     void writeCollectionStdout( const string coll ) {
-        doCollection(coll, stdout, NULL);
+        BSONFileWriter out( stdout , false );
+        doCollection(coll, out, NULL);
     }
 
     void go( const string db , const boost::filesystem::path outdir ) {
@@ -227,6 +401,15 @@ public:
             collections.push_back(name);
         }
         
+        if ( _numWorkers > 1 ) {
+            for (vector<string>::iterator it = collections.begin(); it != collections.end(); ++it) {
+                const string filename = it->substr( db.size() + 1 );
+                writeMetadataFile( *it, outdir / (filename + ".metadata.json"), collectionOptions, indexes);
+            }
+            writeCollectionFiles( collections , db , outdir );
+            return;
+        }
+
         for (vector<string>::iterator it = collections.begin(); it != collections.end(); ++it) {
             string name = *it;
             const string filename = name.substr( db.size() + 1 );
@@ -336,11 +519,12 @@ public:
         log() << "writing to: " << outfile.string() << endl;
         
         FilePtr f (fopen(outfile.string().c_str(), "wb"));
+        BSONFileWriter out( f , _compress );
 
         ProgressMeter m( nsd->stats.nrecords * 2 );
         m.setUnits("objects");
         
-        Writer w( f , &m );
+        Writer w( out , &m );
 
         try {
             log() << "forward extent pass" << endl;
@@ -367,6 +551,7 @@ public:
         catch ( DBException& e ){
             error() << "ERROR: backwards extent pass failed:" << e.toString() << endl;
         }
+        w.flush();
 
         log() << "\t\t " << m.done() << " objects" << endl;
     }
@@ -411,6 +596,13 @@ public:
     }
 
     int run() {
+        _compress = hasParam( "compress" );
+        _numWorkers = std::max( 1 , getParam( "numParallelCollections" , 1 ) );
+        _splitMB = hasParam( "splitCollectionsOverMB" ) ? getParam( "splitCollectionsOverMB" , 0 ) : 0;
+        if ( _numWorkers > 1 && hasParam( "dbpath" ) ) {
+            log() << "--numParallelCollections needs a server to connect to, dumping one collection at a time" << endl;
+            _numWorkers = 1;
+        }
         
         if ( hasParam( "repair" ) ){
             warning() << "repair is a work in progress" << endl;
@@ -524,6 +716,13 @@ public:
 
     bool _usingMongos;
     BSONObj _query;
+
+    bool _compress;
+    int _numWorkers;
+    long long _splitMB;
+    vector<Job> _jobs;
+    AtomicUInt _nextJob;
+    volatile bool _jobFailed;
 };
 
 int main( int argc , char ** argv ) {
@@ -39,6 +39,7 @@ public:
         ( "local,l", po::value<string>(), "local filename for put|get (default is to use the same name as 'gridfs filename')")
         ( "type,t", po::value<string>(), "MIME type for put (default is to omit)")
         ( "replace,r", "Remove other files with same name after PUT")
+        ( "range", po::value<string>(), "for get, just bytes <first>-<last> of the file, inclusive as in an HTTP Range")
         ;
         add_hidden_options()
         ( "command" , po::value<string>() , "command (list|search|put|get)" )
@@ -118,7 +119,26 @@ public:
             }
 
             string out = getParam("local", f.getFilename());
-            f.write( out );
+            if ( hasParam( "range" ) ) {
+                string range = getParam( "range" );
+                long long first = 0 , last = -1;
+                if ( sscanf( range.c_str() , "%lld-%lld" , &first , &last ) != 2 || first < 0 || last < first ) {
+                    cerr << "ERROR: bad range: " << range << endl;
+                    return -1;
+                }
+
+                if ( out == "-" ) {
+                    f.write( cout , first , last - first + 1 );
+                }
+                else {
+                    ofstream o( out.c_str() , ios::out | ios::binary );
+                    uassert( 16138 , "couldn't open file: " + out , o.is_open() );
+                    f.write( o , first , last - first + 1 );
+                }
+            }
+            else {
+                f.write( out );
+            }
 
             if (out != "-")
                 cout << "done write to: " << out << endl;
@@ -21,6 +21,7 @@
 #include "db/json.h"
 
 #include "tool.h"
+#include "../util/queue.h"
 #include "../util/text.h"
 
 #include <fstream>
@@ -29,6 +30,7 @@
 #include <boost/program_options.hpp>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
 
 using namespace mongo;
 using std::string;
@@ -36,6 +38,109 @@ using std::stringstream;
 
 namespace po = boost::program_options;
 
+/**
+ * Splits a JSON array of objects, of any size, into the text of its elements, reading the input a
+ * block at a time. Only nesting and strings are tracked here, fromjson parses each element, so an
+ * element that isn't an object comes out as a record that fails to parse.
+ */
+class JSONArrayReader : boost::noncopyable {
+public:
+    static const int BlockSize = 1024 * 1024;
+
+    JSONArrayReader( istream* in ) : _in( in ) , _buf( new char[BlockSize] ) , _pos( 0 ) , _len( 0 ) ,
+        _started( false ) , _ended( false ) {}
+
+    /** @return false once there are no more elements */
+    bool next( string& record , long long& numBytesRead ) {
+        record.clear();
+        bool inElement = false;
+        int depth = 0;
+        bool inString = false;
+        bool escaped = false;
+        char quote = 0;
+
+        while ( ! _ended ) {
+            if ( _pos == _len && ! fill() ) {
+                uassert( 16132 , "JSON array ends inside an element" , depth == 0 && ! inString );
+                // a last element that isn't an object, with no closing ']'
+                return inElement;
+            }
+
+            int start = _pos;
+            for ( ; _pos < _len; _pos++ ) {
+                char c = _buf[_pos];
+                if ( ! inElement ) {
+                    if ( isspace( (unsigned char) c ) || ( _started && c == ',' ) )
+                        continue;
+                    if ( ! _started ) {
+                        // a UTF-8 byte order mark may come first
+                        if ( c == '\xEF' || c == '\xBB' || c == '\xBF' )
+                            continue;
+                        uassert( 16144 , "JSON array doesn't start with '['" , c == '[' );
+                        _started = true;
+                        continue;
+                    }
+                    if ( c == ']' ) {
+                        _ended = true;
+                        return false;
+                    }
+                    inElement = true;
+                    start = _pos;
+                }
+
+                if ( inString ) {
+                    if ( escaped )
+                        escaped = false;
+                    else if ( c == '\\' )
+                        escaped = true;
+                    else if ( c == quote )
+                        inString = false;
+                }
+                else if ( c == '"' || c == '\'' ) {
+                    inString = true;
+                    quote = c;
+                }
+                else if ( c == '{' || c == '[' ) {
+                    depth++;
+                }
+                else if ( depth == 0 && ( c == ',' || c == ']' ) ) {
+                    // the end of an element that isn't an object or array, the separator is left for next time
+                    record.append( _buf.get() + start , _pos - start );
+                    numBytesRead += _pos - start;
+                    return true;
+                }
+                else if ( ( c == '}' || c == ']' ) && depth > 0 && --depth == 0 ) {
+                    _pos++;
+                    record.append( _buf.get() + start , _pos - start );
+                    numBytesRead += _pos - start;
+                    return true;
+                }
+            }
+
+            if ( inElement )
+                record.append( _buf.get() + start , _pos - start );
+            numBytesRead += _pos - start;
+        }
+        return false;
+    }
+
+private:
+    bool fill() {
+        _in->read( _buf.get() , BlockSize );
+        uassert( 16145 ,  "unknown error reading file" , ! _in->bad() );
+        _pos = 0;
+        _len = _in->gcount();
+        return _len > 0;
+    }
+
+    istream* _in;
+    boost::scoped_array<char> _buf;
+    int _pos;
+    int _len;
+    bool _started;  // read the opening '['
+    bool _ended;    // read the closing ']'
+};
+
 class Import : public Tool {
 
     enum Type { JSON , CSV , TSV };
@@ -48,7 +153,9 @@ class Import : public Tool {
     bool _doimport;
     bool _jsonArray;
     vector<string> _upsertFields;
-    static const int BUF_SIZE = 1024 * 1024 * 16;
+    bool _stopOnError;
+    unsigned _batchSize;
+    scoped_ptr<JSONArrayReader> _arrayReader;
 
     void csvTokenizeRow(const string& row, vector<string>& tokens) {
         bool inQuotes = false;
@@ -107,155 +214,214 @@ class Import : public Tool {
     }
 
     /*
-     * Reads one line from in into buf.
-     * Returns the number of bytes that should be skipped - the caller should
-     * increment buf by this amount.
+     * Reads one line from in into line, without the newline.
+     * Returns false at the end of the input.
      */
-    int getLine(istream* in, char* buf) {
-        if (_jsonArray) {
-            in->read(buf, BUF_SIZE);
-            uassert(13295, "JSONArray file too large", (in->rdstate() & ios_base::eofbit));
-            buf[ in->gcount() ] = '\0';
-        }
-        else {
-            in->getline( buf , BUF_SIZE );
-            log(1) << "got line:" << buf << endl;
+    bool getLine(istream* in, string& line, long long& numBytesRead) {
+        if ( ! getline( *in , line ) ) {
+            uassert( 10263 ,  "unknown error reading file" , ! in->bad() );
+            return false;
         }
-        uassert( 10263 ,  "unknown error reading file" ,
-                 (!(in->rdstate() & ios_base::badbit)) &&
-                 (!(in->rdstate() & ios_base::failbit) || (in->rdstate() & ios_base::eofbit)) );
-
-        int numBytesSkipped = 0;
-        if (strncmp("\xEF\xBB\xBF", buf, 3) == 0) { // UTF-8 BOM (notepad is stupid)
-            buf += 3;
-            numBytesSkipped += 3;
+        log(1) << "got line:" << line << endl;
+        numBytesRead += line.size() + 1;
+
+        if ( line.compare( 0 , 3 , "\xEF\xBB\xBF" ) == 0 ) { // UTF-8 BOM (notepad is stupid)
+            line.erase( 0 , 3 );
         }
+        return true;
+    }
 
-        uassert(13289, "Invalid UTF8 character detected", isValidUTF8(buf));
-        return numBytesSkipped;
+    static bool oddQuotes( const string& s ) {
+        return std::count( s.begin() , s.end() , '"' ) % 2;
     }
 
     /*
-     * Parses a BSON object out of a JSON array.
-     * Returns number of bytes processed on success and -1 on failure.
+     * Reads the text of one object from the input file into record.  This usually corresponds to
+     * one line in the input file, unless the file is a CSV and contains a newline within a quoted
+     * string entry, or is a JSON array.
+     * Returns false at the end of the input.
      */
-    int parseJSONArray(char* buf, BSONObj& o) {
-        int len = 0;
-        while (buf[0] != '{' && buf[0] != '\0') {
-            len++;
-            buf++;
+    bool readRecord(istream* in, string& record, long long& numBytesRead) {
+        if ( _jsonArray )
+            return _arrayReader->next( record , numBytesRead );
+
+        do {
+            if ( ! getLine( in , record , numBytesRead ) )
+                return false;
+        } while ( record.empty() );
+
+        if ( _type == CSV ) {
+            // Deal with line breaks in quoted strings
+            bool insideQuotes = oddQuotes( record );
+            string more;
+            while ( insideQuotes ) {
+                uassert (15854, "CSV file ends while inside quoted field", getLine( in , more , numBytesRead ) );
+                record += "\n";
+                record += more;
+                insideQuotes = ( insideQuotes != oddQuotes( more ) );
+            }
         }
-        if (buf[0] == '\0')
-            return -1;
+        return true;
+    }
 
-        int jslen;
-        try {
-            o = fromjson(buf, &jslen);
-        } catch ( MsgAssertionException& e ) {
-            uasserted(13293, string("BSON representation of supplied JSON array is too large: ") + e.what());
+    void tokenize(const string& record, vector<string>& tokens) {
+        if (_type == CSV) {
+            csvTokenizeRow(record, tokens);
         }
-        len += jslen;
+        else {  // _type == TSV
+            const char* line = record.c_str();
+            while (line[0] != '\t' && isspace(line[0])) { // Strip leading whitespace, but not tabs
+                line++;
+            }
 
-        return len;
+            boost::split(tokens, line, boost::is_any_of(_sep));
+        }
     }
 
     /*
-     * Parses one object from the input file.  This usually corresponds to one line in the input
-     * file, unless the file is a CSV and contains a newline within a quoted string entry.
-     * Returns a true if a BSONObj was successfully created and false if not.
+     * Parses one object from the text read by readRecord.  Called by the parsing threads, so it
+     * doesn't change any state.
      */
-    bool parseRow(istream* in, BSONObj& o, int& numBytesRead) {
-        boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
-        char* line = buffer.get();
-
-        numBytesRead = getLine(in, line);
-        line += numBytesRead;
-
-        if (line[0] == '\0') {
-            return false;
-        }
-        numBytesRead += strlen( line );
+    BSONObj parseRecord(const string& record) {
+        uassert(13289, "Invalid UTF8 character detected", isValidUTF8(record));
 
         if (_type == JSON) {
-            // Strip out trailing whitespace
-            char * end = ( line + strlen( line ) ) - 1;
-            while ( end >= line && isspace(*end) ) {
-                *end = 0;
-                end--;
-            }
             try {
-                o = fromjson( line );
+                // Strip out trailing whitespace
+                if ( isspace( record[ record.size() - 1 ] ) ) {
+                    size_t end = record.size();
+                    while ( end > 0 && isspace( record[end - 1] ) )
+                        end--;
+                    return fromjson( record.substr( 0 , end ) );
+                }
+                return fromjson( record );
             } catch ( MsgAssertionException& e ) {
                 uasserted(13504, string("BSON representation of supplied JSON is too large: ") + e.what());
             }
-            return true;
         }
 
         vector<string> tokens;
-        if (_type == CSV) {
-            string row;
-            bool inside_quotes = false;
-            size_t last_quote = 0;
-            while (true) {
-                string lineStr(line);
-                // Deal with line breaks in quoted strings
-                last_quote = lineStr.find_first_of('"');
-                while (last_quote != string::npos) {
-                    inside_quotes = !inside_quotes;
-                    last_quote = lineStr.find_first_of('"', last_quote+1);
-                }
+        tokenize(record, tokens);
 
-                row.append(lineStr);
+        // Now that the row is tokenized, create a BSONObj out of it.
+        BSONObjBuilder b;
+        unsigned int pos=0;
+        for (vector<string>::iterator it = tokens.begin(); it != tokens.end(); ++it) {
+            string name;
+            if ( pos < _fields.size() ) {
+                name = _fields[pos];
+            }
+            else {
+                stringstream ss;
+                ss << "field" << pos;
+                name = ss.str();
+            }
+            pos++;
 
-                if (inside_quotes) {
-                    row.append("\n");
-                    int num = getLine(in, line);
-                    line += num;
-                    numBytesRead += num;
+            _append( b , name , *it );
+        }
+        return b.obj();
+    }
 
-                    uassert (15854, "CSV file ends while inside quoted field", line[0] != '\0');
-                    numBytesRead += strlen( line );
-                } else {
-                    break;
+    /*
+     * The import runs as a pipeline: a thread reads the input into batches of records, parsing
+     * threads turn each batch into objects, and this thread inserts the batches in input order.
+     */
+    struct Batch {
+        Batch( unsigned long long seq ) : seq( seq ) , bytes( 0 ) , firstError( -1 ) , errors( 0 ) {}
+        const unsigned long long seq;
+        vector<string> records;
+        long long bytes;
+        vector<BSONObj> objs;
+        int firstError; // index into records of the first that didn't parse, objs are the ones before it
+        int errors;
+    };
+    typedef shared_ptr<Batch> BatchPtr; // an empty one ends the input
+
+    static const int MaxBatchBytes = 1024 * 1024;
+
+    scoped_ptr< BlockingQueue<BatchPtr> > _toParse;
+    scoped_ptr< BlockingQueue<BatchPtr> > _parsed;
+    volatile bool _stop;
+    int _readErrors;
+
+    void readerThread(istream* in, int numParsers) {
+        unsigned long long seq = 0;
+        BatchPtr batch;
+        try {
+            while ( ! _stop ) {
+                batch.reset( new Batch( seq++ ) );
+                string record;
+                while ( batch->records.size() < _batchSize && batch->bytes < MaxBatchBytes &&
+                        readRecord( in , record , batch->bytes ) ) {
+                    batch->records.push_back( record );
                 }
+                if ( batch->records.empty() )
+                    break;
+                _toParse->push( batch );
+                batch.reset();
             }
-            // now 'row' is string corresponding to one row of the CSV file
-            // (which may span multiple lines) and represents one BSONObj
-            csvTokenizeRow(row, tokens);
         }
-        else {  // _type == TSV
-            while (line[0] != '\t' && isspace(line[0])) { // Strip leading whitespace, but not tabs
-                line++;
+        catch ( std::exception& e ) {
+            log() << "exception:" << e.what() << endl;
+            _readErrors++;
+            // the records read before the error still go in
+            if ( batch && ! batch->records.empty() )
+                _toParse->push( batch );
+        }
+
+        for ( int i = 0; i < numParsers; i++ )
+            _toParse->push( BatchPtr() );
+    }
+
+    void parserThread() {
+        while ( BatchPtr batch = _toParse->blockingPop() ) {
+            batch->objs.reserve( batch->records.size() );
+            for ( unsigned i = 0; i < batch->records.size(); i++ ) {
+                try {
+                    batch->objs.push_back( parseRecord( batch->records[i] ) );
+                }
+                catch ( std::exception& e ) {
+                    log() << "exception:" << e.what() << endl;
+                    log() << batch->records[i] << endl;
+                    if ( batch->errors++ == 0 )
+                        batch->firstError = i;
+                }
             }
+            _parsed->push( batch );
+        }
+        _parsed->push( BatchPtr() );
+    }
 
-            boost::split(tokens, line, boost::is_any_of(_sep));
+    void insert(const string& ns, const vector<BSONObj>& objs) {
+        if ( ! _doimport || objs.empty() )
+            return;
+
+        if ( ! _upsert ) {
+            conn().insert( ns , objs , _stopOnError ? 0 : InsertOption_ContinueOnError );
+            return;
         }
 
-        // Now that the row is tokenized, create a BSONObj out of it.
-        BSONObjBuilder b;
-        unsigned int pos=0;
-        for (vector<string>::iterator it = tokens.begin(); it != tokens.end(); ++it) {
-            string token = *it;
-            if ( _headerLine ) {
-                _fields.push_back(token);
-            }
-            else {
-                string name;
-                if ( pos < _fields.size() ) {
-                    name = _fields[pos];
-                }
-                else {
-                    stringstream ss;
-                    ss << "field" << pos;
-                    name = ss.str();
+        for ( vector<BSONObj>::const_iterator i = objs.begin(); i != objs.end(); ++i ) {
+            const BSONObj& o = *i;
+            bool doUpsert = true;
+            BSONObjBuilder b;
+            for (vector<string>::const_iterator it=_upsertFields.begin(), end=_upsertFields.end(); it!=end; ++it) {
+                BSONElement e = o.getFieldDotted(it->c_str());
+                if (e.eoo()) {
+                    doUpsert = false;
+                    break;
                 }
-                pos++;
+                b.appendAs(e, *it);
+            }
 
-                _append( b , name , token );
+            if (doUpsert) {
+                conn().update(ns, Query(b.obj()), o, true);
+            }
+            else {
+                conn().insert( ns.c_str() , o );
             }
         }
-        o = b.obj();
-        return true;
     }
 
 public:
@@ -270,7 +436,9 @@ public:
         ("upsert", "insert or update objects that already exist" )
         ("upsertFields", po::value<string>(), "comma-separated fields for the query part of the upsert. You should make sure this is indexed" )
         ("stopOnError", "stop importing at first error rather than continuing" )
-        ("jsonArray", "load a json array, not one item per line. Currently limited to 16MB." )
+        ("jsonArray", "load a json array, not one item per line" )
+        ("numParsingThreads,j", po::value<int>(), "number of threads parsing the input, default: number of processors" )
+        ("batchSize", po::value<int>()->default_value(1000), "documents per insert message" )
         ;
         add_hidden_options()
         ("noimport", "don't actually import. useful for benchmarking parser" )
@@ -282,6 +450,10 @@ public:
         _upsert = false;
         _doimport = true;
         _jsonArray = false;
+        _stopOnError = false;
+        _batchSize = 1000;
+        _stop = false;
+        _readErrors = 0;
     }
 
     virtual void printExtraHelp( ostream & out ) {
@@ -291,7 +463,6 @@ public:
     int run() {
         string filename = getParam( "file" );
         long long fileSize = 0;
-        int headerRows = 0;
 
         istream * in = &cin;
 
@@ -370,93 +541,89 @@ public:
 
         if ( _type == CSV || _type == TSV ) {
             _headerLine = hasParam( "headerline" );
-            if ( _headerLine ) {
-                headerRows = 1;
-            }
-            else {
+            if ( ! _headerLine ) {
                 needFields();
             }
         }
 
         if (_type == JSON && hasParam("jsonArray")) {
             _jsonArray = true;
+            _arrayReader.reset( new JSONArrayReader( in ) );
         }
 
+        _stopOnError = hasParam("stopOnError");
+        _batchSize = std::max( 1 , getParam( "batchSize" , 1000 ) );
+        int numParsers = std::max( 1 , getParam( "numParsingThreads" , (int)boost::thread::hardware_concurrency() ) );
+
         time_t start = time(0);
         log(1) << "filesize: " << fileSize << endl;
         ProgressMeter pm( fileSize );
-        int num = 0;
+        long long num = 0;
         int errors = 0;
-        int len = 0;
-        // buffer and line are only used when parsing a jsonArray
-        boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
-        char* line = buffer.get();
 
-        while ( _jsonArray || in->rdstate() == 0 ) {
-            try {
-                BSONObj o;
-                if (_jsonArray) {
-                    int bytesProcessed = 0;
-                    if (line == buffer.get()) { // Only read on first pass - the whole array must be on one line.
-                        bytesProcessed = getLine(in, line);
-                        line += bytesProcessed;
-                        len += bytesProcessed;
-                    }
-                    if ((bytesProcessed = parseJSONArray(line, o)) < 0) {
-                        len += bytesProcessed;
-                        break;
-                    }
-                    len += bytesProcessed;
-                    line += bytesProcessed;
-                }
-                else {
-                    if (!parseRow(in, o, len)) {
-                        continue;
+        if ( _headerLine ) {
+            string header;
+            long long len = 0;
+            if ( readRecord( in , header , len ) )
+                tokenize( header , _fields );
+            pm.hit( len );
+        }
+
+        // a few batches per parser keep them all busy without reading far ahead
+        _toParse.reset( new BlockingQueue<BatchPtr>( 2 * numParsers ) );
+        _parsed.reset( new BlockingQueue<BatchPtr>( 2 * numParsers ) );
+
+        boost::thread_group threads;
+        threads.create_thread( boost::bind( &Import::readerThread , this , in , numParsers ) );
+        for ( int i = 0; i < numParsers; i++ )
+            threads.create_thread( boost::bind( &Import::parserThread , this ) );
+
+        // batches finish parsing out of order, insert them in the order of the input
+        map<unsigned long long, BatchPtr> pending;
+        unsigned long long next = 0;
+        for ( int running = numParsers; running; ) {
+            BatchPtr batch = _parsed->blockingPop();
+            if ( ! batch ) {
+                running--;
+                continue;
+            }
+            pending[batch->seq] = batch;
+
+            for ( map<unsigned long long, BatchPtr>::iterator i; ( i = pending.find( next ) ) != pending.end(); next++ ) {
+                batch = i->second;
+                pending.erase( i );
+                if ( _stop )
+                    continue; // draining the pipeline
+
+                if ( batch->errors && _stopOnError )
+                    batch->objs.resize( batch->firstError ); // just the ones before the error
+
+                try {
+                    insert( ns , batch->objs );
+                    if ( _stopOnError && _doimport ) {
+                        string err = conn().getLastError();
+                        uassert( 16133 , err , err.empty() );
                     }
                 }
-
-                if ( _headerLine ) {
-                    _headerLine = false;
+                catch ( std::exception& e ) {
+                    log() << "exception:" << e.what() << endl;
+                    errors++;
+                    _stop = _stopOnError;
                 }
-                else if (_doimport) {
-                    bool doUpsert = _upsert;
-                    BSONObjBuilder b;
-                    if (_upsert) {
-                        for (vector<string>::const_iterator it=_upsertFields.begin(), end=_upsertFields.end(); it!=end; ++it) {
-                            BSONElement e = o.getFieldDotted(it->c_str());
-                            if (e.eoo()) {
-                                doUpsert = false;
-                                break;
-                            }
-                            b.appendAs(e, *it);
-                        }
-                    }
+                num += batch->objs.size();
+                errors += batch->errors;
+                if ( batch->errors && _stopOnError )
+                    _stop = true;
 
-                    if (doUpsert) {
-                        conn().update(ns, Query(b.obj()), o, true);
-                    }
-                    else {
-                        conn().insert( ns.c_str() , o );
-                    }
+                if ( pm.hit( batch->bytes ) ) {
+                    log() << "\t\t\t" << num << "\t" << ( num / std::max( (time_t)1 , time(0) - start ) ) << "/second" << endl;
                 }
-
-                num++;
-            }
-            catch ( std::exception& e ) {
-                log() << "exception:" << e.what() << endl;
-                log() << line << endl;
-                errors++;
-
-                if (hasParam("stopOnError") || _jsonArray)
-                    break;
-            }
-
-            if ( pm.hit( len + 1 ) ) {
-                log() << "\t\t\t" << num << "\t" << ( num / ( time(0) - start ) ) << "/second" << endl;
             }
         }
+        threads.join_all();
+        errors += _readErrors;
 
-        log() << "imported " << ( num - headerRows ) << " objects" << endl;
+        log() << "imported " << num << " objects" << endl;
 
         conn().getLastError();
 
@@ -38,6 +38,49 @@ namespace {
     const char* OPLOG_SENTINEL = "$oplog";  // compare by ptr not strcmp
 }
 
+/** groups the documents restored into a collection into large inserts */
+class InsertBatcher : boost::noncopyable {
+public:
+    /** most bytes in one insert message, well under the server's limit */
+    static const int MaxBatchBytes = 8 * 1024 * 1024;
+
+    InsertBatcher( DBClientBase& conn , const string& ns , unsigned batchSize , int w )
+        : _conn( conn ) , _ns( ns ) , _batchSize( batchSize ) , _w( w ) , _bytes( 0 ) {}
+
+    ~InsertBatcher() {
+        DESTRUCTOR_GUARD( flush(); )
+    }
+
+    void add( const BSONObj& obj ) {
+        if ( _batch.size() && ( _batch.size() >= _batchSize || _bytes + obj.objsize() > MaxBatchBytes ) )
+            flush();
+        _batch.push_back( obj.getOwned() );
+        _bytes += obj.objsize();
+    }
+
+    void flush() {
+        if ( _batch.empty() )
+            return;
+        // like inserting one by one: a bad document (eg a duplicate _id) doesn't stop the rest
+        _conn.insert( _ns , _batch , InsertOption_ContinueOnError );
+
+        // wait for insert to propagate to "w" nodes (doesn't warn if w used without replset)
+        if ( _w > 1 ) {
+            _conn.getLastErrorDetailed(false, false, _w);
+        }
+        _batch.clear();
+        _bytes = 0;
+    }
+
+private:
+    DBClientBase& _conn;
+    string _ns;
+    unsigned _batchSize;
+    int _w;
+    vector<BSONObj> _batch;
+    int _bytes;
+};
+
 class Restore : public BSONTool {
 public:
 
@@ -52,7 +95,25 @@ public:
     string _curcoll;
     set<string> _users; // For restoring users with --drop
     auto_ptr<Matcher> _opmatcher; // For oplog replay
-    Restore() : BSONTool( "restore" ) , _drop(false) {
+
+    unsigned _batchSize;
+    auto_ptr<InsertBatcher> _batcher; // of the file being processed
+
+    // with --numParallelCollections the data files of collections are queued while walking the dump,
+    // then loaded by that many threads, and indexes are built once all the data is in
+    int _numWorkers;
+    bool _parallelIndexBuilds;
+    struct CollectionJob {
+        boost::filesystem::path file;
+        string ns;
+    };
+    vector<CollectionJob> _jobs;
+    vector<BSONObj> _deferredIndexes; // ns already set
+    AtomicUInt _nextJob;
+    volatile bool _workerFailed;
+
+    Restore() : BSONTool( "restore" ) , _drop(false) , _batchSize(1000) , _numWorkers(1) ,
+        _parallelIndexBuilds(false) , _workerFailed(false) {
         add_options()
         ("drop" , "drop each collection before import" )
         ("oplogReplay", "replay oplog for point-in-time restore")
@@ -62,6 +123,9 @@ public:
         ("noIndexRestore" , "don't restore indexes")
         ("restoreShardingConfig", "restore sharding configuration before doing the full import")
         ("w" , po::value<int>()->default_value(1) , "minimum number of replicas per write" )
+        ("batchSize" , po::value<int>()->default_value(1000) , "documents per insert message" )
+        ("numParallelCollections,j" , po::value<int>()->default_value(1) , "number of collections to restore in parallel, indexes are then built after all the data is loaded" )
+        ("parallelIndexBuilds" , "with --numParallelCollections, build the indexes of different collections in parallel too" )
         ;
         add_hidden_options()
         ("dir", po::value<string>()->default_value("dump"), "directory to restore from")
@@ -98,6 +162,14 @@ public:
         _restoreShardingConfig = hasParam("restoreShardingConfig");
         bool forceConfigRestore = hasParam("forceConfigRestore");
 
+        _batchSize = std::max( 1 , getParam( "batchSize" , 1000 ) );
+        _numWorkers = std::max( 1 , getParam( "numParallelCollections" , 1 ) );
+        _parallelIndexBuilds = hasParam( "parallelIndexBuilds" );
+        if ( _numWorkers > 1 && hasParam( "dbpath" ) ) {
+            log() << "--numParallelCollections needs a server to connect to, restoring one collection at a time" << endl;
+            _numWorkers = 1;
+        }
+
         bool doOplog = hasParam( "oplogReplay" );
 
         if (doOplog) {
@@ -182,6 +254,8 @@ public:
                 return -1;
             }
             drillDown(root / "config", false, false);
+            if ( ! runQueued() )
+                return -1;
 
             log() << "Finished restoring config database." << endl
                  << "Calling flushRouterConfig on this connection" << endl;
@@ -198,6 +272,8 @@ public:
          * .bson file, or a single .bson file itself (a collection).
          */
         drillDown(root, _db != "", _coll != "", true);
+        if ( ! runQueued() )
+            return -1;
 
         if (_restoreShardingConfig) {
             log() << "Flushing routing configuration from all mongos that we're aware of" << endl;
@@ -357,7 +433,27 @@ public:
             createCollectionWithOptions(metadataObject["options"].Obj());
         }
 
+        if ( parallel() && ! startsWith( _curcoll , "system." ) ) {
+            CollectionJob job;
+            job.file = root;
+            job.ns = _curns;
+            _jobs.push_back( job );
+            log() << "\t queued" << endl;
+
+            if (_restoreIndexes && metadataObject.hasField("indexes")) {
+                vector<BSONElement> indexes = metadataObject["indexes"].Array();
+                for (vector<BSONElement>::iterator it = indexes.begin(); it != indexes.end(); ++it) {
+                    _deferredIndexes.push_back( fixIndexSpec((*it).Obj(), false) );
+                }
+            }
+            return;
+        }
+
+        _batcher.reset( new InsertBatcher( conn() , _curns , _batchSize , _w ) );
         processFile( root );
+        _batcher->flush();
+        _batcher.reset();
+
         if (_drop && root.leaf() == "system.users.bson") {
             // Delete any users that used to exist but weren't in the dump file
             for (set<string>::iterator it = _users.begin(); it != _users.end(); ++it) {
@@ -398,7 +494,10 @@ public:
             }
         }
         else if ( endsWith( _curns.c_str() , ".system.indexes" )) {
-            createIndex(obj, true);
+            if ( parallel() )
+                _deferredIndexes.push_back( fixIndexSpec(obj, true) );
+            else
+                createIndex(obj, true);
         }
         else if (_drop && endsWith(_curns.c_str(), ".system.users") && _users.count(obj["user"].String())) {
             // Since system collections can't be dropped, we have to manually
@@ -407,16 +506,105 @@ public:
             conn().update(_curns, Query(userMatch), obj);
             _users.erase(obj["user"].String());
         } else {
-            conn().insert( _curns , obj );
+            _batcher->add( obj );
+        }
+    }
 
-            // wait for insert to propagate to "w" nodes (doesn't warn if w used without replset)
-            if ( _w > 1 ) {
-                conn().getLastErrorDetailed(false, false, _w);
+private:
+
+    bool parallel() const { return _numWorkers > 1; }
+
+    /**
+     * Loads the queued collections with _numWorkers threads, each with its own connection, then builds
+     * the deferred indexes.
+     * @return false if a worker failed
+     */
+    bool runQueued() {
+        if ( _jobs.empty() && _deferredIndexes.empty() )
+            return true;
+
+        log() << "restoring " << _jobs.size() << " collections with " << _numWorkers << " threads" << endl;
+        _nextJob.zero();
+        runWorkers( _numWorkers , &Restore::restoreWorker );
+        _jobs.clear();
+
+        if ( ! _workerFailed && ! _deferredIndexes.empty() ) {
+            log() << "building " << _deferredIndexes.size() << " indexes" << endl;
+            if ( _parallelIndexBuilds ) {
+                _nextJob.zero();
+                runWorkers( _numWorkers , &Restore::indexWorker );
+            }
+            else {
+                for ( unsigned i = 0; i < _deferredIndexes.size(); i++ )
+                    insertIndex( conn() , _deferredIndexes[i] );
             }
         }
+        _deferredIndexes.clear();
+
+        if ( _workerFailed )
+            error() << "restore failed, see errors above" << endl;
+        return ! _workerFailed;
     }
 
-private:
+    void runWorkers( int n , void (Restore::*worker)( DBClientBase& ) ) {
+        boost::thread_group threads;
+        for ( int i = 0; i < n; i++ )
+            threads.create_thread( boost::bind( &Restore::runWorker , this , worker ) );
+        threads.join_all();
+    }
+
+    void runWorker( void (Restore::*worker)( DBClientBase& ) ) {
+        try {
+            scoped_ptr<DBClientBase> c( newConnection() );
+            if ( ! c ) {
+                _workerFailed = true;
+                return;
+            }
+            (this->*worker)( *c );
+        }
+        catch ( DBException& e ) {
+            error() << "restore thread failed: " << e.toString() << endl;
+            _workerFailed = true;
+        }
+    }
+
+    void restoreWorker( DBClientBase& c ) {
+        auto_ptr<Matcher> matcher;
+        if ( hasParam( "filter" ) )
+            matcher.reset( new Matcher( fromjson( getParam( "filter" ) ) ) );
+
+        for ( unsigned i; ! _workerFailed && ( i = _nextJob++ ) < _jobs.size(); ) {
+            const CollectionJob& job = _jobs[i];
+            BSONFileReader reader( job.file.string() );
+            if ( reader.length() == 0 )
+                continue;
+            uassert( 16125 , str::stream() << "error opening file: " << job.file.string() , reader.opened() );
+
+            long long n = 0;
+            InsertBatcher batcher( c , job.ns , _batchSize , _w );
+            while ( reader.more() ) {
+                BSONObj o = reader.next();
+                uassert( 16126 , str::stream() << "invalid object in " << job.file.string() , ! objcheck() || o.valid() );
+                if ( matcher.get() && ! matcher->matches( o ) )
+                    continue;
+                batcher.add( o );
+                n++;
+            }
+            batcher.flush();
+            log() << "\t" << job.ns << ": " << n << " objects restored" << endl;
+        }
+    }
+
+    /** builds the indexes of one collection after the other, so a collection's builds don't contend */
+    void indexWorker( DBClientBase& c ) {
+        // the specs are grouped by collection: take whole groups
+        for ( unsigned i; ! _workerFailed && ( i = _nextJob++ ) < _deferredIndexes.size(); ) {
+            if ( i > 0 && _deferredIndexes[i]["ns"].String() == _deferredIndexes[i-1]["ns"].String() )
+                continue; // the worker that took the group's first builds it
+            for ( unsigned k = i; k < _deferredIndexes.size() && _deferredIndexes[k]["ns"].String() == _deferredIndexes[i]["ns"].String(); k++ )
+                insertIndex( c , _deferredIndexes[k] );
+        }
+    }
 
     BSONObj parseMetadataFile(string filePath) {
         long long fileSize = boost::filesystem::file_size(filePath);
@@ -501,6 +689,10 @@ private:
        If keepCollName is true, however, we keep the same collection name that's in the index object.
      */
     void createIndex(BSONObj indexObj, bool keepCollName) {
+        insertIndex( conn() , fixIndexSpec( indexObj , keepCollName ) );
+    }
+
+    BSONObj fixIndexSpec(BSONObj indexObj, bool keepCollName) {
         BSONObjBuilder bo;
         BSONObjIterator i(indexObj);
         while ( i.more() ) {
@@ -514,12 +706,15 @@ private:
                 bo.append(e);
             }
         }
-        BSONObj o = bo.obj();
+        return bo.obj();
+    }
+
+    void insertIndex( DBClientBase& c , const BSONObj& o ) {
         log(0) << "\tCreating index: " << o << endl;
-        conn().insert( _curdb + ".system.indexes" ,  o );
+        c.insert( nsToDatabase( o["ns"].String().c_str() ) + ".system.indexes" ,  o );
 
         // We're stricter about errors for indexes than for regular data
-        BSONObj err = conn().getLastErrorDetailed(false, false, _w);
+        BSONObj err = c.getLastErrorDetailed(false, false, _w);
 
         if ( ! ( err["err"].isNull() ) ) {
             if (err["err"].String() == "norepl" && _w > 1) {
@@ -23,6 +23,7 @@
 
 #include "pcrecpp.h"
 
+#include "util/compress.h"
 #include "util/file_allocator.h"
 #include "util/password.h"
 #include "util/version.h"
@@ -432,6 +433,28 @@ namespace mongo {
         throw UserException( 9997 , (string)"authentication failed: " + errmsg );
     }
 
+    DBClientBase* Tool::newConnection() {
+        if ( hasParam( "dbpath" ) )
+            return 0;
+
+        string errmsg;
+        ConnectionString cs = ConnectionString::parse( _host , errmsg );
+        DBClientBase* c = cs.isValid() ? cs.connect( errmsg ) : 0;
+        if ( ! c ) {
+            cerr << "couldn't connect to [" << _host << "] " << errmsg << endl;
+            return 0;
+        }
+
+        if ( _username.size() || _password.size() ) {
+            if ( ! c->auth( _db , _username , _password , errmsg ) &&
+                 ! c->auth( "admin" , _username , _password , errmsg ) ) {
+                delete c;
+                throw UserException( 16148 , (string)"authentication failed: " + errmsg );
+            }
+        }
+        return c;
+    }
+
     BSONTool::BSONTool( const char * name, DBAccess access , bool objcheck )
         : Tool( name , access , "" , "" , false ) , _objcheck( objcheck ) {
 
@@ -454,51 +477,33 @@ namespace mongo {
     long long BSONTool::processFile( const boost::filesystem::path& root ) {
         _fileName = root.string();
 
-        unsigned long long fileLength = file_size( root );
+        BSONFileReader reader( _fileName );
+        unsigned long long fileLength = reader.length();
 
         if ( fileLength == 0 ) {
             out() << "file " << _fileName << " empty, skipping" << endl;
             return 0;
         }
 
-
-        FILE* file = fopen( _fileName.c_str() , "rb" );
-        if ( ! file ) {
+        if ( ! reader.opened() ) {
             log() << "error opening file: " << _fileName << " " << errnoWithDescription() << endl;
             return 0;
         }
 
-#if !defined(__sunos__) && defined(POSIX_FADV_SEQUENTIAL)
-        posix_fadvise(fileno(file), 0, fileLength, POSIX_FADV_SEQUENTIAL);
-#endif
-
         log(1) << "\t file size: " << fileLength << endl;
 
-        unsigned long long read = 0;
         unsigned long long num = 0;
         unsigned long long processed = 0;
 
-        const int BUF_SIZE = BSONObjMaxUserSize + ( 1024 * 1024 );
-        boost::scoped_array<char> buf_holder(new char[BUF_SIZE]);
-        char * buf = buf_holder.get();
-
         ProgressMeter m( fileLength );
         m.setUnits( "bytes" );
 
-        while ( read < fileLength ) {
-            size_t amt = fread(buf, 1, 4, file);
-            assert( amt == 4 );
-
-            int size = ((int*)buf)[0];
-            uassert( 10264 , str::stream() << "invalid object size: " << size , size < BUF_SIZE );
-
-            amt = fread(buf+4, 1, size-4, file);
-            assert( amt == (size_t)( size - 4 ) );
-
-            BSONObj o( buf );
+        unsigned long long pos = 0;
+        while ( reader.more() ) {
+            BSONObj o = reader.next();
             if ( _objcheck && ! o.valid() ) {
                 cerr << "INVALID OBJECT - going try and pring out " << endl;
-                cerr << "size: " << size << endl;
+                cerr << "size: " << o.objsize() << endl;
                 BSONObjIterator i(o);
                 while ( i.more() ) {
                     BSONElement e = i.next();
@@ -518,14 +523,13 @@ namespace mongo {
                 processed++;
             }
 
-            read += o.objsize();
             num++;
 
-            m.hit( o.objsize() );
+            // bytes of the file, for compressed files they move once per block
+            m.hit( reader.position() - pos );
+            pos = reader.position();
         }
 
-        fclose( file );
-
         uassert( 10265 ,  "counts don't match" , m.done() == fileLength );
         (_usesstdout ? cout : cerr ) << m.hits() << " objects found" << endl;
         if ( _matcher.get() )
@@ -533,6 +537,119 @@ namespace mongo {
         return processed;
     }
 
+    const char BSONFileWriter::CompressedMagic[8] = { '\xff' , '\xff' , '\xff' , '\xff' , 's' , 'n' , 'p' , 'y' };
+
+    BSONFileWriter::BSONFileWriter( FILE* out , bool compress )
+        : _out( out ) , _compress( compress ) , _m( "BSONFileWriter" ) {
+        if ( _compress )
+            _write( CompressedMagic , sizeof( CompressedMagic ) );
+    }
+
+    void BSONFileWriter::write( const char* data , size_t len ) {
+        if ( len == 0 )
+            return;
+
+        if ( ! _compress ) {
+            SimpleMutex::scoped_lock lk( _m );
+            _write( data , len );
+            return;
+        }
+
+        // compress outside the lock, that's where the time goes
+        string compressed;
+        compress( data , len , &compressed );
+        int size = compressed.size();
+
+        SimpleMutex::scoped_lock lk( _m );
+        _write( (const char*)&size , 4 );
+        _write( compressed.data() , compressed.size() );
+    }
+
+    void BSONFileWriter::_write( const char* data , size_t len ) {
+        size_t written = 0;
+        while ( written < len ) {
+            size_t ret = fwrite( data + written , 1 , len - written , _out );
+            uassert( 14035 , errnoWithPrefix( "couldn't write to file" ) , ret );
+            written += ret;
+        }
+    }
+
+    BSONFileReader::BSONFileReader( const string& fileName )
+        : _fileName( fileName ) , _file( 0 ) , _length( file_size( boost::filesystem::path( fileName ) ) ) , _read( 0 ) ,
+          _compressed( false ) , _framePos( 0 ) {
+        if ( _length == 0 )
+            return;
+
+        _file = fopen( _fileName.c_str() , "rb" );
+        if ( ! _file )
+            return;
+
+        _readAhead.reset( new char[ReadAheadSize] );
+        setvbuf( _file , _readAhead.get() , _IOFBF , ReadAheadSize );
+
+#if !defined(__sunos__) && defined(POSIX_FADV_SEQUENTIAL)
+        posix_fadvise(fileno(_file), 0, _length, POSIX_FADV_SEQUENTIAL);
+#endif
+
+        _buf.reset( new char[BSONObjMaxUserSize + ( 1024 * 1024 )] );
+
+        char magic[sizeof( BSONFileWriter::CompressedMagic )];
+        if ( _length >= sizeof( magic ) &&
+             fread( magic , 1 , sizeof( magic ) , _file ) == sizeof( magic ) &&
+             memcmp( magic , BSONFileWriter::CompressedMagic , sizeof( magic ) ) == 0 ) {
+            _compressed = true;
+            _read = sizeof( magic );
+        }
+        else {
+            rewind( _file );
+        }
+    }
+
+    BSONFileReader::~BSONFileReader() {
+        if ( _file )
+            fclose( _file );
+    }
+
+    BSONObj BSONFileReader::next() {
+        const int BUF_SIZE = BSONObjMaxUserSize + ( 1024 * 1024 );
+        char * buf = _buf.get();
+
+        if ( _compressed ) {
+            if ( _framePos >= _frame.size() ) {
+                size_t amt = fread(buf, 1, 4, _file);
+                assert( amt == 4 );
+
+                int size = ((int*)buf)[0];
+                uassert( 16127 , str::stream() << "invalid compressed block size: " << size , size > 0 && size < BUF_SIZE );
+
+                amt = fread(buf, 1, size, _file);
+                assert( amt == (size_t)size );
+                uassert( 16128 , str::stream() << "couldn't uncompress block of " << _fileName , uncompress( buf , size , &_frame ) );
+                _framePos = 0;
+                _read += 4 + size;
+            }
+
+            uassert( 16129 , str::stream() << "truncated compressed block in " << _fileName , _frame.size() - _framePos >= 4 );
+            BSONObj o( _frame.data() + _framePos );
+            uassert( 16139 , str::stream() << "invalid object size: " << o.objsize() , _frame.size() - _framePos >= (size_t)o.objsize() );
+            _framePos += o.objsize();
+            return o;
+        }
+
+        size_t amt = fread(buf, 1, 4, _file);
+        assert( amt == 4 );
+
+        int size = ((int*)buf)[0];
+        uassert( 10264 , str::stream() << "invalid object size: " << size , size < BUF_SIZE );
+
+        amt = fread(buf+4, 1, size-4, _file);
+        assert( amt == (size_t)( size - 4 ) );
+
+        BSONObj o( buf );
+        _read += o.objsize();
+        return o;
+    }
+
 
 
     void setupSignals( bool inFork ) {}
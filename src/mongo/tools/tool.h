@@ -106,6 +106,12 @@ namespace mongo {
         mongo::DBClientBase &conn( bool slaveIfPaired = false );
         void auth( string db = "",  Auth::Level * level = NULL);
 
+        /**
+         * @return a further connection to the server, authenticated like conn(), for tools working
+         * in parallel; the caller owns it. 0 with --dbpath, or if it can't connect.
+         */
+        mongo::DBClientBase* newConnection();
+
         string _name;
 
         string _db;
@@ -156,6 +162,66 @@ namespace mongo {
 
         long long processFile( const boost::filesystem::path& file );
 
+    protected:
+        bool objcheck() const { return _objcheck; }
+    };
+
+    /**
+     * writes a BSON file in blocks of whole objects, so several threads can append to one file.
+     * with compress the file starts with CompressedMagic, then each block is { int length ; snappy data }
+     */
+    class BSONFileWriter : boost::noncopyable {
+    public:
+        /** the objects a writer buffers before handing them to write() */
+        static const int BlockSize = 1024 * 1024;
+
+        /** not the start of an object: its size would be negative */
+        static const char CompressedMagic[8];
+
+        BSONFileWriter( FILE* out , bool compress );
+
+        /** appends whole objects, atomically with respect to other threads */
+        void write( const char* data , size_t len );
+
+    private:
+        void _write( const char* data , size_t len );
+
+        FILE* _out;
+        bool _compress;
+        SimpleMutex _m;
+    };
+
+    /** reads the objects of a BSON file, as written by mongodump, in order and through a large buffer */
+    class BSONFileReader : boost::noncopyable {
+    public:
+        /** stdio buffer, so reading the file is a few large reads rather than many small ones */
+        static const int ReadAheadSize = 16 * 1024 * 1024;
+
+        BSONFileReader( const string& fileName );
+        ~BSONFileReader();
+
+        bool opened() const { return _file != 0; }
+        unsigned long long length() const { return _length; }
+        bool more() const { return _framePos < _frame.size() || _read < _length; }
+
+        /** bytes of the file consumed so far */
+        unsigned long long position() const { return _read; }
+
+        /** @return the next object, valid until the next call */
+        BSONObj next();
+
+    private:
+        string _fileName;
+        FILE* _file;
+        unsigned long long _length;
+        unsigned long long _read;
+        boost::scoped_array<char> _buf;
+        boost::scoped_array<char> _readAhead;
+
+        // compressed files: the current block uncompressed, and how far next() has got into it
+        bool _compressed;
+        string _frame;
+        size_t _framePos;
     };
 
 }
@@ -133,6 +133,8 @@ namespace mongo {
             assert( _cs.RecursionCount == 1 );
 #endif
         }
+        /** @return true if the lock was taken, without waiting for it */
+        bool tryLock() { return TryEnterCriticalSection(&_cs) != 0; }
         void dassertLocked() const { 
 #if defined(_DEBUG)
             assert( _cs.OwningThread == (HANDLE) GetCurrentThreadId() );
@@ -163,6 +165,8 @@ namespace mongo {
         }
 
         void lock() { assert( pthread_mutex_lock(&_lock) == 0 ); }
+        /** @return true if the lock was taken, without waiting for it */
+        bool tryLock() { return pthread_mutex_trylock(&_lock) == 0; }
         void unlock() { assert( pthread_mutex_unlock(&_lock) == 0 ); }
     public:
         class scoped_lock : boost::noncopyable {
@@ -128,4 +128,50 @@ namespace mongo {
         return low;
     }
 
+    LatencyHistogram::LatencyHistogram() : _count( 0 ) , _sum( 0 ) , _max( 0 ) {
+        for ( int i = 0; i < NumBuckets; i++ ) {
+            _buckets[i] = 0;
+        }
+    }
+
+    int LatencyHistogram::bucketFor( uint64_t micros ) {
+        if ( micros < SubBuckets )
+            return (int) micros;
+        uint32_t v = micros > std::numeric_limits<uint32_t>::max() ?
+                     std::numeric_limits<uint32_t>::max() : (uint32_t) micros;
+#if defined(__GNUC__)
+        int high = 31 - __builtin_clz( v );
+#else
+        int high = 0;
+        for ( uint32_t x = v; x >>= 1; )
+            high++;
+#endif
+        // the bits below the leading one pick the sub bucket
+        int sub = ( v >> ( high - SubBucketBits ) ) & ( SubBuckets - 1 );
+        return ( high - SubBucketBits + 1 ) * SubBuckets + sub;
+    }
+
+    uint64_t LatencyHistogram::lowerBound( int i ) {
+        if ( i < SubBuckets )
+            return i;
+        int high = i / SubBuckets + SubBucketBits - 1;
+        uint64_t sub = i % SubBuckets;
+        return ( SubBuckets + sub ) << ( high - SubBucketBits );
+    }
+
+    uint64_t LatencyHistogram::percentile( double fraction ) const {
+        if ( _count == 0 )
+            return 0;
+        uint64_t rank = (uint64_t) ( fraction * _count );
+        if ( rank < 1 )
+            rank = 1;
+        uint64_t seen = 0;
+        for ( int i = 0; i < NumBuckets - 1; i++ ) {
+            seen += _buckets[i];
+            if ( seen >= rank )
+                return std::min( lowerBound( i + 1 ) - 1 , _max );
+        }
+        return _max;
+    }
+
 }  // namespace mongo
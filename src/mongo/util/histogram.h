@@ -123,6 +123,53 @@ namespace mongo {
         Histogram& operator=( const Histogram& );
     };
 
+    /**
+     * A histogram of latencies in microseconds, with log-linear buckets in the manner of
+     * HdrHistogram: each power of two is split into SubBuckets equal buckets, so a recorded value
+     * is known to within 25% while 0 to 2^32 micros (over an hour) fit in a fixed array, and
+     * insert() is a few instructions with no search.
+     *
+     * Not thread safe, the caller serializes access.
+     */
+    class LatencyHistogram {
+    public:
+        enum { SubBucketBits = 2 , SubBuckets = 1 << SubBucketBits ,
+               NumBuckets = ( 33 - SubBucketBits ) * SubBuckets };
+
+        LatencyHistogram();
+
+        void insert( boost::uint64_t micros ) {
+            _buckets[ bucketFor( micros ) ]++;
+            _count++;
+            _sum += micros;
+            if ( micros > _max )
+                _max = micros;
+        }
+
+        boost::uint64_t count() const { return _count; }
+        /** @return the sum of all recorded values */
+        boost::uint64_t sum() const { return _sum; }
+        boost::uint64_t max() const { return _max; }
+
+        /**
+         * @return an upper bound of the value below which a 'fraction' of the recorded values
+         * fall, eg 0.99 for the 99th percentile; 0 if nothing was recorded.
+         */
+        boost::uint64_t percentile( double fraction ) const;
+
+        /** @return the number of values recorded in bucket i */
+        boost::uint64_t getCount( int i ) const { return _buckets[i]; }
+        /** @return the least value that falls in bucket i */
+        static boost::uint64_t lowerBound( int i );
+        static int bucketFor( boost::uint64_t micros );
+
+    private:
+        boost::uint64_t _buckets[NumBuckets];
+        boost::uint64_t _count;
+        boost::uint64_t _sum;
+        boost::uint64_t _max;
+    };
+
 }  // namespace mongo
 
 #endif  //  UTIL_HISTOGRAM_HEADER
@@ -19,6 +19,9 @@
 #include "pch.h"
 #include "assert_util.h"
 #include "time_support.h"
+#include "concurrency/mutex.h"
+#include "../bson/util/atomic_int.h"
+#include "../db/jsobj.h"
 using namespace std;
 
 #ifdef _WIN32
@@ -194,6 +197,194 @@ namespace mongo {
     FILE* Logstream::logfile = stdout;
     bool Logstream::isSyslog = false;
 
+    /** guards logfile itself; Logstream::mutex guards the tees, so they don't wait on the disk */
+    static SimpleMutex logFileMutex( "logFile" );
+
+    /** the lines a thread logged that the async writer hasn't taken yet */
+    class AsyncLogBuffer : boost::noncopyable {
+    public:
+        struct Line {
+            unsigned seq;
+            LogLevel level;
+            string text;
+        };
+        AsyncLogBuffer() : m( "AsyncLogBuffer" ) , orphaned( false ) {}
+        SimpleMutex m;          // only contended while the writer swaps the lines out
+        vector<Line> lines;
+        bool orphaned;          // its thread ended, the writer deletes it
+    };
+
+    /** writes the lines queued in the threads' buffers to the log file, in the order they were logged */
+    class AsyncLogWriter : boost::noncopyable {
+    public:
+        /** queued bytes beyond which lines are dropped */
+        static const unsigned MaxQueuedBytes = 16 * 1024 * 1024;
+
+        AsyncLogWriter() : _m( "AsyncLogWriter" ) , _writeMutex( "AsyncLogWriter::write" ) ,
+            _startStopMutex( "AsyncLogWriter::startStop" ) ,
+            _running( false ) , _thread( 0 ) , _reportedDropped( 0 ) {}
+
+        /** on exit() paths that skip dbexit: the thread must be gone before our mutexes are */
+        ~AsyncLogWriter() {
+            stop();
+        }
+
+        bool running() const { return _running; }
+
+        AsyncLogBuffer* newBuffer() {
+            AsyncLogBuffer* b = new AsyncLogBuffer();
+            SimpleMutex::scoped_lock lk( _m );
+            _buffers.push_back( b );
+            return b;
+        }
+
+        void orphan( AsyncLogBuffer* b ) {
+            SimpleMutex::scoped_lock lk( b->m );
+            b->orphaned = true;
+        }
+
+        void queue( AsyncLogBuffer* b , LogLevel level , string& text ) {
+            if ( _queuedBytes.get() + text.size() > MaxQueuedBytes ) {
+                _dropped++;
+                return;
+            }
+            _queuedBytes.signedAdd( text.size() );
+            AsyncLogBuffer::Line l;
+            l.seq = _seq++;
+            l.level = level;
+            SimpleMutex::scoped_lock lk( b->m );
+            b->lines.push_back( l );
+            b->lines.back().text.swap( text );
+        }
+
+        /** writes what is queued, then out, synchronously */
+        void writeNow( LogLevel level , const string& out ) {
+            SimpleMutex::scoped_lock lk( _writeMutex );
+            _writeQueued();
+            Logstream::writeOut( level , out );
+        }
+
+        void start() {
+            SimpleMutex::scoped_lock lk( _startStopMutex );
+            if ( _thread )
+                return;
+            _running = true;
+            _thread = new boost::thread( boost::bind( &AsyncLogWriter::run , this ) );
+        }
+
+        void stop() {
+            SimpleMutex::scoped_lock lk( _startStopMutex );
+            if ( ! _thread )
+                return;
+            _running = false;
+            // exit() can be called by the writer itself, e.g. from a crash handler
+            if ( _thread->get_id() != boost::this_thread::get_id() ) {
+                _thread->join();
+                delete _thread;
+                _thread = 0;
+            }
+            SimpleMutex::scoped_lock lk2( _writeMutex );
+            _writeQueued();
+        }
+
+        /**
+         * writes what is queued, for crash handlers: stops the writer thread without waiting for it, and
+         * gives up if the lock isn't free soon, as the crashing thread may be the one holding it
+         */
+        void drain() {
+            if ( ! _thread )
+                return;
+            _running = false;
+            for ( int i = 0; i < 100; i++ ) {
+                if ( _writeMutex.tryLock() ) {
+                    _writeQueued();
+                    _writeMutex.unlock();
+                    return;
+                }
+                sleepmillis( 10 );
+            }
+        }
+
+        void append( BSONObjBuilder& b ) {
+            b.appendBool( "async" , _running );
+            b.appendNumber( "queuedBytes" , (long long) _queuedBytes.get() );
+            b.appendNumber( "dropped" , (long long) _dropped.get() );
+        }
+
+    private:
+        static bool bySeq( const AsyncLogBuffer::Line& a , const AsyncLogBuffer::Line& b ) {
+            return (int) ( a.seq - b.seq ) < 0; // wraps
+        }
+
+        void run() {
+            while ( _running ) {
+                sleepmillis( 10 );
+                SimpleMutex::scoped_lock lk( _writeMutex );
+                _writeQueued();
+            }
+        }
+
+        /** takes the lines out of every buffer and writes them; in _writeMutex */
+        void _writeQueued() {
+            vector<AsyncLogBuffer::Line> all;
+            {
+                SimpleMutex::scoped_lock lk( _m );
+                for ( unsigned i = 0; i < _buffers.size(); ) {
+                    AsyncLogBuffer* b = _buffers[i];
+                    bool orphaned;
+                    vector<AsyncLogBuffer::Line> lines;
+                    {
+                        SimpleMutex::scoped_lock lk2( b->m );
+                        lines.swap( b->lines );
+                        orphaned = b->orphaned;
+                    }
+                    for ( unsigned k = 0; k < lines.size(); k++ ) {
+                        all.push_back( AsyncLogBuffer::Line() );
+                        all.back().seq = lines[k].seq;
+                        all.back().level = lines[k].level;
+                        all.back().text.swap( lines[k].text );
+                    }
+                    if ( orphaned ) {
+                        delete b;
+                        _buffers[i] = _buffers.back();
+                        _buffers.pop_back();
+                    }
+                    else {
+                        i++;
+                    }
+                }
+            }
+
+            // a line logged while we swapped can come out after later ones of other threads; its
+            // timestamp is still right
+            stable_sort( all.begin() , all.end() , bySeq );
+            for ( unsigned k = 0; k < all.size(); k++ ) {
+                Logstream::writeOut( all[k].level , all[k].text );
+                _queuedBytes.signedAdd( - (int) all[k].text.size() );
+            }
+
+            unsigned dropped = _dropped.get();
+            if ( dropped != _reportedDropped ) {
+                stringstream ss;
+                ss << terseCurrentTime( false ) << " warning: log writer fell behind, dropped "
+                   << dropped - _reportedDropped << " lines\n";
+                Logstream::writeOut( LL_WARNING , ss.str() );
+                _reportedDropped = dropped;
+            }
+        }
+
+        SimpleMutex _m;              // guards _buffers
+        SimpleMutex _writeMutex;     // one writer at a time, so lines stay in order
+        SimpleMutex _startStopMutex;
+        vector<AsyncLogBuffer*> _buffers;
+        volatile bool _running;
+        boost::thread* _thread;
+        AtomicUInt _seq;
+        AtomicUInt _queuedBytes;
+        AtomicUInt _dropped;
+        unsigned _reportedDropped;   // in _writeMutex
+    } asyncWriter;
+
     string errnoWithDescription(int x) {
 #if defined(_WIN32)
         if( x < 0 ) 
@@ -319,37 +510,85 @@ namespace mongo {
             string out( b.buf() , b.len() - 1);
             assert( b.len() < spaceNeeded );
 
-            scoped_lock lk(mutex);
-
-            if( t ) t->write(logLevel,out);
-            if ( globalTees ) {
-                for ( unsigned i=0; i<globalTees->size(); i++ )
-                    (*globalTees)[i]->write(logLevel,out);
+            if ( asyncWriter.running() && logLevel < LL_WARNING ) {
+                {
+                    scoped_lock lk(mutex);
+                    writeTees( logLevel , out , t );
+                }
+                if ( ! asyncBuffer )
+                    asyncBuffer = asyncWriter.newBuffer();
+                asyncWriter.queue( asyncBuffer , logLevel , out );
             }
-#ifndef _WIN32
-            if ( isSyslog ) {
-                syslog( logLevelToSysLogLevel(logLevel) , "%s" , out.data() );
-            } else
-#endif
-            if(fwrite(out.data(), out.size(), 1, logfile)) {
-                fflush(logfile);
+            else if ( asyncWriter.running() ) {
+                {
+                    scoped_lock lk(mutex);
+                    writeTees( logLevel , out , t );
+                }
+                asyncWriter.writeNow( logLevel , out );
             }
             else {
-                int x = errno;
-                cout << "Failed to write to logfile: " << errnoWithDescription(x) << ": " << out << endl;
+                scoped_lock lk(mutex);
+                writeTees( logLevel , out , t );
+                writeOut( logLevel , out );
             }
-#ifdef POSIX_FADV_DONTNEED
-            // This only applies to pages that have already been flushed
-            RARELY posix_fadvise(fileno(logfile), 0, 0, POSIX_FADV_DONTNEED);
-#endif
         }
         _init();
     }
 
+    void Logstream::writeTees( LogLevel level , const string& out , Tee* t ) {
+        if( t ) t->write(level,out);
+        if ( globalTees ) {
+            for ( unsigned i=0; i<globalTees->size(); i++ )
+                (*globalTees)[i]->write(level,out);
+        }
+    }
+
+    void Logstream::writeOut( LogLevel level , const string& out ) {
+        SimpleMutex::scoped_lock lk( logFileMutex );
+#ifndef _WIN32
+        if ( isSyslog ) {
+            syslog( logLevelToSysLogLevel(level) , "%s" , out.data() );
+        } else
+#endif
+        if(fwrite(out.data(), out.size(), 1, logfile)) {
+            fflush(logfile);
+        }
+        else {
+            int x = errno;
+            cout << "Failed to write to logfile: " << errnoWithDescription(x) << ": " << out << endl;
+        }
+#ifdef POSIX_FADV_DONTNEED
+        // This only applies to pages that have already been flushed
+        RARELY posix_fadvise(fileno(logfile), 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    }
+
     void Logstream::setLogFile(FILE* f) {
         scoped_lock lk(mutex);
+        SimpleMutex::scoped_lock lk2( logFileMutex );
         logfile = f;
     }
+
+    Logstream::~Logstream() {
+        if ( asyncBuffer )
+            asyncWriter.orphan( asyncBuffer );
+    }
+
+    void Logstream::startAsyncWriter() {
+        asyncWriter.start();
+    }
+
+    void Logstream::stopAsyncWriter() {
+        asyncWriter.stop();
+    }
+
+    void Logstream::drainAsyncWriter() {
+        asyncWriter.drain();
+    }
+
+    void Logstream::appendAsyncStats( BSONObjBuilder& b ) {
+        asyncWriter.append( b );
+    }
         
     Logstream& Logstream::get() {
         if ( StaticObserver::_destroyingStatics ) {
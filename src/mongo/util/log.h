@@ -225,6 +225,9 @@ namespace mongo {
 
     class mutex;
 
+    class AsyncLogBuffer;
+    class BSONObjBuilder;
+
     class Logstream : public Nullstream {
         static mongo::mutex mutex;
         static int doneSetup;
@@ -235,9 +238,25 @@ namespace mongo {
         static boost::scoped_ptr<ostream> stream;
         static vector<Tee*> * globalTees;
         static bool isSyslog;
+        AsyncLogBuffer * asyncBuffer;
     public:
         static void logLockless( const StringData& s );
 
+        /**
+         * From now on the log file (or syslog) is written by a background thread.  Each logging thread
+         * queues its lines in a buffer of its own which the writer swaps out, so threads never wait on
+         * the disk.  Tees are still written right away.  Memory is bounded: when the writer falls behind
+         * lines are dropped and counted.  Warnings, errors and severe lines are never queued, they are
+         * written synchronously after the queued ones.
+         */
+        static void startAsyncWriter();
+        /** writes what is queued and goes back to writing synchronously, for shutdown */
+        static void stopAsyncWriter();
+        /** writes what is queued without waiting on the writer thread, for crash and abort handlers */
+        static void drainAsyncWriter();
+        /** status of the async writer, for serverStatus */
+        static void appendAsyncStats( BSONObjBuilder& b );
+
         static void setLogFile(FILE* f);
 #ifndef _WIN32
         static void useSyslog(const char * name) {
@@ -326,9 +345,15 @@ namespace mongo {
         void indentDec(){ indent--; }
         int getIndent() const { return indent; }
 
+        ~Logstream();
+
     private:
+        friend class AsyncLogWriter;
+        static void writeTees( LogLevel level , const string& out , Tee* t );
+        static void writeOut( LogLevel level , const string& out );
+
         static boost::thread_specific_ptr<Logstream> tsp;
-        Logstream() {
+        Logstream() : asyncBuffer(0) {
             indent = 0;
             _init();
         }
@@ -186,6 +186,9 @@ namespace mongo {
         void flush(bool sync);
         virtual Flushable * prepareFlush();
 
+        /** synchronously writes back bytes [ofs, ofs+len) of the view flush() writes; ofs page aligned */
+        void flushRange( unsigned long long ofs , unsigned long long len );
+
         long shortLength() const          { return (long) len; }
         unsigned long long length() const { return len; }
 
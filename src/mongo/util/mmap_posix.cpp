@@ -192,6 +192,20 @@ namespace mongo {
             problem() << "msync " << errnoWithDescription() << endl;
     }
 
+    void MemoryMappedFile::flushRange( unsigned long long ofs , unsigned long long n ) {
+        if ( views.empty() || fd == 0 || ofs >= len )
+            return;
+        n = std::min( n , len - ofs );
+#if defined(__linux__)
+        // shared mappings mark pages dirty in the page cache, so this writes just the range without
+        // msync walking the page tables
+        if ( sync_file_range( fd , ofs , n , SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER ) == 0 )
+            return;
+#endif
+        if ( msync( (char*)viewForFlushing() + ofs , n , MS_SYNC ) )
+            problem() << "msync " << errnoWithDescription() << endl;
+    }
+
     class PosixFlushable : public MemoryMappedFile::Flushable {
     public:
         PosixFlushable( void * view , HANDLE fd , long len )
@@ -196,6 +196,17 @@ namespace mongo {
         }
     }
 
+    void MemoryMappedFile::flushRange( unsigned long long ofs , unsigned long long n ) {
+        if ( views.empty() || !fd || ofs >= len )
+            return;
+        n = std::min( n , len - ofs );
+        scoped_lock lk(*_flushMutex);
+        if ( !FlushViewOfFile( (char*)viewForFlushing() + ofs , (SIZE_T) n ) ) {
+            int err = GetLastError();
+            out() << "FlushViewOfFile failed " << err << " file: " << filename() << endl;
+        }
+    }
+
     MemoryMappedFile::Flushable * MemoryMappedFile::prepareFlush() {
         return new WindowsFlushable( viewForFlushing() , fd , filename() , _flushMutex );
     }
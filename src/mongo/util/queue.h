@@ -27,13 +27,17 @@ namespace mongo {
 
     /**
      * simple blocking queue
+     * if constructed with a maxSize, push blocks while the queue holds that many
      */
     template<typename T> class BlockingQueue : boost::noncopyable {
     public:
-        BlockingQueue() : _lock("BlockingQueue") { }
+        BlockingQueue() : _lock("BlockingQueue") , _maxSize(0) { }
+        explicit BlockingQueue( size_t maxSize ) : _lock("BlockingQueue") , _maxSize(maxSize) { }
 
         void push(T const& t) {
             scoped_lock l( _lock );
+            while ( _maxSize && _queue.size() >= _maxSize )
+                _notFull.wait( l.boost() );
             _queue.push( t );
             _condition.notify_one();
         }
@@ -56,6 +60,7 @@ namespace mongo {
 
             t = _queue.front();
             _queue.pop();
+            _notFull.notify_one();
 
             return true;
         }
@@ -68,6 +73,7 @@ namespace mongo {
 
             T t = _queue.front();
             _queue.pop();
+            _notFull.notify_one();
             return t;
         }
 
@@ -93,6 +99,7 @@ namespace mongo {
 
             t = _queue.front();
             _queue.pop();
+            _notFull.notify_one();
             return true;
         }
 
@@ -101,6 +108,9 @@ namespace mongo {
 
         mutable mongo::mutex _lock;
         boost::condition _condition;
+
+        const size_t _maxSize;
+        boost::condition _notFull;
     };
 
 }
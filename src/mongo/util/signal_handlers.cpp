@@ -107,6 +107,7 @@ namespace mongo {
     }
 
     void printStackAndExit( int signalNum ) {
+        Logstream::drainAsyncWriter();
         int fd = Logstream::getLogDesc();
 
         if ( fd >= 0 ) {
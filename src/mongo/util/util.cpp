@@ -203,6 +203,9 @@ namespace mongo {
     void rawOut( const string &s ) {
         if( s.empty() ) return;
 
+        // crash handlers report through here; get the lines queued before the crash out first
+        Logstream::drainAsyncWriter();
+
         char buf[64];
         time_t_to_String( time(0) , buf );
         /* truncate / don't show the year: */